@@ -18,10 +18,34 @@
 #define PCA9955B_CH_NUM (5 * PCA9955B_NUM)
 
 /**
- * @brief I2C bus clock frequency in Hertz.
+ * @brief Number of I2C controllers driving PCA9955B chips (1 or 2).
+ *
+ * With 2, the chips are split between I2C_NUM_0 and I2C_NUM_1 as given by
+ * BOARD_HW_CONFIG.i2c_bus_idx and both buses transfer at the same time
+ * (requires PCA9955B_ASYNC, enforced after its definition below).
+ */
+#define I2C_BUS_NUM 1
+
+/**
+ * @brief I2C bus clock frequency in Hertz (the fallback when I2C_SPEED_PROBE is set).
  */
 #define I2C_FREQ 400000
 
+/**
+ * @brief Probe the PCA9955B bus at faster clocks during init and keep the fastest
+ *        one every chip reads back correctly.
+ *
+ * The PCA9955B supports Fast-mode Plus (1 MHz), but whether the bus does
+ * depends on its pull-ups and capacitance: the weak internal pull-ups rarely
+ * get past 400 kHz, external 1-2.2k pull-ups usually reach 1 MHz.
+ */
+#define I2C_SPEED_PROBE 1
+
+/**
+ * @brief Clocks tried by the I2C speed probe, in increasing order.
+ */
+#define I2C_PROBE_FREQS {I2C_FREQ, 700000, 1000000}
+
 /**
  * @brief Maximum time (in milliseconds) allowed for a single I2C transaction.
  */
@@ -32,6 +56,159 @@
  */
 #define RMT_TIMEOUT_MS 20
 
+/**
+ * @brief Stream the longest WS2812B strips through the RMT DMA channel.
+ *
+ * Only takes effect on targets with RMT DMA (SOC_RMT_SUPPORT_DMA, e.g. ESP32-S3);
+ * the ESP32 has none and spreads its RMT memory blocks over the strips instead.
+ */
+#define WS2812B_DMA 1
+
+/**
+ * @brief RMT DMA channels available to WS2812B strips.
+ */
+#define WS2812B_DMA_CHANNEL_NUM 1
+
+/**
+ * @brief DMA buffer size in symbols (4 bytes each); refilled every half buffer.
+ */
+#define WS2812B_DMA_MEM_SYMBOLS 1024
+
+/**
+ * @brief Release all WS2812B strips in the same instant through an RMT sync manager.
+ *
+ * Needs RMT TX synchronisation (SOC_RMT_SUPPORT_TX_SYNCHRO, see WS2812B_SIM_TX_SYNC
+ * for the host simulator). A frame that changes any strip then resends all of them, since
+ * the group only starts once all its channels are armed. Without it the strips are still
+ * armed back to back, after all buffers have been swapped.
+ */
+#define WS2812B_SYNC 1
+
+/**
+ * @brief Whether the host simulator offers RMT TX synchronisation.
+ *
+ * Follows the board: the classic ESP32 has none, so host_sim runs the back to back
+ * path the hardware runs. Building host_sim with -DSIM_TX_SYNC=ON turns it on to
+ * exercise the sync group path of newer targets.
+ */
+#ifndef WS2812B_SIM_TX_SYNC
+#define WS2812B_SIM_TX_SYNC 0
+#endif
+
+/**
+ * @brief Encode WS2812B pixels with a 256-entry byte-to-symbols table instead of
+ *        the generic bit-by-bit bytes encoder (shorter RMT refill interrupts).
+ */
+#define WS2812B_LUT_ENCODER 1
+
+/**
+ * @brief Keep every strip's front buffer encoded as RMT symbols.
+ *
+ * Frames are encoded in task context when staged and the refill interrupt
+ * only copies; repeated frames (holds, pauses, sync replays) are not encoded
+ * again. Costs 4 bytes of internal RAM per bit: ~9.4 KiB per 100-pixel strip,
+ * ~75 KiB for WS2812B_NUM strips, so it is off unless the board has RAM to spare.
+ * The host simulator builds with it on (host_sim/CMakeLists.txt).
+ */
+#ifndef WS2812B_SYMBOL_CACHE
+#define WS2812B_SYMBOL_CACHE 0
+#endif
+
+/**
+ * @brief Queue PCA9955B frame writes on the I2C bus asynchronously.
+ *
+ * When enabled, pca9955b_show_async() returns as soon as the burst is queued
+ * and completion is reported through an event group, so I2C overlaps with the
+ * WS2812B RMT transmission.
+ */
+#define PCA9955B_ASYNC 1
+
+// Checked here rather than next to I2C_BUS_NUM, PCA9955B_ASYNC is not defined there yet
+#if I2C_BUS_NUM > 1 && !PCA9955B_ASYNC
+#error "I2C_BUS_NUM 2 requires PCA9955B_ASYNC: synchronous writes cannot overlap the two buses"
+#endif
+
+/**
+ * @brief Send fill() / black_out() colours and the global dimmer to every
+ *        PCA9955B at once through their ALLCALL address.
+ *
+ * One 16-byte transaction replaces a burst per chip. Requires ALLCALL to stay
+ * enabled (MODE1 default) and no other device at the ALLCALL address.
+ */
+#define PCA9955B_ALLCALL 1
+
+/**
+ * @brief Output stage applied on the way out, while frames are staged / packed.
+ *
+ * Each device type gets a 256-entry table combining its gamma curve with the
+ * master brightness (output_lut.h), so frame sources stay in perceptual units
+ * and the brightness can change at runtime without touching them. With
+ * OUTPUT_GAMMA 0 values stay linear and are only scaled. The PCA9955B global
+ * current (set_pca_brightness()) still applies on top.
+ */
+#define OUTPUT_GAMMA 1
+#define OUTPUT_GAMMA_WS2812B 2.6f  /*!< Curve exponent of the WS2812B strips */
+#define OUTPUT_GAMMA_PCA9955B 2.2f /*!< Curve exponent of the PCA9955B constant-current channels */
+#define OUTPUT_DEFAULT_BRIGHTNESS 255
+
+/**
+ * @brief Stage the WS2812B colours through the 16-bit output tables and dither
+ *        them down to 8 bits on every show().
+ *
+ * The gamma / brightness stage keeps 8 fraction bits per channel and each byte
+ * carries the fraction it dropped over to the next frame, so dim fades show
+ * the steps the 8-bit tables would merge (at 25% brightness about four source
+ * steps per output step). Strips holding fractional levels are resent every
+ * frame while show() is called. Costs 1 byte of RAM per colour for the carried
+ * fraction: ~300 bytes per 100-pixel strip.
+ */
+#define WS2812B_DITHER 1
+
+/**
+ * @brief Supply current budget of the LEDs in mA, frames estimated above it are
+ *        scaled down (0 = estimate only). LedController::set_power_budget() changes it at runtime.
+ *
+ * The estimate adds up the colour levels as written, kept up to date by the
+ * writes instead of rescanning the frame, times the current of one level step,
+ * plus the quiescent current of the WS2812B pixels. Over budget, every LED is
+ * scaled by the same factor on its way out: the frame keeps its colours and
+ * balance, and the shadow buffers stay unscaled. The factor moves in coarse
+ * steps, since every new one resends all LEDs.
+ */
+#define POWER_BUDGET_MA 5000
+#define POWER_SCALE_STEP 8              /*!< Limiter factor resolution, 1/32 in 8.8 fixed point */
+#define POWER_WS2812B_UA_PER_STEP 47    /*!< WS2812B current per colour and level step, ~12 mA a colour at 255 */
+#define POWER_WS2812B_IDLE_UA 700       /*!< Quiescent current of one WS2812B pixel */
+#define POWER_PCA9955B_UA_PER_STEP 225 /*!< PCA9955B output current per PWM step at IREF 0xFF (~57 mA at 255, set by REXT) */
+
+/**
+ * @brief Consecutive failed transfers after which a PCA9955B is reported dead.
+ */
+#define PCA9955B_DEAD_FAILS 3
+
+/**
+ * @brief Backoff range (ms) for a failing PCA9955B.
+ *
+ * A single failure is retried on the next frame. Every further failure in a
+ * row doubles the wait from PCA9955B_RETRY_MIN_MS up to PCA9955B_RETRY_MAX_MS,
+ * and the chip is left out of the frames in between.
+ */
+#define PCA9955B_RETRY_MIN_MS 50
+#define PCA9955B_RETRY_MAX_MS 2000
+
+/**
+ * @brief Depth of the I2C master transaction queue used in asynchronous mode.
+ */
+#define I2C_TRANS_QUEUE_DEPTH (2 * PCA9955B_NUM)
+
+/**
+ * @brief SDA / SCL pins of one I2C controller.
+ */
+typedef struct {
+    gpio_num_t sda; /*!< Data line */
+    gpio_num_t scl; /*!< Clock line */
+} i2c_pins_t;
+
 /**
  * @brief Hardware LED channel configuration.
  *
@@ -71,6 +248,12 @@ typedef struct {
         };
     };
 
+    /** @brief Pins of I2C_NUM_0 (and I2C_NUM_1 with I2C_BUS_NUM 2) */
+    i2c_pins_t i2c_buses[I2C_BUS_NUM];
+
+    /** @brief Bus of every PCA9955B, as an index into i2c_buses */
+    uint8_t i2c_bus_idx[PCA9955B_NUM];
+
 } hw_config_t;
 
 /**
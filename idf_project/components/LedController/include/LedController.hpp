@@ -1,30 +1,71 @@
 #pragma once
 
 #include "BoardConfig.h"
+#include "frame_stats.h"
 #include "pca9955b_hal.h"
 #include "ws2812b_hal.h"
 
-#define SHOW_TIME_PER_FRAME 0
+/**
+ * @brief Anything frame pixels can be rendered into (GRB order, ch_info_t channel indices).
+ *
+ * Implemented by LedController (shadow buffers) and by the Player frame buffers,
+ * so frame sources do not care where their output ends up.
+ */
+class FrameTarget {
+  public:
+    virtual ~FrameTarget() = default;
+    virtual esp_err_t write_pixels(int ch_idx, int pixel_idx, const uint8_t* data, int pixel_count) = 0;
+    virtual esp_err_t fill(uint8_t red, uint8_t green, uint8_t blue) = 0;
+};
 
-class LedController {
+class LedController: public FrameTarget {
   public:
     LedController();
     ~LedController();
 
     esp_err_t init(ch_info_t);
     esp_err_t write_buffer(int ch_idx, uint8_t* data);
+    esp_err_t write_pixels(int ch_idx, int pixel_idx, const uint8_t* data, int pixel_count) override;
     esp_err_t show();
+    esp_err_t wait_done();
     esp_err_t deinit();
 
-    esp_err_t fill(uint8_t, uint8_t, uint8_t);
+    esp_err_t fill(uint8_t, uint8_t, uint8_t) override;
     esp_err_t black_out();
+    esp_err_t set_pca_brightness(uint8_t brightness);
+    void set_power_budget(uint32_t budget_ma);
+    uint32_t get_current_ma();
 
     void print_buffer();
+    void print_pca_health();
+    void reset_pca_health();
 
   private:
-    i2c_master_bus_handle_t bus_handle;
+    void init_sync();
+    esp_err_t init_i2c_bus(int bus);
+    bool i2c_bus_wedged(int bus);
+    esp_err_t recover_i2c_bus(int bus);
+    esp_err_t collect_pca(EventBits_t wait_bits);
+    void limit_power();
+
+    i2c_master_bus_handle_t bus_handles[I2C_BUS_NUM]; /*!< I2C_NUM_0, then I2C_NUM_1 */
+    uint32_t i2c_freq[I2C_BUS_NUM];                   /*!< SCL clock of every bus, see I2C_SPEED_PROBE */
+    int64_t i2c_retry_us[I2C_BUS_NUM];                /*!< esp_timer time before which a bus is not recovered again */
+    uint32_t i2c_postpone_ms[I2C_BUS_NUM];            /*!< Backoff of a recovery postponed by pending transfers, 0 = none */
+    uint32_t i2c_recoveries[I2C_BUS_NUM];             /*!< Bus recoveries since the last reset_pca_health() */
+    uint32_t i2c_recovery_us[I2C_BUS_NUM];            /*!< Duration of the last bus recovery */
+    EventGroupHandle_t pca_done_group;                /*!< One bit per PCA9955B, set when its last transfer finished */
+    int64_t pca_queue_us;                             /*!< esp_timer time the current PCA round was queued */
+    EventBits_t pca_wait_bits;                        /*!< Done bits of the chips queued while healthy */
+    rmt_sync_manager_handle_t rmt_sync;               /*!< Starts all strips together, NULL if unsynchronised */
     ws2812b_handle_t ws2812b_devs[WS2812B_NUM];
     pca9955b_handle_t pca9955b_devs[PCA9955B_NUM];
+    pca9955b_handle_t pca_allcall[I2C_BUS_NUM]; /*!< Every PCA9955B of a bus at once, NULL without PCA9955B_ALLCALL */
+    bool pca_broadcast;                         /*!< fill() colours wait in pca_allcall for the next show() */
+    uint32_t power_budget_ma;                   /*!< Current limiter budget, 0 = estimate only */
+    uint32_t power_ma;                          /*!< Estimated current of the last frame shown, before limiting */
+    uint16_t power_scale;                       /*!< Current limiter factor of the last frame shown, 8.8 fixed point */
+    uint32_t lut_version;                       /*!< Output tables the shadow buffers were last sent through */
 
     ch_info_t ch_info;
 };
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "esp_timer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Pipeline stages timed once per frame.
+ */
+typedef enum {
+    FRAME_STAGE_JITTER,   /*!< Tick lateness: render start minus the show time the frame was due */
+    FRAME_STAGE_COMPUTE,  /*!< Frame decode / render into the working frame */
+    FRAME_STAGE_OUTPUT,   /*!< Whole output step: flush into the drivers + show() */
+    FRAME_STAGE_RMT_WAIT, /*!< Waiting for the previous WS2812B frame to leave the wire */
+    FRAME_STAGE_RMT_KICK, /*!< Swapping and queueing the WS2812B strips */
+    FRAME_STAGE_RMT_SKEW, /*!< Queueing the first to queueing the last strip (start skew unless synchronised) */
+    FRAME_STAGE_I2C,      /*!< PCA9955B transfer, from queueing to the last completion */
+    FRAME_STAGE_NUM,
+} frame_stage_t;
+
+/**
+ * @brief Events counted once per frame.
+ */
+typedef enum {
+    FRAME_COUNTER_RMT_IRQ, /*!< RMT refill + trans-done interrupts of all WS2812B strips */
+    FRAME_COUNTER_CURRENT, /*!< Estimated supply current of the frame as rendered, mA */
+    FRAME_COUNTER_LIMITED, /*!< Estimated supply current after the current limiter, mA */
+    FRAME_COUNTER_NUM,
+} frame_counter_t;
+
+/**
+ * @brief Snapshot of one stage histogram.
+ *
+ * Percentiles are bucket upper bounds, so they are accurate to 1/8 of the value.
+ */
+typedef struct {
+    uint32_t count;    /*!< Number of samples */
+    uint32_t min_us;   /*!< Shortest sample */
+    uint32_t max_us;   /*!< Longest sample */
+    uint32_t p50_us;   /*!< Median */
+    uint32_t p99_us;   /*!< 99th percentile */
+    uint32_t avg_us;   /*!< Mean of all samples */
+    uint32_t overruns; /*!< Samples longer than the frame budget */
+} frame_stage_summary_t;
+
+/**
+ * @brief Snapshot of one counter histogram, in the counter's own unit (see frame_counter_t).
+ *
+ * Percentiles are bucket upper bounds, so they are accurate to 1/8 of the value.
+ */
+typedef struct {
+    uint32_t count;    /*!< Number of frames counted */
+    uint32_t min;      /*!< Smallest value of a frame */
+    uint32_t max;      /*!< Largest value of a frame */
+    uint32_t p50;      /*!< Median */
+    uint32_t p99;      /*!< 99th percentile */
+    uint32_t avg;      /*!< Mean over all frames */
+    uint64_t total;    /*!< Sum over all frames */
+    uint32_t overruns; /*!< Frames above the counter limit */
+} frame_counter_summary_t;
+
+/**
+ * @brief Records one sample of a stage.
+ *
+ * Every stage must only be recorded from a single task; readers may run
+ * concurrently and see a slightly stale snapshot. No locks, no allocation,
+ * safe to keep enabled in production.
+ *
+ * @param[in] stage    Stage to record.
+ * @param[in] start_us esp_timer_get_time() value taken at the start of the stage.
+ */
+void frame_stats_record(frame_stage_t stage, int64_t start_us);
+
+/**
+ * @brief Records a sample whose duration was measured by the caller.
+ */
+void frame_stats_record_us(frame_stage_t stage, uint32_t duration_us);
+
+/**
+ * @brief Records the per-frame value of a counter.
+ *
+ * Kept in the same kind of histogram as the stages, reported by
+ * frame_stats_get_counter(). Same threading rules as frame_stats_record().
+ */
+void frame_stats_count(frame_counter_t counter, uint32_t value);
+
+/**
+ * @brief Sets the per-frame budget used for overrun counting (usually 1/fps).
+ */
+void frame_stats_set_budget_us(uint32_t budget_us);
+
+/**
+ * @brief Sets the value above which a counter sample counts as an overrun (0 = none).
+ */
+void frame_stats_set_counter_limit(frame_counter_t counter, uint32_t limit);
+
+/**
+ * @brief I2C buses whose clock is reported (I2C_NUM_0 and I2C_NUM_1).
+ */
+#define FRAME_STATS_I2C_BUS_NUM 2
+
+/**
+ * @brief Records the I2C clock a PCA9955B bus settled on, printed with the stages (0 = bus unused).
+ */
+void frame_stats_set_i2c_hz(int bus, uint32_t hz);
+
+/**
+ * @brief Clears all histograms.
+ *
+ * The clear is performed by each stage's writer on its next sample, so it is
+ * safe to call from any task.
+ */
+void frame_stats_reset(void);
+
+/**
+ * @brief Computes the summary of one stage.
+ *
+ * @return
+ * - ESP_OK: Success.
+ * - ESP_ERR_INVALID_ARG: Stage out of range or summary is NULL.
+ */
+esp_err_t frame_stats_get(frame_stage_t stage, frame_stage_summary_t* summary);
+
+/**
+ * @brief Computes the summary of one counter (overruns are frames above its limit).
+ *
+ * @return
+ * - ESP_OK: Success.
+ * - ESP_ERR_INVALID_ARG: Counter out of range or summary is NULL.
+ */
+esp_err_t frame_stats_get_counter(frame_counter_t counter, frame_counter_summary_t* summary);
+
+/**
+ * @brief Logs the summary of every stage and counter.
+ */
+void frame_stats_print(void);
+
+#ifdef __cplusplus
+}
+#endif
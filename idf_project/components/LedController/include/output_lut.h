@@ -0,0 +1,115 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Scale factor of output_lut_copy_scaled() / output_lut_dither() that leaves the table output unchanged, 8.8 fixed point.
+ */
+#define OUTPUT_LUT_SCALE_NONE 256
+
+/**
+ * @brief Output curves, one per device type.
+ */
+typedef enum {
+    OUTPUT_LUT_WS2812B,  /*!< WS2812B strips, OUTPUT_GAMMA_WS2812B */
+    OUTPUT_LUT_PCA9955B, /*!< PCA9955B PWM channels, OUTPUT_GAMMA_PCA9955B */
+    OUTPUT_LUT_NUM,
+} output_lut_type_t;
+
+/**
+ * @brief Builds the gamma curves and the tables at OUTPUT_DEFAULT_BRIGHTNESS.
+ *
+ * Only the first call does anything, so brightness set at runtime survives a
+ * driver re-init. The other functions call it on first use.
+ */
+void output_lut_init(void);
+
+/**
+ * @brief Rebuilds the tables for a new master brightness (255 = full).
+ *
+ * Integer only, cheap enough to call from the console. The drivers apply the
+ * tables on the way out and notice the rebuild through output_lut_get_version(),
+ * so the frame on the LEDs changes level without being written again. A frame
+ * sent while the tables are rebuilt may mix both levels; the next one corrects it.
+ */
+void output_lut_set_brightness(uint8_t brightness);
+
+/**
+ * @brief Current master brightness.
+ */
+uint8_t output_lut_get_brightness(void);
+
+/**
+ * @brief Switches the gamma curves on or off (OUTPUT_GAMMA at boot), the brightness stays.
+ */
+void output_lut_set_gamma(bool enable);
+
+/**
+ * @brief Whether the gamma curves are applied.
+ */
+bool output_lut_get_gamma(void);
+
+/**
+ * @brief Counter bumped after every table rebuild (brightness or gamma change).
+ *
+ * A driver whose shadow buffers were last sent with an older version sends
+ * them again through the current tables.
+ */
+uint32_t output_lut_get_version(void);
+
+/**
+ * @brief The 256-entry table of a device type, output = table[input].
+ */
+const uint8_t* output_lut_get(output_lut_type_t type);
+
+/**
+ * @brief The same table with 8 fraction bits, output = table[input] / 256.
+ *
+ * Keeps the steps the 8-bit table rounds away at low brightness, for
+ * output_lut_dither().
+ */
+const uint16_t* output_lut_get16(output_lut_type_t type);
+
+/**
+ * @brief Copies `len` bytes from `src` to `dst` through the table of `type`.
+ *
+ * Works a 32-bit word at a time once `dst` is aligned: one load and one store
+ * per four bytes, like memcpy, plus the table lookups. Falls back to memcpy
+ * while the table is the identity.
+ */
+void output_lut_copy(output_lut_type_t type, uint8_t* dst, const uint8_t* src, size_t len);
+
+/**
+ * @brief output_lut_copy() followed by a scale factor (current limiter), rounding down.
+ *
+ * @param[in] scale  8.8 fixed point, OUTPUT_LUT_SCALE_NONE is a plain output_lut_copy().
+ */
+void output_lut_copy_scaled(output_lut_type_t type, uint8_t* dst, const uint8_t* src, size_t len, uint16_t scale);
+
+/**
+ * @brief Temporal dithering of the 8.8 table levels of `src` down to bytes, one call per frame.
+ *
+ * Every byte carries the fraction it dropped over to the next frame in
+ * `error`, so a level of 10.25 is sent as 10, 10, 10, 11 and averages out
+ * exactly over time.
+ *
+ * @param[in]     type   Table the colours go through (output_lut_get16()).
+ * @param[in]     src    Colours as written.
+ * @param[in]     scale  Factor applied to the dithered bytes, 8.8 fixed point, OUTPUT_LUT_SCALE_NONE = none.
+ * @param[in,out] error  Fraction carried per byte, kept between frames.
+ * @param[out]    dst    Bytes to send.
+ * @param[in]     len    Number of bytes.
+ *
+ * @return Bytes up to the last level with a fraction, which change again next frame (0 = none).
+ */
+size_t output_lut_dither(output_lut_type_t type, const uint8_t* src, uint16_t scale, uint8_t* error, uint8_t* dst, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,8 +1,11 @@
 #pragma once
 
 #include "driver/i2c_master.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
 
 #include "BoardConfig.h"
+#include "output_lut.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -28,20 +31,71 @@ typedef struct __attribute__((packed)) {
     };
 } pca9955b_buffer_t;
 
+/**
+ * @brief Dirty mask with every PWM channel of pca9955b_buffer_t set.
+ */
+#define PCA9955B_DIRTY_ALL 0x7FFF
+
+/**
+ * @brief 7-bit ALLCALL address every PCA9955B answers to after power-up (ALLCALLADR 0xE0).
+ */
+#define PCA9955B_ALLCALL_ADDR 0x70
+
+/**
+ * @brief Link state of a PCA9955B, driven by the results of its transfers.
+ */
+typedef enum {
+    PCA9955B_HEALTHY = 0, /*!< Last write acknowledged */
+    PCA9955B_SUSPECT,     /*!< Failed recently, retried with backoff */
+    PCA9955B_DEAD,        /*!< PCA9955B_DEAD_FAILS failures in a row, probed at the backoff interval */
+} pca9955b_health_t;
+
+/**
+ * @brief Per-chip transfer counters, kept until cleared by the caller.
+ */
+typedef struct {
+    uint32_t ok;        /*!< Acknowledged writes that left the chip up to date */
+    uint32_t failed;    /*!< Failed or timed out transfers */
+    uint32_t skipped;   /*!< Frames the chip was left out of while backing off */
+    uint32_t recovered; /*!< Returns to PCA9955B_HEALTHY */
+} pca9955b_health_stats_t;
+
 /**
  * @brief PCA9955B device descriptor for I2C-based constant-current LED driver control.
  *
  * Holds bus handle, device address, LED frame buffer, and IREF reset command.
+ * Only the PWM registers from the first to the last dirty channel are written,
+ * with the command byte pointing at the first one. In asynchronous mode the
+ * I2C driver reads from `tx_buffer` while the caller keeps writing the next
+ * frame into `buffer`. The gamma / brightness table and the current limiter
+ * are applied while `tx_buffer` is packed.
  */
 typedef struct {
+    i2c_master_bus_handle_t i2c_bus_handle; /*!< I2C bus the device is attached to */
     i2c_master_dev_handle_t i2c_dev_handle; /*!< I2C bus device handle */
     uint8_t i2c_addr;                       /*!< 7-bit I2C device address */
+    uint32_t scl_speed_hz;                  /*!< SCL clock the device is added with */
 
-    pca9955b_buffer_t buffer; /*!< PWM register + LED color buffer */
-    bool need_update;         /*!< Dirty flag for buffer */
+    pca9955b_buffer_t buffer; /*!< PWM register + LED color buffer, colours as written */
+    uint16_t dirty_mask;      /*!< Bit n set: PWMn changed since it was last sent */
+    uint16_t level_sum;       /*!< Sum of the PWM values `buffer` is sent as, before the limiter, for the current estimate */
+    uint16_t scale;           /*!< Current limiter factor applied while sending, 8.8 fixed point */
 
     bool need_reset_IREF; /*!< Set true if IREF register needs to be reinitialized */
-    uint8_t IREF_cmd[2];  /*!< 2-byte IREF reset command to send over I2C */
+    uint8_t IREF_cmd[2];  /*!< 2-byte IREF reset command to send over I2C, [1] is the brightness */
+
+    pca9955b_buffer_t tx_buffer;   /*!< Snapshot owned by the I2C driver during an async transfer */
+    volatile bool in_flight;       /*!< An async transfer is queued or on the bus */
+    volatile bool tx_error;        /*!< Set by the completion callback on NACK/timeout */
+    bool tx_is_IREF;               /*!< The in-flight transfer is the IREF command */
+    EventGroupHandle_t done_group; /*!< Event group notified on completion */
+    EventBits_t done_bit;          /*!< Bit set in done_group on completion */
+    volatile int64_t done_us;      /*!< esp_timer time of the last async completion, 0 while pending */
+
+    pca9955b_health_t health;             /*!< Link state */
+    uint8_t fail_streak;                  /*!< Failed transfers in a row */
+    int64_t retry_us;                     /*!< esp_timer time before which an unhealthy chip is not retried */
+    pca9955b_health_stats_t health_stats; /*!< Counters for the console */
 } pca9955b_dev_t;
 
 /**
@@ -58,6 +112,7 @@ typedef pca9955b_dev_t* pca9955b_handle_t;
  * For 400kHz operation or long wires, external pull-ups (e.g., 2.2k - 4.7k)
  * are strongly recommended.
  *
+ * @param[in]  i2c_port           I2C controller (I2C_NUM_0 or I2C_NUM_1).
  * @param[in]  i2c_gpio_sda       GPIO number for SDA line.
  * @param[in]  i2c_gpio_scl       GPIO number for SCL line.
  * @param[out] ret_i2c_bus_handle Pointer to store the created I2C bus handle.
@@ -67,7 +122,64 @@ typedef pca9955b_dev_t* pca9955b_handle_t;
  * - ESP_ERR_INVALID_ARG: SDA/SCL pins are the same, or handle pointer is NULL.
  * - ESP_FAIL: Driver installation failed.
  */
-esp_err_t i2c_bus_init(gpio_num_t i2c_gpio_sda, gpio_num_t i2c_gpio_scl, i2c_master_bus_handle_t* ret_i2c_bus_handle);
+esp_err_t i2c_bus_init(i2c_port_num_t i2c_port, gpio_num_t i2c_gpio_sda, gpio_num_t i2c_gpio_scl, i2c_master_bus_handle_t* ret_i2c_bus_handle);
+
+/**
+ * @brief Finds the fastest I2C clock every PCA9955B on the bus handles reliably.
+ *
+ * Runs on a temporary synchronous bus, before i2c_bus_init(). Tries the
+ * I2C_PROBE_FREQS in increasing order: at each clock every chip must read
+ * back test patterns written to its GRPFREQ register (unused with group
+ * dimming off, restored afterwards). Stops at the first clock that fails.
+ *
+ * @param[in]  i2c_port      I2C controller the bus will use.
+ * @param[in]  i2c_gpio_sda  GPIO number for SDA line.
+ * @param[in]  i2c_gpio_scl  GPIO number for SCL line.
+ * @param[in]  i2c_addrs     Addresses of the chips to verify.
+ * @param[in]  addr_num      Number of addresses.
+ * @param[out] scl_speed_hz  Fastest reliable clock, I2C_FREQ if none passed.
+ *
+ * @return
+ * - ESP_OK: Success (the first clock passed).
+ * - ESP_ERR_INVALID_ARG: Null pointer arguments.
+ * - ESP_ERR_NOT_FOUND: Not even I2C_FREQ reads back correctly.
+ * - Others: Errors creating the temporary bus.
+ */
+esp_err_t i2c_bus_probe_speed(i2c_port_num_t i2c_port,
+                              gpio_num_t i2c_gpio_sda,
+                              gpio_num_t i2c_gpio_scl,
+                              const uint8_t* i2c_addrs,
+                              int addr_num,
+                              uint32_t* scl_speed_hz);
+
+/**
+ * @brief Tells whether a target holds SDA low on an idle bus.
+ *
+ * Reads the pad level, which works while the I2C controller owns the pin.
+ * Only meaningful when no transfer is on the bus.
+ *
+ * @param[in] i2c_gpio_sda GPIO number for SDA line.
+ *
+ * @return true if SDA is low.
+ */
+bool i2c_bus_sda_stuck(gpio_num_t i2c_gpio_sda);
+
+/**
+ * @brief Clocks a stuck I2C bus free by hand.
+ *
+ * Pulses SCL until a target stuck mid-byte releases SDA (at most 9 clocks),
+ * then generates a STOP. The bus on these pins must have been deleted, and the
+ * pins are reset afterwards for i2c_bus_init().
+ *
+ * @param[in] i2c_gpio_sda GPIO number for SDA line.
+ * @param[in] i2c_gpio_scl GPIO number for SCL line.
+ *
+ * @return
+ * - ESP_OK: SDA is released.
+ * - ESP_FAIL: SDA is still low (e.g. shorted to ground).
+ * - Others: The pins could not be configured.
+ */
+esp_err_t i2c_bus_clear(gpio_num_t i2c_gpio_sda, gpio_num_t i2c_gpio_scl);
 
 /**
  * @brief Initializes the PCA9955B LED driver.
@@ -77,6 +189,7 @@ esp_err_t i2c_bus_init(gpio_num_t i2c_gpio_sda, gpio_num_t i2c_gpio_scl, i2c_mas
  *
  * @param[in]  i2c_addr        I2C address of the device (usually 0x69 for PCA9955B).
  * @param[in]  i2c_bus_handle  Handle to the configured I2C master bus.
+ * @param[in]  scl_speed_hz    SCL clock for the device, e.g. from i2c_bus_probe_speed().
  * @param[out] pca9955b        Pointer to store the created device handle.
  *
  * @return
@@ -85,7 +198,64 @@ esp_err_t i2c_bus_init(gpio_num_t i2c_gpio_sda, gpio_num_t i2c_gpio_scl, i2c_mas
  * - ESP_ERR_NO_MEM: Memory allocation failed.
  * - ESP_ERR_NOT_FOUND: Device not acknowledged on I2C bus.
  */
-esp_err_t pca9955b_init(uint8_t i2c_addr, i2c_master_bus_handle_t i2c_bus_handle, pca9955b_handle_t* pca9955);
+esp_err_t pca9955b_init(uint8_t i2c_addr, i2c_master_bus_handle_t i2c_bus_handle, uint32_t scl_speed_hz, pca9955b_handle_t* pca9955);
+
+/**
+ * @brief Creates a handle addressing every PCA9955B on the bus at once (ALLCALL).
+ *
+ * Nothing is sent: the chips answer to the ALLCALL address by default. Use
+ * pca9955b_fill()/pca9955b_write() on the handle to set the broadcast colours,
+ * then pca9955b_broadcast_write() to send them.
+ *
+ * @param[in]  i2c_bus_handle  Handle to the configured I2C master bus.
+ * @param[in]  scl_speed_hz    SCL clock, the slowest of the chips.
+ * @param[out] allcall         Pointer to store the created broadcast handle.
+ *
+ * @return
+ * - ESP_OK: Success.
+ * - ESP_ERR_INVALID_ARG: Null pointer arguments.
+ * - ESP_ERR_NO_MEM: Memory allocation failed.
+ */
+esp_err_t pca9955b_init_allcall(i2c_master_bus_handle_t i2c_bus_handle, uint32_t scl_speed_hz, pca9955b_handle_t* allcall);
+
+/**
+ * @brief Sends the colours of the ALLCALL handle to every chip in one transaction.
+ *
+ * Blocks until the transfer is done. The channels of `devs` whose shadow value
+ * equals the broadcast one are then clean, so their next show only sends what
+ * was written after the broadcast colours.
+ *
+ * @param[in] allcall  Handle from pca9955b_init_allcall().
+ * @param[in] devs     Chips reached by the broadcast (NULL entries and chips on other buses are skipped).
+ * @param[in] dev_num  Number of entries in devs.
+ *
+ * @return
+ * - ESP_OK: Success.
+ * - ESP_ERR_INVALID_ARG: Null pointer arguments.
+ * - ESP_ERR_INVALID_STATE: A chip still has an async transfer pending.
+ * - ESP_FAIL: I2C transmission failed, the chips stay dirty.
+ */
+esp_err_t pca9955b_broadcast_write(pca9955b_handle_t allcall, pca9955b_handle_t* devs, int dev_num);
+
+/**
+ * @brief Dims every chip at once with a single IREFALL write through ALLCALL.
+ *
+ * The output current, and so the brightness of every channel, scales with
+ * `brightness` / 255 without touching the PWM registers. Each chip keeps the
+ * value, so IREF restoration after a failure brings the dimmed level back.
+ *
+ * @param[in] allcall     Handle from pca9955b_init_allcall().
+ * @param[in] devs        Chips reached by the broadcast (NULL entries and chips on other buses are skipped).
+ * @param[in] dev_num     Number of entries in devs.
+ * @param[in] brightness  IREF value, 255 = full current.
+ *
+ * @return
+ * - ESP_OK: Success.
+ * - ESP_ERR_INVALID_ARG: Null pointer arguments.
+ * - ESP_ERR_INVALID_STATE: A chip still has an async transfer pending.
+ * - ESP_FAIL: I2C transmission failed, every chip restores IREF on its next show.
+ */
+esp_err_t pca9955b_broadcast_brightness(pca9955b_handle_t allcall, pca9955b_handle_t* devs, int dev_num, uint8_t brightness);
 
 /**
  * @brief Sets the RGB color for a specific logical LED in the internal shadow buffer.
@@ -108,8 +278,11 @@ esp_err_t pca9955b_set_pixel(pca9955b_handle_t pca9955b, uint8_t pixel_idx, uint
 /**
  * @brief Transmits the internal color buffer to the PCA9955B via I2C.
  *
- * This function checks if the buffer has been modified (dirty flag) before transmitting.
+ * This function only sends the PWM registers between the first and the last
+ * changed channel, and nothing if no channel changed.
  * It also handles automatic IREF restoration if a previous transmission failed.
+ * A chip that keeps failing is skipped until its backoff has elapsed
+ * (see PCA9955B_RETRY_MIN_MS).
  *
  * @param[in] pca9955b Handle to the PCA9955B device.
  *
@@ -121,6 +294,49 @@ esp_err_t pca9955b_set_pixel(pca9955b_handle_t pca9955b, uint8_t pixel_idx, uint
  */
 esp_err_t pca9955b_show(pca9955b_handle_t pca9955b);
 
+/**
+ * @brief Queues the internal color buffer for transmission without blocking.
+ *
+ * The buffer is snapshotted, so the caller may keep writing the next frame.
+ * `done_bit` is set in `done_group` once the transfer has finished (or
+ * immediately if there is nothing to send); call pca9955b_finish_async()
+ * afterwards to collect the result. A pending IREF restoration is sent on its
+ * own and the color data follows on the next call.
+ *
+ * An unhealthy chip is skipped while backing off (done_bit is set right away)
+ * and while its last transfer is still on the bus (done_bit is set by that
+ * transfer). A finished but uncollected transfer is collected first.
+ *
+ * @note Requires PCA9955B_ASYNC.
+ *
+ * @param[in] pca9955b   Handle to the PCA9955B device.
+ * @param[in] done_group Event group to notify.
+ * @param[in] done_bit   Bit to set in done_group.
+ *
+ * @return
+ * - ESP_OK: Transfer queued (or no update needed).
+ * - ESP_ERR_INVALID_ARG: Handle or event group is NULL.
+ * - ESP_ERR_INVALID_STATE: The previous transfer of a healthy chip is still on the bus.
+ * - ESP_FAIL: The collected previous transfer failed.
+ */
+esp_err_t pca9955b_show_async(pca9955b_handle_t pca9955b, EventGroupHandle_t done_group, EventBits_t done_bit);
+
+/**
+ * @brief Collects the result of the last pca9955b_show_async() call.
+ *
+ * On failure every channel is marked dirty again and IREF restoration is scheduled,
+ * exactly like a failed pca9955b_show(). A transfer still on the bus counts as a
+ * failure and stays pending, its own result is collected by a later call.
+ *
+ * @param[in] pca9955b Handle to the PCA9955B device.
+ *
+ * @return
+ * - ESP_OK: Transfer succeeded (or nothing was in flight).
+ * - ESP_ERR_TIMEOUT: Transfer is still on the bus.
+ * - ESP_FAIL: Device NACK or bus error.
+ */
+esp_err_t pca9955b_finish_async(pca9955b_handle_t pca9955b);
+
 /**
  * @brief Deinitializes the PCA9955B device.
  *
@@ -135,6 +351,37 @@ esp_err_t pca9955b_show(pca9955b_handle_t pca9955b);
  */
 esp_err_t pca9955b_del(pca9955b_handle_t* pca9955b);
 
+/**
+ * @brief Removes the device from its I2C bus, keeping its shadow buffer and health.
+ *
+ * A transfer in progress is dropped (its done bit is set). IREF and every
+ * channel are resent once the device is attached again.
+ *
+ * @param[in] pca9955b Handle to the PCA9955B device (or the ALLCALL handle).
+ *
+ * @return
+ * - ESP_OK: Detached (or was not attached).
+ * - ESP_ERR_INVALID_ARG: Handle is NULL.
+ * - Others: Errors removing the I2C device.
+ */
+esp_err_t pca9955b_detach(pca9955b_handle_t pca9955b);
+
+/**
+ * @brief Adds a detached device to an I2C bus at its address and clock.
+ *
+ * A failing chip is retried on the next show instead of waiting out its backoff.
+ *
+ * @param[in] pca9955b        Handle to the PCA9955B device (or the ALLCALL handle).
+ * @param[in] i2c_bus_handle  Bus to attach to.
+ *
+ * @return
+ * - ESP_OK: Attached.
+ * - ESP_ERR_INVALID_ARG: Handle or bus is NULL.
+ * - ESP_ERR_INVALID_STATE: Device is still attached.
+ * - Others: Errors adding the I2C device.
+ */
+esp_err_t pca9955b_attach(pca9955b_handle_t pca9955b, i2c_master_bus_handle_t i2c_bus_handle);
+
 /**
  * @brief Bulk updates all LED channels by copying a raw byte array to the internal buffer.
  *
@@ -170,6 +417,26 @@ esp_err_t pca9955b_write(pca9955b_handle_t pca9955b, const uint8_t* buffer);
  */
 esp_err_t pca9955b_fill(pca9955b_handle_t pca9955b, uint8_t red, uint8_t green, uint8_t blue);
 
+/**
+ * @brief The output tables changed: recounts the PWM levels and resends every channel through them.
+ *
+ * The shadow buffer keeps the colours as written, the chip gets them all again with the next show.
+ *
+ * @param[in] pca9955b  Driver handle.
+ */
+void pca9955b_refresh(pca9955b_handle_t pca9955b);
+
+/**
+ * @brief Sets the factor the PWM values are scaled by on their way to the chip.
+ *
+ * The shadow buffer keeps the colours as written. A new factor marks every
+ * channel dirty, so the chip gets them all again with the next show.
+ *
+ * @param[in] pca9955b  Driver handle.
+ * @param[in] scale     8.8 fixed point, OUTPUT_LUT_SCALE_NONE (256) sends the colours unchanged.
+ */
+void pca9955b_set_scale(pca9955b_handle_t pca9955b, uint16_t scale);
+
 void pca9955b_test1();
 void pca9955b_test2();
 
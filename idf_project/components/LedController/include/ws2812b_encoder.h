@@ -4,12 +4,28 @@
 
 #include "BoardConfig.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief How pixel bytes are turned into RMT symbols.
+ */
+typedef enum {
+    WS2812B_ENCODER_BYTES, /*!< Generic rmt_bytes_encoder, one bit per step, plus a copy encoder for the reset */
+    WS2812B_ENCODER_LUT,   /*!< Precomputed table, 8 symbols per byte, reset appended in the same pass */
+    WS2812B_ENCODER_IMAGE, /*!< Payload is a symbol image from ws2812b_encode_symbols(), copied as is */
+} ws2812b_encoder_type_t;
+
+/*! Symbols of a frame of `pixel_num` pixels: 24 bits per pixel plus the reset symbol */
+#define WS2812B_FRAME_SYMBOLS(pixel_num) ((size_t)(pixel_num) * 24 + 1)
+
 /**
  * @brief Create a composite RMT encoder for WS2812B pixel driving.
  *
  * Allocates the encoder container, binds the RMT callback interface, initializes
- * a byte waveform encoder (bit0/bit1 timing) and a copy encoder (for reset symbol),
- * and precomputes the WS2812B reset symbol.
+ * either the lookup-table encoder or a byte waveform encoder (bit0/bit1 timing)
+ * and a copy encoder (for reset symbol), and precomputes the WS2812B reset symbol.
  *
  * Resulting encoder instance resides on heap and must be deleted via
  * rmt_encoder->del() or rmt_del_encoder().
@@ -18,3 +34,33 @@
  * @return ESP_OK on success, or driver/memory error
  */
 esp_err_t rmt_new_encoder(rmt_encoder_handle_t* ret_encoder);
+
+/**
+ * @brief Same as rmt_new_encoder() with an explicit encoder type (rmt_new_encoder() follows WS2812B_LUT_ENCODER).
+ */
+esp_err_t rmt_new_encoder_with_type(ws2812b_encoder_type_t type, rmt_encoder_handle_t* ret_encoder);
+
+/**
+ * @brief Encodes pixel bytes into a symbol image in task context (lookup table, reset symbol appended).
+ *
+ * @param data     Raw pixel byte buffer
+ * @param size     Size of pixel buffer (bytes)
+ * @param symbols  Destination, size * 8 + 1 symbols
+ * @return Number of symbols written
+ */
+size_t ws2812b_encode_symbols(const uint8_t* data, size_t size, rmt_symbol_word_t* symbols);
+
+/**
+ * @brief Returns how many times the encoder has been called since it was created.
+ *
+ * The count only grows (wrapping at 2^32); callers keep the last value they saw.
+ * It is written from the RMT interrupt and safe to read from any task.
+ *
+ * @param encoder  Encoder created by rmt_new_encoder()
+ * @return Encoder call count, 0 if the encoder is NULL
+ */
+uint32_t rmt_encoder_get_calls(rmt_encoder_handle_t encoder);
+
+#ifdef __cplusplus
+}
+#endif
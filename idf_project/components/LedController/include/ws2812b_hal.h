@@ -3,29 +3,95 @@
 #include "driver/gpio.h"
 #include "driver/rmt_encoder.h"
 #include "driver/rmt_tx.h"
+#include "sdkconfig.h"
+#include "soc/soc_caps.h"
 
 #include "BoardConfig.h"
+#include "output_lut.h"
 #include "ws2812b_encoder.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * @brief RMT memory shared by the TX channels: WS2812B_MEM_BLOCK_NUM blocks of
+ *        WS2812B_MEM_BLOCK_SYMBOLS symbols, one per channel unless a channel borrows
+ *        the blocks of the channels after it.
+ */
+#ifdef SOC_RMT_MEM_WORDS_PER_CHANNEL
+#define WS2812B_MEM_BLOCK_SYMBOLS SOC_RMT_MEM_WORDS_PER_CHANNEL
+#define WS2812B_MEM_BLOCK_NUM SOC_RMT_TX_CANDIDATES_PER_GROUP
+#else
+#define WS2812B_MEM_BLOCK_SYMBOLS 64
+#define WS2812B_MEM_BLOCK_NUM 8
+#endif
+
+/**
+ * @brief Whether WS2812B_SYNC can be honoured on this target.
+ */
+#if WS2812B_SYNC && (SOC_RMT_SUPPORT_TX_SYNCHRO || (CONFIG_IDF_TARGET_LINUX && WS2812B_SIM_TX_SYNC))
+#define WS2812B_USE_SYNC 1
+#else
+#define WS2812B_USE_SYNC 0
+#endif
+
+/**
+ * @brief RMT memory assigned to one strip, see ws2812b_plan_mem().
+ */
+typedef struct {
+    size_t mem_block_symbols; /*!< Channel memory, or DMA buffer size, in symbols (0 = strip unused) */
+    bool with_dma;            /*!< Stream the frame from RAM through the RMT DMA channel */
+} ws2812b_mem_config_t;
+
 /**
  * @brief WS2812B LED strip device descriptor.
  *
- * Holds the RMT TX channel, RMT encoder handle, total pixel count, and a pointer
- * to the contiguous pixel color buffer used for frame output.
+ * Holds the RMT TX channel, RMT encoder handle, total pixel count, and three
+ * contiguous pixel color buffers:
+ * - `pixels` is the shadow buffer written by set_pixel/write/fill, colours as written.
+ * - `buffer` (back) is the next frame as sent: output table, dithering and limiter applied.
+ * - `tx_buffer` (front) is owned by the RMT while a frame is on the wire.
+ *
+ * ws2812b_stage() runs the changed prefix of `pixels` through the output stage
+ * into the back buffer and swaps the two others, so the next frame can be
+ * rendered while the previous one is still being transmitted. Only the pixels
+ * up to the last one that differs on the wire are sent: the pixels after it
+ * keep the colour they latched. Since the output stage runs there, a new
+ * brightness or limiter factor only needs the whole strip marked dirty
+ * (ws2812b_refresh(), ws2812b_set_scale()).
+ *
+ * With WS2812B_SYMBOL_CACHE the front buffer is also kept encoded as RMT
+ * symbols, so the refill interrupt only copies and repeated frames are not
+ * encoded again.
  *
- * The pixel buffer is dynamically allocated and must be freed by the caller.
+ * With WS2812B_DITHER the output stage uses the 16-bit tables and carries the
+ * fractions it drops in `error` from frame to frame.
+ *
+ * The pixel buffers are dynamically allocated and must be freed by the caller.
  */
 typedef struct {
-    rmt_channel_handle_t rmt_channel; /*!< RMT TX channel handle for LED signal output */
-    rmt_encoder_handle_t rmt_encoder; /*!< RMT encoder handle (bit timing + reset symbol) */
+    rmt_channel_handle_t rmt_channel;   /*!< RMT TX channel handle for LED signal output */
+    rmt_encoder_handle_t rmt_encoder;   /*!< RMT encoder handle (bit timing + reset symbol) */
+    rmt_encoder_handle_t image_encoder; /*!< Copies `symbols` to the RMT, NULL without symbol cache */
+
+    gpio_num_t gpio_num;        /*!< Number of the gpio pin */
+    uint16_t pixel_num;         /*!< Number of pixels in the LED strip */
+    uint8_t* pixels;            /*!< Shadow buffer: pixel colours in GRB order, as written */
+    uint8_t* buffer;            /*!< Back buffer: the next frame as sent, GRB order */
+    uint8_t* tx_buffer;         /*!< Front buffer: frame currently handed to the RMT */
+    rmt_symbol_word_t* symbols; /*!< Symbol image of the front buffer, NULL without symbol cache */
+    uint8_t* error;             /*!< Fraction carried to the next frame per colour, NULL without dithering */
+    uint16_t dirty_num;         /*!< Pixels up to the last one modified since the previous frame (0 = clean) */
+    uint16_t dither_num;        /*!< Pixels up to the last one with a fractional level, dithered every frame */
+    uint32_t power_sum;         /*!< Sum of all output levels at scale 1, 8.8 fixed point, for the current estimate */
+    uint16_t scale;             /*!< Current limiter factor for the next frame, 8.8 fixed point */
+    uint16_t tx_scale;          /*!< Current limiter factor the back and front buffers were built with */
+    uint16_t tx_pixel_num;      /*!< Pixels of the front buffer sent by ws2812b_kick() */
+    bool staged;                /*!< Front buffer swapped in, waiting for ws2812b_kick() */
 
-    gpio_num_t gpio_num; /*!< Number of the gpio pin */
-    uint16_t pixel_num;  /*!< Number of pixels in the LED strip */
-    uint8_t* buffer;     /*!< Pointer to pixel color data in GRB order */
+    ws2812b_mem_config_t mem; /*!< RMT memory actually allocated to the channel */
+    uint32_t irq_seen;        /*!< Encoder calls already reported by ws2812b_take_irq_count() */
 } ws2812b_dev_t;
 
 /**
@@ -33,17 +99,42 @@ typedef struct {
  */
 typedef ws2812b_dev_t* ws2812b_handle_t;
 
+/**
+ * @brief Splits the RMT memory between the strips.
+ *
+ * Without DMA the channel interrupts every half memory block to refill it, so
+ * every used strip gets one block and the blocks of unused channels go to the
+ * strips with the most symbols per block. Where the target has RMT DMA and
+ * WS2812B_DMA is set, the longest strips stream from a DMA buffer instead.
+ *
+ * @param[in]  pixel_num  Pixel count of every strip (0 = strip unused).
+ * @param[in]  strip_num  Number of strips.
+ * @param[out] mem        Per strip RMT memory, strip_num entries.
+ *
+ * @return
+ * - ESP_OK: Success.
+ * - ESP_ERR_INVALID_ARG: Null pointer.
+ * - ESP_ERR_NOT_SUPPORTED: More strips than RMT TX channels.
+ */
+esp_err_t ws2812b_plan_mem(const uint16_t* pixel_num, int strip_num, ws2812b_mem_config_t* mem);
+
 /**
  * @brief Allocates and initializes the WS2812B driver handle.
- * * @param[in]  gpio_num   GPIO pin for the data signal.
+ *
+ * If the channel cannot get the requested memory (DMA or several blocks), it
+ * falls back to a single block with a warning.
+ *
+ * @param[in]  gpio_num   GPIO pin for the data signal.
  * @param[in]  pixel_num  Total number of LEDs in the strip.
+ * @param[in]  mem        RMT memory for the channel, NULL for one block without DMA.
  * @param[out] ws2812b    Pointer to the handle to be initialized.
- * * @return
+ *
+ * @return
  * - ESP_OK: Success.
  * - ESP_ERR_NO_MEM: Allocation failed.
  * - ESP_ERR_INVALID_ARG: Invalid arguments.
  */
-esp_err_t ws2812b_init(gpio_num_t gpio_num, uint16_t pixel_num, ws2812b_handle_t* ws2812b);
+esp_err_t ws2812b_init(gpio_num_t gpio_num, uint16_t pixel_num, const ws2812b_mem_config_t* mem, ws2812b_handle_t* ws2812b);
 
 /**
  * @brief Sets the RGB color for a specific pixel in the buffer.
@@ -63,15 +154,71 @@ esp_err_t ws2812b_set_pixel(ws2812b_handle_t ws2812b, int pixel_idx, uint8_t red
 /**
  * @brief Transmits the internal buffer data to the LED strip.
  *
+ * Waits for the previous frame to leave the wire, swaps the back buffer to the
+ * front, and queues it without waiting for completion. The back buffer is
+ * refreshed with the transmitted frame so incremental updates stay valid.
+ *
+ * Only the pixels up to the last one that differs from the previous frame are
+ * sent, and strips without any change are skipped, since WS2812B pixels hold
+ * their latched colour. Dithered pixels count as changed on every call.
+ *
  * @param[in] ws2812b  Driver handle.
  *
  * @return
  * - ESP_OK: Transmission queued successfully.
+ * - ESP_ERR_TIMEOUT: Previous frame did not finish in time.
  * - ESP_ERR_INVALID_STATE: RMT driver not initialized or queue is full.
  * - ESP_ERR_INVALID_ARG: Handle is NULL.
  */
 esp_err_t ws2812b_show(ws2812b_handle_t ws2812b);
 
+/**
+ * @brief First half of ws2812b_show(): waits for the previous frame and swaps the buffers.
+ *
+ * Lets the caller prepare every strip before starting any of them, so the
+ * strips start with as little skew as possible. Stages the changed prefix of
+ * the strip only, and nothing if the buffer holds the frame that was sent last.
+ *
+ * @param[in] ws2812b  Driver handle.
+ *
+ * @return
+ * - ESP_OK: Frame staged (or nothing to send).
+ * - ESP_ERR_TIMEOUT: Previous frame did not finish in time.
+ * - ESP_ERR_INVALID_STATE: RMT driver not initialized.
+ * - ESP_ERR_INVALID_ARG: Handle is NULL.
+ */
+esp_err_t ws2812b_stage(ws2812b_handle_t ws2812b);
+
+/**
+ * @brief Stages the last frame sent again, for strips that must take part in a synchronised start.
+ *
+ * Replays the prefix staged last, from the cached symbol image when there is one.
+ *
+ * @param[in] ws2812b  Driver handle.
+ *
+ * @return
+ * - ESP_OK: Frame staged (or already staged).
+ * - ESP_ERR_TIMEOUT: Previous frame did not finish in time.
+ * - ESP_ERR_INVALID_STATE: RMT driver not initialized.
+ * - ESP_ERR_INVALID_ARG: Handle is NULL.
+ */
+esp_err_t ws2812b_stage_repeat(ws2812b_handle_t ws2812b);
+
+/**
+ * @brief Second half of ws2812b_show(): queues the staged frame on the RMT.
+ *
+ * With an RMT sync manager the channel is only armed and starts together with
+ * the rest of its group.
+ *
+ * @param[in] ws2812b  Driver handle.
+ *
+ * @return
+ * - ESP_OK: Transmission queued (or nothing staged).
+ * - ESP_ERR_INVALID_STATE: RMT driver not initialized or queue is full.
+ * - ESP_ERR_INVALID_ARG: Handle is NULL.
+ */
+esp_err_t ws2812b_kick(ws2812b_handle_t ws2812b);
+
 /**
  * @brief Deallocates the WS2812B driver and releases all resources.
  * * @note This function attempts to turn off the LEDs before deletion.
@@ -100,6 +247,41 @@ esp_err_t ws2812b_del(ws2812b_handle_t* ws2812b);
  */
 esp_err_t ws2812b_write(ws2812b_handle_t ws2812b, uint8_t* _buffer);
 
+/**
+ * @brief Copies a run of consecutive GRB pixels into the internal buffer.
+ *
+ * @note Used by the delta frame decoder to update only the changed pixels.
+ *
+ * @param[in] ws2812b      Driver handle.
+ * @param[in] pixel_idx    Index of the first pixel to overwrite.
+ * @param[in] src_data     Pointer to pixel_count * 3 bytes in GRB order.
+ * @param[in] pixel_count  Number of pixels to copy.
+ *
+ * @return
+ * - ESP_OK: Success.
+ * - ESP_ERR_INVALID_ARG: Null pointer or range out of bounds.
+ */
+esp_err_t ws2812b_write_pixels(ws2812b_handle_t ws2812b, int pixel_idx, const uint8_t* src_data, int pixel_count);
+
+/**
+ * @brief The output tables changed: recounts the output levels and resends the whole strip through them.
+ *
+ * Takes effect with the next ws2812b_stage(), the colours as written stay.
+ *
+ * @param[in] ws2812b  Driver handle.
+ */
+void ws2812b_refresh(ws2812b_handle_t ws2812b);
+
+/**
+ * @brief Sets the factor the colours are scaled by on their way to the strip.
+ *
+ * Takes effect with the next ws2812b_stage(). A new factor resends the whole strip.
+ *
+ * @param[in] ws2812b  Driver handle.
+ * @param[in] scale    8.8 fixed point, OUTPUT_LUT_SCALE_NONE (256) sends the colours unchanged.
+ */
+void ws2812b_set_scale(ws2812b_handle_t ws2812b, uint16_t scale);
+
 /**
  * @brief Fills the entire LED strip with a single color.
  *
@@ -139,6 +321,20 @@ esp_err_t ws2812b_wait_done(ws2812b_handle_t ws2812b);
  */
 esp_err_t ws2812b_print_buffer(ws2812b_handle_t ws2812b);
 
+/**
+ * @brief Returns the RMT interrupts taken by the strip since the previous call.
+ *
+ * Every encoder call after the first one of a transaction is a refill interrupt
+ * (half a memory block, or half the DMA buffer, on the wire) and the first one
+ * stands for the trans-done interrupt, so the encoder call count is the
+ * interrupt count.
+ *
+ * @param[in] ws2812b  Driver handle.
+ *
+ * @return Interrupt count, 0 if the handle is NULL.
+ */
+uint32_t ws2812b_take_irq_count(ws2812b_handle_t ws2812b);
+
 esp_err_t ws2812b_get_pixel(ws2812b_handle_t ws2812b, int pixel_idx, uint8_t* red, uint8_t* green, uint8_t* blue);
 
 void ws2812b_test();
@@ -18,4 +18,12 @@ const hw_config_t BOARD_HW_CONFIG = {
     .pca9955b_5 = 0x5c,
     .pca9955b_6 = 0x1f,
     .pca9955b_7 = 0x20,
+
+#if I2C_BUS_NUM > 1
+    .i2c_buses = {{.sda = GPIO_NUM_21, .scl = GPIO_NUM_22}, {.sda = GPIO_NUM_16, .scl = GPIO_NUM_4}},
+    .i2c_bus_idx = {0, 0, 0, 1, 1, 1},
+#else
+    .i2c_buses = {{.sda = GPIO_NUM_21, .scl = GPIO_NUM_22}},
+    .i2c_bus_idx = {0},
+#endif
 };
\ No newline at end of file
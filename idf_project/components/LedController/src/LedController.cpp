@@ -4,9 +4,11 @@
 #include "esp_log.h"
 #include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
 #include "freertos/task.h"
 
 #include "BoardConfig.h"
+#include "output_lut.h"
 #include "pca9955b_hal.h"
 #include "ws2812b_hal.h"
 
@@ -14,37 +16,93 @@
 
 static const char* TAG = "LedController";
 
-LedController::LedController() {}
+#define PCA_DONE_BIT(i) ((EventBits_t)(1UL << (i)))
+#define PCA_DONE_ALL_BITS (PCA_DONE_BIT(PCA9955B_NUM) - 1)
+
+LedController::LedController():
+    bus_handles(), i2c_freq(), i2c_retry_us(), i2c_postpone_ms(), i2c_recoveries(), i2c_recovery_us(), pca_done_group(NULL), pca_queue_us(0), pca_wait_bits(0), rmt_sync(NULL), pca_allcall(), pca_broadcast(false),
+    power_budget_ma(POWER_BUDGET_MA), power_ma(0), power_scale(OUTPUT_LUT_SCALE_NONE), lut_version(0) {}
 
 LedController::~LedController() {}
 
 esp_err_t LedController::init(ch_info_t _ch_info) {
     esp_err_t ret = ESP_OK;
+    ws2812b_mem_config_t rmt_mem[WS2812B_NUM];
     ch_info = _ch_info;
 
     // 1. Input Validation
-    ESP_RETURN_ON_FALSE(GPIO_IS_VALID_GPIO(GPIO_NUM_21), ESP_ERR_INVALID_ARG, TAG, "Invalid SDA GPIO");
-    ESP_RETURN_ON_FALSE(GPIO_IS_VALID_GPIO(GPIO_NUM_22), ESP_ERR_INVALID_ARG, TAG, "Invalid SCL GPIO");
+    for(int b = 0; b < I2C_BUS_NUM; b++) {
+        ESP_RETURN_ON_FALSE(GPIO_IS_VALID_GPIO(BOARD_HW_CONFIG.i2c_buses[b].sda), ESP_ERR_INVALID_ARG, TAG, "Invalid SDA GPIO on bus %d", b);
+        ESP_RETURN_ON_FALSE(GPIO_IS_VALID_GPIO(BOARD_HW_CONFIG.i2c_buses[b].scl), ESP_ERR_INVALID_ARG, TAG, "Invalid SCL GPIO on bus %d", b);
+    }
+    for(int i = 0; i < PCA9955B_NUM; i++) {
+        ESP_RETURN_ON_FALSE(BOARD_HW_CONFIG.i2c_bus_idx[i] < I2C_BUS_NUM, ESP_ERR_INVALID_ARG, TAG, "PCA9955B[%d] on unknown I2C bus", i);
+    }
 
     // 2. Initialize output handles to 0
     memset(ws2812b_devs, 0, sizeof(ws2812b_devs));
     memset(pca9955b_devs, 0, sizeof(pca9955b_devs));
-    bus_handle = NULL;
-
-    // 3. Initialize I2C Bus
-    ESP_GOTO_ON_ERROR(i2c_bus_init(GPIO_NUM_21, GPIO_NUM_22, &bus_handle), err, TAG, "Failed to initialize I2C bus");
+    memset(bus_handles, 0, sizeof(bus_handles));
+    memset(i2c_retry_us, 0, sizeof(i2c_retry_us));
+    memset(i2c_postpone_ms, 0, sizeof(i2c_postpone_ms));
+    memset(i2c_recoveries, 0, sizeof(i2c_recoveries));
+    memset(i2c_recovery_us, 0, sizeof(i2c_recovery_us));
+    memset(pca_allcall, 0, sizeof(pca_allcall));
+    rmt_sync = NULL;
+    pca_wait_bits = 0;
+    pca_broadcast = false;
+
+    // Gamma / brightness tables, kept across re-inits
+    output_lut_init();
+    lut_version = output_lut_get_version();
+    power_ma = 0;
+    power_scale = OUTPUT_LUT_SCALE_NONE;
+    frame_stats_set_counter_limit(FRAME_COUNTER_CURRENT, power_budget_ma);
+
+    // No PCA transfer is pending until the first show()
+    pca_done_group = xEventGroupCreate();
+    ESP_RETURN_ON_FALSE(pca_done_group, ESP_ERR_NO_MEM, TAG, "Failed to create PCA event group");
+    xEventGroupSetBits(pca_done_group, PCA_DONE_ALL_BITS);
+
+    // 3. Initialize the I2C Buses
+    for(int b = 0; b < I2C_BUS_NUM; b++) {
+        ESP_GOTO_ON_ERROR(init_i2c_bus(b), err, TAG, "Failed to initialize I2C bus %d", b);
+    }
 
-    // 4. Initialize WS2812B Strips
+    // 4. Initialize WS2812B Strips, sharing the RMT memory by strip length (unused strips stay NULL)
+    ESP_GOTO_ON_ERROR(ws2812b_plan_mem(ch_info.rmt_strips, WS2812B_NUM, rmt_mem), err, TAG, "Failed to plan RMT memory");
     for(int i = 0; i < WS2812B_NUM; i++) {
-        ESP_GOTO_ON_ERROR(
-            ws2812b_init(BOARD_HW_CONFIG.rmt_pins[i], ch_info.rmt_strips[i], &ws2812b_devs[i]), err, TAG, "Failed to init WS2812B[%d]", i);
+        if(ch_info.rmt_strips[i] == 0) {
+            continue;
+        }
+        ESP_GOTO_ON_ERROR(ws2812b_init(BOARD_HW_CONFIG.rmt_pins[i], ch_info.rmt_strips[i], &rmt_mem[i], &ws2812b_devs[i]),
+                          err,
+                          TAG,
+                          "Failed to init WS2812B[%d]",
+                          i);
     }
+    init_sync();
 
-    // 5. Initialize PCA9955B Chips
+    // 5. Initialize PCA9955B Chips, each on its own bus
     for(int i = 0; i < PCA9955B_NUM; i++) {
-        ESP_GOTO_ON_ERROR(pca9955b_init(BOARD_HW_CONFIG.i2c_addrs[i], bus_handle, &pca9955b_devs[i]), err, TAG, "Failed to init PCA9955B[%d]", i);
+        int bus = BOARD_HW_CONFIG.i2c_bus_idx[i];
+        ESP_GOTO_ON_ERROR(pca9955b_init(BOARD_HW_CONFIG.i2c_addrs[i], bus_handles[bus], i2c_freq[bus], &pca9955b_devs[i]),
+                          err,
+                          TAG,
+                          "Failed to init PCA9955B[%d]",
+                          i);
     }
 
+#if PCA9955B_ALLCALL
+    // Not fatal: fill() then goes out chip by chip
+    for(int b = 0; b < I2C_BUS_NUM; b++) {
+        if(pca9955b_init_allcall(bus_handles[b], i2c_freq[b], &pca_allcall[b]) != ESP_OK) {
+            ESP_LOGW(TAG, "PCA9955B ALLCALL unavailable on bus %d, broadcasts disabled", b);
+            pca_allcall[b] = NULL;
+        }
+    }
+#endif
+
     ESP_LOGI(TAG, "LedController initialized successfully");
     return ESP_OK;
 
@@ -54,6 +112,57 @@ err:
     return ret;
 }
 
+esp_err_t LedController::init_i2c_bus(int bus) {
+    const i2c_pins_t* pins = &BOARD_HW_CONFIG.i2c_buses[bus];
+    i2c_port_num_t port = (i2c_port_num_t)(I2C_NUM_0 + bus);
+
+    // 1. Fastest clock every chip of the bus handles
+    i2c_freq[bus] = I2C_FREQ;
+#if I2C_SPEED_PROBE
+    uint8_t addrs[PCA9955B_NUM];
+    int addr_num = 0;
+    for(int i = 0; i < PCA9955B_NUM; i++) {
+        if(BOARD_HW_CONFIG.i2c_bus_idx[i] == bus) {
+            addrs[addr_num++] = BOARD_HW_CONFIG.i2c_addrs[i];
+        }
+    }
+    if(i2c_bus_probe_speed(port, pins->sda, pins->scl, addrs, addr_num, &i2c_freq[bus]) != ESP_OK) {
+        ESP_LOGW(TAG, "I2C bus %d speed probe failed, staying at %lu kHz", bus, (unsigned long)(I2C_FREQ / 1000));
+    }
+#endif
+    frame_stats_set_i2c_hz(bus, i2c_freq[bus]);
+
+    // 2. The bus the chips are driven on
+    return i2c_bus_init(port, pins->sda, pins->scl, &bus_handles[bus]);
+}
+
+void LedController::init_sync() {
+#if WS2812B_USE_SYNC
+    rmt_channel_handle_t channels[WS2812B_NUM];
+    size_t channel_num = 0;
+
+    for(int i = 0; i < WS2812B_NUM; i++) {
+        if(ws2812b_devs[i]) {
+            channels[channel_num++] = ws2812b_devs[i]->rmt_channel;
+        }
+    }
+    if(channel_num < 2) {
+        return;
+    }
+
+    // Not fatal: the strips are still armed back to back
+    rmt_sync_manager_config_t sync_config = {
+        .tx_channel_array = channels,
+        .array_size = channel_num,
+    };
+    esp_err_t err = rmt_new_sync_manager(&sync_config, &rmt_sync);
+    if(err != ESP_OK) {
+        ESP_LOGW(TAG, "RMT sync manager unavailable, strips start unsynchronised: %s", esp_err_to_name(err));
+        rmt_sync = NULL;
+    }
+#endif
+}
+
 esp_err_t LedController::write_buffer(int ch_idx, uint8_t* data) {
     // 1. Validate Input
     ESP_RETURN_ON_FALSE(data, ESP_ERR_INVALID_ARG, TAG, "Data buffer is NULL");
@@ -95,38 +204,190 @@ esp_err_t LedController::write_buffer(int ch_idx, uint8_t* data) {
     return ESP_ERR_INVALID_ARG;
 }
 
+esp_err_t LedController::write_pixels(int ch_idx, int pixel_idx, const uint8_t* data, int pixel_count) {
+    // 1. Validate Input
+    ESP_RETURN_ON_FALSE(data, ESP_ERR_INVALID_ARG, TAG, "Data buffer is NULL");
+    ESP_RETURN_ON_FALSE(ch_idx >= 0 && ch_idx < WS2812B_NUM + PCA9955B_CH_NUM, ESP_ERR_INVALID_ARG, TAG, "Channel index %d out of range", ch_idx);
+
+    // 2. Handle WS2812B Strips: copy the run in place
+    if(ch_idx < WS2812B_NUM) {
+        ESP_RETURN_ON_FALSE(ws2812b_devs[ch_idx], ESP_ERR_INVALID_STATE, TAG, "WS2812B[%d] not initialized", ch_idx);
+        return ws2812b_write_pixels(ws2812b_devs[ch_idx], pixel_idx, data, pixel_count);
+    }
+
+    // 3. Handle PCA9955B LEDs: each channel holds exactly one pixel
+    ESP_RETURN_ON_FALSE(pixel_idx == 0 && pixel_count == 1, ESP_ERR_INVALID_ARG, TAG, "PCA channel %d holds a single pixel", ch_idx);
+    return write_buffer(ch_idx, (uint8_t*)data);
+}
+
 esp_err_t LedController::show() {
     esp_err_t ret = ESP_OK;
     esp_err_t err = ESP_OK;
 
-#if SHOW_TIME_PER_FRAME
-    uint64_t start = esp_timer_get_time();
-#endif
+    int64_t start = esp_timer_get_time();
 
-    // 1. Trigger WS2812B transmission (Asynchronous/Non-blocking)
+    // New output tables (brightness, gamma): every LED goes out again through them, the colours as written stay
+    uint32_t version = output_lut_get_version();
+    if(version != lut_version) {
+        for(int i = 0; i < WS2812B_NUM; i++) {
+            ws2812b_refresh(ws2812b_devs[i]);
+        }
+        for(int i = 0; i < PCA9955B_NUM; i++) {
+            pca9955b_refresh(pca9955b_devs[i]);
+        }
+        lut_version = version;
+    }
+
+    // 1. Wait for the previous WS2812B frame to leave the wire
+    // The caller rendered the next frame into the back buffers meanwhile.
+    for(int i = 0; i < WS2812B_NUM; i++) {
+        if(ws2812b_devs[i] && (ws2812b_devs[i]->dirty_num > 0 || ws2812b_devs[i]->dither_num > 0)) {
+            err = ws2812b_wait_done(ws2812b_devs[i]);
+            if(err != ESP_OK) {
+                ESP_LOGE(TAG, "Wait done failed for WS2812B[%d]: %s", i, esp_err_to_name(err));
+                ret = err;
+            }
+        }
+    }
+    frame_stats_record(FRAME_STAGE_RMT_WAIT, start);
+
+    // The finished frames' refill and done interrupts
+    uint32_t irq_count = 0;
+    for(int i = 0; i < WS2812B_NUM; i++) {
+        irq_count += ws2812b_take_irq_count(ws2812b_devs[i]);
+    }
+    frame_stats_count(FRAME_COUNTER_RMT_IRQ, irq_count);
+
+    // The current limiter factor is applied while the strips are staged and the chips packed
+    limit_power();
+
+    // 2. Swap every strip first, then start them back to back (Asynchronous/Non-blocking)
+    start = esp_timer_get_time();
     for(int i = 0; i < WS2812B_NUM; i++) {
         if(ws2812b_devs[i]) {
-            err = ws2812b_show(ws2812b_devs[i]);
+            err = ws2812b_stage(ws2812b_devs[i]);
             if(err != ESP_OK) {
                 // Log error but continue to try updating other LEDs
-                ESP_LOGE(TAG, "Failed to show WS2812B[%d]: %s", i, esp_err_to_name(err));
+                ESP_LOGE(TAG, "Failed to stage WS2812B[%d]: %s", i, esp_err_to_name(err));
                 ret = err;  // Latch the error code
             }
         }
     }
 
-    // 2. Trigger PCA9955B transmission (Synchronous/Blocking)
-    for(int i = 0; i < PCA9955B_NUM; i++) {
-        if(pca9955b_devs[i]) {
-            err = pca9955b_show(pca9955b_devs[i]);
+#if WS2812B_USE_SYNC
+    // A sync group only starts once every member is armed, so one new frame resends them all
+    if(rmt_sync) {
+        bool staged = false;
+        for(int i = 0; i < WS2812B_NUM; i++) {
+            staged |= ws2812b_devs[i] && ws2812b_devs[i]->staged;
+        }
+        for(int i = 0; i < WS2812B_NUM && staged; i++) {
+            if(ws2812b_devs[i]) {
+                err = ws2812b_stage_repeat(ws2812b_devs[i]);
+                if(err != ESP_OK) {
+                    ESP_LOGE(TAG, "Failed to repeat WS2812B[%d]: %s", i, esp_err_to_name(err));
+                    ret = err;
+                }
+            }
+        }
+        rmt_sync_reset(rmt_sync);  // Drop a group left half armed by a failed frame
+    }
+#endif
+
+    int64_t first_kick_us = -1;
+    int64_t last_kick_us = 0;
+    for(int i = 0; i < WS2812B_NUM; i++) {
+        if(ws2812b_devs[i] && ws2812b_devs[i]->staged) {
+            last_kick_us = esp_timer_get_time();
+            if(first_kick_us < 0) {
+                first_kick_us = last_kick_us;
+            }
+            err = ws2812b_kick(ws2812b_devs[i]);
             if(err != ESP_OK) {
-                ESP_LOGE(TAG, "Failed to show PCA9955B[%d]: %s", i, esp_err_to_name(err));
+                ESP_LOGE(TAG, "Failed to show WS2812B[%d]: %s", i, esp_err_to_name(err));
                 ret = err;
             }
         }
     }
+    if(first_kick_us >= 0) {
+        frame_stats_record_us(FRAME_STAGE_RMT_SKEW, (uint32_t)(last_kick_us - first_kick_us));
+    }
+
+    frame_stats_record(FRAME_STAGE_RMT_KICK, start);
+
+    // 3. Trigger PCA9955B transmission
+    // The previous round had a whole frame to finish, so collecting it rarely waits.
+    // Failures are reported here and the affected chips are resent in this round.
+    err = collect_pca(pca_wait_bits);
+    if(err != ESP_OK) {
+        ret = err;
+    }
+
+    // A target holding SDA low wedges its whole bus: free it, the strips keep playing
+    for(int b = 0; b < I2C_BUS_NUM; b++) {
+        if(i2c_bus_wedged(b)) {
+            err = recover_i2c_bus(b);
+            if(err != ESP_OK) {
+                ret = err;
+            }
+        }
+    }
+
+    pca_queue_us = esp_timer_get_time();
+
+    // A fill() reaches every chip of a bus in one transaction, the chips then only send what differs.
+    for(int b = 0; b < I2C_BUS_NUM && pca_broadcast; b++) {
+        if(pca_allcall[b] == NULL) {
+            continue;
+        }
+        err = pca9955b_broadcast_write(pca_allcall[b], pca9955b_devs, PCA9955B_NUM);
+        if(err != ESP_OK) {
+            ESP_LOGW(TAG, "PCA9955B broadcast on bus %d failed, sending chip by chip: %s", b, esp_err_to_name(err));
+        }
+    }
+    pca_broadcast = false;
+
+    // Healthy chips go first, so a failing one probed behind them cannot hold up their bus,
+    // and only they are waited for. Chips on different buses transfer in parallel.
+    int order[PCA9955B_NUM];
+    int order_num = 0;
+    for(int pass = 0; pass < 2; pass++) {
+        for(int i = 0; i < PCA9955B_NUM; i++) {
+            if(pca9955b_devs[i] && (pca9955b_devs[i]->health == PCA9955B_HEALTHY) == (pass == 0)) {
+                order[order_num++] = i;
+            }
+        }
+    }
 
-    // 3. Wait for WS2812B transmission to complete
+    pca_wait_bits = 0;
+    for(int n = 0; n < order_num; n++) {
+        int i = order[n];
+        if(pca9955b_devs[i]->health == PCA9955B_HEALTHY) {
+            pca_wait_bits |= PCA_DONE_BIT(i);
+        }
+#if PCA9955B_ASYNC
+        err = pca9955b_show_async(pca9955b_devs[i], pca_done_group, PCA_DONE_BIT(i));
+#else
+        err = pca9955b_show(pca9955b_devs[i]);
+#endif
+        if(err != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to show PCA9955B[%d]: %s", i, esp_err_to_name(err));
+            ret = err;
+        }
+    }
+#if !PCA9955B_ASYNC
+    frame_stats_record(FRAME_STAGE_I2C, pca_queue_us);
+#endif
+
+    // Return the last error encountered, or ESP_OK if all went well
+    return ret;
+}
+
+esp_err_t LedController::wait_done() {
+    esp_err_t ret = ESP_OK;
+    esp_err_t err = ESP_OK;
+
+    // 1. Wait for WS2812B transmission to complete
     for(int i = 0; i < WS2812B_NUM; i++) {
         if(ws2812b_devs[i]) {
             err = ws2812b_wait_done(ws2812b_devs[i]);
@@ -137,39 +398,203 @@ esp_err_t LedController::show() {
         }
     }
 
-#if SHOW_TIME_PER_FRAME
-    end = esp_timer_get_time();
-    ESP_LOGI(TAG, "show() execution time: %llu us", (end - start));
+    // 2. Wait for the queued PCA9955B transfers, probes of failing chips included
+    err = collect_pca(PCA_DONE_ALL_BITS);
+    if(err != ESP_OK) {
+        ret = err;
+    }
+
+    return ret;
+}
+
+esp_err_t LedController::collect_pca(EventBits_t wait_bits) {
+    esp_err_t ret = ESP_OK;
+    esp_err_t err = ESP_OK;
+
+    if(pca_done_group == NULL) {
+        return ESP_OK;
+    }
+
+    // 1. Block until every waited-for chip reported completion (bits are not consumed)
+    if(wait_bits != 0) {
+        EventBits_t bits = xEventGroupWaitBits(pca_done_group, wait_bits, pdFALSE, pdTRUE, pdMS_TO_TICKS(I2C_TIMEOUT_MS));
+        if((bits & wait_bits) != wait_bits) {
+            ESP_LOGW(TAG, "PCA9955B transfers timed out (done 0x%02lx)", (unsigned long)bits);
+        }
+    }
+
+    // 2. Collect per-chip results; the round took until its last completion
+    int64_t done_us = 0;
+    for(int i = 0; i < PCA9955B_NUM; i++) {
+        if(pca9955b_devs[i]) {
+#if PCA9955B_ASYNC
+            // A failing chip's probe is collected once it is off the bus
+            if(!(wait_bits & PCA_DONE_BIT(i)) && pca9955b_devs[i]->in_flight) {
+                continue;
+            }
+            if((wait_bits & PCA_DONE_BIT(i)) && pca9955b_devs[i]->done_group && pca9955b_devs[i]->done_us > done_us) {
+                done_us = pca9955b_devs[i]->done_us;
+            }
 #endif
+            err = pca9955b_finish_async(pca9955b_devs[i]);
+            if(err != ESP_OK) {
+                ESP_LOGE(TAG, "PCA9955B[%d] transfer failed: %s", i, esp_err_to_name(err));
+                ret = err;
+            }
+        }
+    }
+    if(done_us > pca_queue_us) {
+        frame_stats_record_us(FRAME_STAGE_I2C, (uint32_t)(done_us - pca_queue_us));
+    }
 
-    // Return the last error encountered, or ESP_OK if all went well
+    return ret;
+}
+
+bool LedController::i2c_bus_wedged(int bus) {
+    bool failing = false;
+
+    // 1. Not again before the last recovery had time to show an effect
+    if(esp_timer_get_time() < i2c_retry_us[bus]) {
+        return false;
+    }
+    // A failed recovery left no bus behind
+    if(bus_handles[bus] == NULL) {
+        return true;
+    }
+
+    // 2. Only an idle bus with failing chips is worth a look at SDA
+    for(int i = 0; i < PCA9955B_NUM; i++) {
+        if(pca9955b_devs[i] == NULL || BOARD_HW_CONFIG.i2c_bus_idx[i] != bus) {
+            continue;
+        }
+        if(pca9955b_devs[i]->in_flight) {
+            return false;
+        }
+        failing |= pca9955b_devs[i]->health != PCA9955B_HEALTHY;
+    }
+
+    return failing && i2c_bus_sda_stuck(BOARD_HW_CONFIG.i2c_buses[bus].sda);
+}
+
+esp_err_t LedController::recover_i2c_bus(int bus) {
+    const i2c_pins_t* pins = &BOARD_HW_CONFIG.i2c_buses[bus];
+    esp_err_t ret = ESP_OK;
+    esp_err_t err = ESP_OK;
+
+    int64_t start = esp_timer_get_time();
+
+    // 1. Deleting the bus with transfers still queued would run their callbacks against freed handles:
+    //    leave it alone, i2c_bus_wedged() reports it again once the backoff ran out. The wait doubles
+    //    per postponement so a bus that never drains does not cost every frame I2C_TIMEOUT_MS.
+    if(bus_handles[bus] != NULL) {
+        err = i2c_master_bus_wait_all_done(bus_handles[bus], I2C_TIMEOUT_MS);
+        if(err != ESP_OK) {
+            i2c_postpone_ms[bus] = i2c_postpone_ms[bus] == 0 ? PCA9955B_RETRY_MIN_MS : i2c_postpone_ms[bus] * 2;
+            if(i2c_postpone_ms[bus] > PCA9955B_RETRY_MAX_MS) {
+                i2c_postpone_ms[bus] = PCA9955B_RETRY_MAX_MS;
+            }
+            i2c_retry_us[bus] = esp_timer_get_time() + i2c_postpone_ms[bus] * 1000LL;
+            ESP_LOGW(TAG, "I2C bus %d wedged with transfers pending, recovery postponed by %lu ms: %s", bus, (unsigned long)i2c_postpone_ms[bus], esp_err_to_name(err));
+            return err;
+        }
+    }
+    i2c_postpone_ms[bus] = 0;
+    ESP_LOGW(TAG, "I2C bus %d wedged, recovering", bus);
+
+    // 2. Take the chips off the old bus (timed out transfers are dropped)
+    for(int i = 0; i < PCA9955B_NUM; i++) {
+        if(pca9955b_devs[i] && BOARD_HW_CONFIG.i2c_bus_idx[i] == bus) {
+            pca9955b_detach(pca9955b_devs[i]);
+        }
+    }
+    if(pca_allcall[bus] != NULL) {
+        pca9955b_detach(pca_allcall[bus]);
+    }
+    if(bus_handles[bus] != NULL) {
+        err = i2c_del_master_bus(bus_handles[bus]);
+        if(err != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to delete I2C bus %d: %s", bus, esp_err_to_name(err));
+        }
+        bus_handles[bus] = NULL;
+    }
+
+    // 3. Clock the stuck target free; a bus that stays low is rebuilt anyway and tried again later
+    ret = i2c_bus_clear(pins->sda, pins->scl);
+
+    // 4. A fresh bus under the same chips
+    err = i2c_bus_init((i2c_port_num_t)(I2C_NUM_0 + bus), pins->sda, pins->scl, &bus_handles[bus]);
+    if(err == ESP_OK) {
+        for(int i = 0; i < PCA9955B_NUM; i++) {
+            if(pca9955b_devs[i] && BOARD_HW_CONFIG.i2c_bus_idx[i] == bus && pca9955b_attach(pca9955b_devs[i], bus_handles[bus]) != ESP_OK) {
+                err = ESP_FAIL;
+            }
+        }
+        if(pca_allcall[bus] != NULL && pca9955b_attach(pca_allcall[bus], bus_handles[bus]) != ESP_OK) {
+            err = ESP_FAIL;
+        }
+    }
+    if(err != ESP_OK) {
+        ret = err;
+    }
+
+    // 5. Account; a failed attempt waits for the longest chip backoff
+    uint32_t elapsed = (uint32_t)(esp_timer_get_time() - start);
+    i2c_recoveries[bus]++;
+    i2c_recovery_us[bus] = elapsed;
+    i2c_retry_us[bus] = esp_timer_get_time() + (ret == ESP_OK ? PCA9955B_RETRY_MIN_MS : PCA9955B_RETRY_MAX_MS) * 1000LL;
+    if(ret == ESP_OK) {
+        ESP_LOGI(TAG, "I2C bus %d recovered in %lu us", bus, (unsigned long)elapsed);
+    } else {
+        ESP_LOGE(TAG, "I2C bus %d recovery failed after %lu us: %s", bus, (unsigned long)elapsed, esp_err_to_name(ret));
+    }
     return ret;
 }
 
 esp_err_t LedController::deinit() {
     ESP_LOGI(TAG, "De-initializing LED Controller...");
 
-    // 1. Free WS2812B Devices
+    // 1. Free WS2812B Devices (the sync group first, it holds their channels)
+#if WS2812B_USE_SYNC
+    if(rmt_sync != NULL) {
+        if(rmt_del_sync_manager(rmt_sync) != ESP_OK) {
+            ESP_LOGW(TAG, "Error deleting RMT sync manager");
+        }
+        rmt_sync = NULL;
+    }
+#endif
     for(int i = 0; i < WS2812B_NUM; i++) {
         if(ws2812b_del(&(ws2812b_devs[i])) != ESP_OK) {
             ESP_LOGW(TAG, "Error deleting WS2812B[%d]", i);
         }
     }
 
-    // 2. Free PCA9955B Devices
+    // 2. Free PCA9955B Devices (pca9955b_del waits for pending transfers)
+    for(int b = 0; b < I2C_BUS_NUM; b++) {
+        if(pca9955b_del(&pca_allcall[b]) != ESP_OK) {
+            ESP_LOGW(TAG, "Error deleting PCA9955B ALLCALL on bus %d", b);
+        }
+    }
+    pca_broadcast = false;
     for(int i = 0; i < PCA9955B_NUM; i++) {
         if(pca9955b_del(&(pca9955b_devs[i])) != ESP_OK) {
             ESP_LOGW(TAG, "Error deleting PCA9955B[%d]", i);
         }
     }
 
-    // 3. Free I2C Bus
-    if(bus_handle != NULL) {
-        esp_err_t err = i2c_del_master_bus(bus_handle);
-        if(err != ESP_OK) {
-            ESP_LOGE(TAG, "Failed to delete I2C bus: %s", esp_err_to_name(err));
+    // 3. Free I2C Buses
+    for(int b = 0; b < I2C_BUS_NUM; b++) {
+        if(bus_handles[b] != NULL) {
+            esp_err_t err = i2c_del_master_bus(bus_handles[b]);
+            if(err != ESP_OK) {
+                ESP_LOGE(TAG, "Failed to delete I2C bus %d: %s", b, esp_err_to_name(err));
+            }
+            bus_handles[b] = NULL;  // Prevent double-free if deinit is called again
         }
-        bus_handle = NULL;  // Prevent double-free if deinit is called again
+    }
+
+    if(pca_done_group != NULL) {
+        vEventGroupDelete(pca_done_group);
+        pca_done_group = NULL;
     }
 
     ESP_LOGI(TAG, "De-initialization complete");
@@ -193,7 +618,13 @@ esp_err_t LedController::fill(uint8_t red, uint8_t green, uint8_t blue) {
         }
     }
 
-    // 2. Fill PCA9955B Chips
+    // 2. Fill PCA9955B Chips (the shadow buffers, the colour itself is broadcast by show())
+    for(int b = 0; b < I2C_BUS_NUM; b++) {
+        if(pca_allcall[b] != NULL) {
+            pca9955b_fill(pca_allcall[b], red, green, blue);
+            pca_broadcast = true;
+        }
+    }
     for(int i = 0; i < PCA9955B_NUM; i++) {
         // Ensure the device handle is valid
         if(pca9955b_devs[i] != NULL) {
@@ -221,6 +652,9 @@ esp_err_t LedController::black_out() {
 
     // 2. Flush changes to hardware immediately
     esp_err_t ret_show = show();
+    if(ret_show == ESP_OK) {
+        ret_show = wait_done();
+    }
 
     // 3. Return the first error encountered
     if(ret != ESP_OK) {
@@ -230,6 +664,130 @@ esp_err_t LedController::black_out() {
     return ret_show;
 }
 
+/**
+ * @brief Dims every PCA9955B output (current scaling, 255 = full) in one I2C transaction.
+ *
+ * The PWM values are left alone, so frames keep their colours on top of the
+ * dimmed level. Falls back to restoring IREF chip by chip on the next show()
+ * if the broadcast fails or ALLCALL is disabled.
+ */
+esp_err_t LedController::set_pca_brightness(uint8_t brightness) {
+    // 1. Let the pending round finish, a late chip burst must not race the broadcast (failing chips are not waited for)
+    esp_err_t ret = collect_pca(pca_wait_bits);
+
+    // 2. Broadcast per bus, or have every chip of the bus restore its IREF at the new level
+    for(int b = 0; b < I2C_BUS_NUM; b++) {
+        if(pca_allcall[b] != NULL) {
+            esp_err_t err = pca9955b_broadcast_brightness(pca_allcall[b], pca9955b_devs, PCA9955B_NUM, brightness);
+            if(err != ESP_OK) {
+                ret = err;
+            }
+            continue;
+        }
+        for(int i = 0; i < PCA9955B_NUM; i++) {
+            if(pca9955b_devs[i] != NULL && BOARD_HW_CONFIG.i2c_bus_idx[i] == b) {
+                pca9955b_devs[i]->IREF_cmd[1] = brightness;
+                pca9955b_devs[i]->need_reset_IREF = true;
+            }
+        }
+    }
+    return ret;
+}
+
+void LedController::set_power_budget(uint32_t budget_ma) {
+    power_budget_ma = budget_ma;
+    frame_stats_set_counter_limit(FRAME_COUNTER_CURRENT, budget_ma);
+}
+
+uint32_t LedController::get_current_ma() {
+    return power_ma;
+}
+
+void LedController::limit_power() {
+    uint64_t led_ua = 0;
+    uint64_t idle_ua = 0;
+
+    // 1. Estimate from the level sums the drivers keep up to date, no pixel is read here
+    for(int i = 0; i < WS2812B_NUM; i++) {
+        if(ws2812b_devs[i]) {
+            led_ua += ((uint64_t)ws2812b_devs[i]->power_sum * POWER_WS2812B_UA_PER_STEP) >> 8;
+            idle_ua += (uint64_t)ws2812b_devs[i]->pixel_num * POWER_WS2812B_IDLE_UA;
+        }
+    }
+    for(int i = 0; i < PCA9955B_NUM; i++) {
+        if(pca9955b_devs[i]) {
+            // The output current follows the chip's IREF (set_pca_brightness())
+            led_ua += (uint64_t)pca9955b_devs[i]->level_sum * POWER_PCA9955B_UA_PER_STEP * pca9955b_devs[i]->IREF_cmd[1] / 0xFF;
+        }
+    }
+    power_ma = (uint32_t)((led_ua + idle_ua) / 1000);
+
+    // 2. The factor that would just fit the budget, one for every LED, the quiescent current stays
+    uint64_t budget_ua = (uint64_t)power_budget_ma * 1000;
+    uint64_t fit = OUTPUT_LUT_SCALE_NONE + POWER_SCALE_STEP;
+    if(power_budget_ma > 0 && led_ua > 0) {
+        fit = budget_ua > idle_ua ? (budget_ua - idle_ua) * OUTPUT_LUT_SCALE_NONE / led_ua : 0;
+    }
+
+    // 3. Coarse steps: a lower factor applies at once, a higher one only with a full step of headroom,
+    // so a frame hovering at the budget does not resend every LED each time
+    uint16_t scale = power_scale;
+    if(fit < power_scale) {
+        scale = fit / POWER_SCALE_STEP * POWER_SCALE_STEP;
+    } else if(fit >= (uint64_t)power_scale + 2 * POWER_SCALE_STEP) {
+        scale = fit >= OUTPUT_LUT_SCALE_NONE + POWER_SCALE_STEP ? OUTPUT_LUT_SCALE_NONE : (fit - POWER_SCALE_STEP) / POWER_SCALE_STEP * POWER_SCALE_STEP;
+    }
+
+    // 4. A new factor resends every LED with the frame, the broadcast handles included
+    if(scale != power_scale) {
+        for(int i = 0; i < WS2812B_NUM; i++) {
+            ws2812b_set_scale(ws2812b_devs[i], scale);
+        }
+        for(int i = 0; i < PCA9955B_NUM; i++) {
+            pca9955b_set_scale(pca9955b_devs[i], scale);
+        }
+        for(int b = 0; b < I2C_BUS_NUM; b++) {
+            pca9955b_set_scale(pca_allcall[b], scale);
+        }
+        power_scale = scale;
+    }
+
+    frame_stats_count(FRAME_COUNTER_CURRENT, power_ma);
+    frame_stats_count(FRAME_COUNTER_LIMITED, (uint32_t)((((led_ua * scale) >> 8) + idle_ua) / 1000));
+}
+
+void LedController::print_pca_health() {
+    static const char* health_names[] = {"healthy", "suspect", "dead"};
+
+    for(int i = 0; i < PCA9955B_NUM; i++) {
+        const pca9955b_dev_t* dev = pca9955b_devs[i];
+        if(dev == NULL) {
+            continue;
+        }
+        ESP_LOGI(TAG,
+                 "PCA9955B[%d] 0x%02x %s: %lu ok, %lu failed, %lu skipped, %lu recovered",
+                 i,
+                 dev->i2c_addr,
+                 health_names[dev->health],
+                 (unsigned long)dev->health_stats.ok,
+                 (unsigned long)dev->health_stats.failed,
+                 (unsigned long)dev->health_stats.skipped,
+                 (unsigned long)dev->health_stats.recovered);
+    }
+    for(int b = 0; b < I2C_BUS_NUM; b++) {
+        ESP_LOGI(TAG, "I2C bus %d: %lu recoveries, last took %lu us", b, (unsigned long)i2c_recoveries[b], (unsigned long)i2c_recovery_us[b]);
+    }
+}
+
+void LedController::reset_pca_health() {
+    for(int i = 0; i < PCA9955B_NUM; i++) {
+        if(pca9955b_devs[i]) {
+            memset(&pca9955b_devs[i]->health_stats, 0, sizeof(pca9955b_health_stats_t));
+        }
+    }
+    memset(i2c_recoveries, 0, sizeof(i2c_recoveries));
+}
+
 void LedController::print_buffer() {
     for(int i = 0; i < WS2812B_NUM; i++) {
         ws2812b_print_buffer(ws2812b_devs[i]);
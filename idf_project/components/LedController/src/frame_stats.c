@@ -0,0 +1,244 @@
+#include "frame_stats.h"
+
+#include "stdio.h"
+#include "string.h"
+
+#include "esp_check.h"
+#include "esp_log.h"
+
+/*
+ * Log-linear histogram: values below 16 (us, or counts) get their own bucket, larger
+ * values are split into 8 sub-buckets per power of two (12.5% resolution) up to 2^24.
+ */
+#define STATS_LINEAR_NUM 16
+#define STATS_SUB_BITS 3
+#define STATS_SUB_NUM (1 << STATS_SUB_BITS)
+#define STATS_MSB_MIN 4
+#define STATS_MSB_MAX 23
+#define STATS_BUCKET_NUM (STATS_LINEAR_NUM + (STATS_MSB_MAX - STATS_MSB_MIN + 1) * STATS_SUB_NUM)
+
+typedef struct {
+    uint32_t buckets[STATS_BUCKET_NUM];
+    uint32_t count;
+    uint64_t sum;
+    uint32_t min;
+    uint32_t max;
+    uint32_t overruns;
+    uint32_t reset_gen; /*!< Last reset request applied by the writer */
+} stage_hist_t;
+
+static const char* TAG = "FrameStats";
+
+static const char* STAGE_NAMES[FRAME_STAGE_NUM] = {"jitter", "compute", "output", "rmt_wait", "rmt_kick", "rmt_skew", "i2c"};
+static const char* COUNTER_NAMES[FRAME_COUNTER_NUM] = {"rmt_irq", "current", "limited"};
+static const char* COUNTER_UNITS[FRAME_COUNTER_NUM] = {"per frame", "mA", "mA"};
+
+static stage_hist_t hists[FRAME_STAGE_NUM];
+static stage_hist_t counters[FRAME_COUNTER_NUM];
+static volatile uint32_t budget_us = 0;
+static volatile uint32_t counter_limits[FRAME_COUNTER_NUM];
+static volatile uint32_t i2c_hz[FRAME_STATS_I2C_BUS_NUM];
+static volatile uint32_t reset_gen = 0;
+
+static inline int bucket_index(uint32_t value) {
+    if(value < STATS_LINEAR_NUM) {
+        return value;
+    }
+
+    int msb = 31 - __builtin_clz(value);
+    if(msb > STATS_MSB_MAX) {
+        return STATS_BUCKET_NUM - 1;
+    }
+
+    int sub = (value >> (msb - STATS_SUB_BITS)) & (STATS_SUB_NUM - 1);
+    return STATS_LINEAR_NUM + (msb - STATS_MSB_MIN) * STATS_SUB_NUM + sub;
+}
+
+static uint32_t bucket_upper_bound(int idx) {
+    if(idx < STATS_LINEAR_NUM) {
+        return idx;
+    }
+
+    int msb = STATS_MSB_MIN + (idx - STATS_LINEAR_NUM) / STATS_SUB_NUM;
+    int sub = (idx - STATS_LINEAR_NUM) % STATS_SUB_NUM;
+    return ((uint32_t)(STATS_SUB_NUM + sub + 1) << (msb - STATS_SUB_BITS)) - 1;
+}
+
+static uint32_t percentile(const uint32_t* buckets, uint32_t count, uint32_t permille) {
+    uint32_t target = (uint32_t)(((uint64_t)count * permille + 999) / 1000);
+    uint32_t seen = 0;
+
+    for(int i = 0; i < STATS_BUCKET_NUM; i++) {
+        seen += buckets[i];
+        if(seen >= target && seen > 0) {
+            return bucket_upper_bound(i);
+        }
+    }
+    return 0;
+}
+
+static void hist_record(stage_hist_t* hist, uint32_t value, uint32_t limit) {
+    // 1. Apply a pending reset (only the writer ever clears its histogram)
+    uint32_t gen = reset_gen;
+    if(hist->reset_gen != gen) {
+        memset(hist, 0, sizeof(stage_hist_t));
+        hist->reset_gen = gen;
+    }
+
+    // 2. Update
+    hist->buckets[bucket_index(value)]++;
+    if(hist->count == 0 || value < hist->min) {
+        hist->min = value;
+    }
+    if(value > hist->max) {
+        hist->max = value;
+    }
+    if(limit && value > limit) {
+        hist->overruns++;
+    }
+    hist->sum += value;
+    hist->count++;
+}
+
+void frame_stats_record_us(frame_stage_t stage, uint32_t duration_us) {
+    if((unsigned)stage >= FRAME_STAGE_NUM) {
+        return;
+    }
+    hist_record(&hists[stage], duration_us, budget_us);
+}
+
+void frame_stats_count(frame_counter_t counter, uint32_t value) {
+    if((unsigned)counter >= FRAME_COUNTER_NUM) {
+        return;
+    }
+    hist_record(&counters[counter], value, counter_limits[counter]);
+}
+
+void frame_stats_record(frame_stage_t stage, int64_t start_us) {
+    frame_stats_record_us(stage, (uint32_t)(esp_timer_get_time() - start_us));
+}
+
+void frame_stats_set_budget_us(uint32_t _budget_us) {
+    budget_us = _budget_us;
+}
+
+void frame_stats_set_counter_limit(frame_counter_t counter, uint32_t limit) {
+    if((unsigned)counter >= FRAME_COUNTER_NUM) {
+        return;
+    }
+    counter_limits[counter] = limit;
+}
+
+void frame_stats_set_i2c_hz(int bus, uint32_t hz) {
+    if((unsigned)bus >= FRAME_STATS_I2C_BUS_NUM) {
+        return;
+    }
+    i2c_hz[bus] = hz;
+}
+
+void frame_stats_reset(void) {
+    reset_gen++;
+}
+
+static void hist_summary(const stage_hist_t* hist, frame_counter_summary_t* summary) {
+    static uint32_t buckets[STATS_BUCKET_NUM];  // Kept off the console task stack
+
+    memset(summary, 0, sizeof(frame_counter_summary_t));
+    if(hist->reset_gen != reset_gen) {
+        return;  // Reset requested, nothing recorded since
+    }
+
+    // 1. Snapshot the buckets; count is derived from them so percentiles stay consistent
+    uint32_t count = 0;
+    for(int i = 0; i < STATS_BUCKET_NUM; i++) {
+        buckets[i] = hist->buckets[i];
+        count += buckets[i];
+    }
+
+    summary->count = count;
+    summary->min = hist->min;
+    summary->max = hist->max;
+    summary->overruns = hist->overruns;
+    summary->p50 = percentile(buckets, count, 500);
+    summary->p99 = percentile(buckets, count, 990);
+    summary->total = hist->sum;
+    summary->avg = hist->count ? (uint32_t)(hist->sum / hist->count) : 0;
+
+    // Bucket bounds can overshoot the largest sample
+    if(summary->p50 > summary->max) {
+        summary->p50 = summary->max;
+    }
+    if(summary->p99 > summary->max) {
+        summary->p99 = summary->max;
+    }
+}
+
+esp_err_t frame_stats_get(frame_stage_t stage, frame_stage_summary_t* summary) {
+    ESP_RETURN_ON_FALSE((unsigned)stage < FRAME_STAGE_NUM, ESP_ERR_INVALID_ARG, TAG, "Stage %d out of range", stage);
+    ESP_RETURN_ON_FALSE(summary, ESP_ERR_INVALID_ARG, TAG, "Summary is NULL");
+
+    frame_counter_summary_t values;
+    hist_summary(&hists[stage], &values);
+    summary->count = values.count;
+    summary->min_us = values.min;
+    summary->max_us = values.max;
+    summary->p50_us = values.p50;
+    summary->p99_us = values.p99;
+    summary->avg_us = values.avg;
+    summary->overruns = values.overruns;
+    return ESP_OK;
+}
+
+esp_err_t frame_stats_get_counter(frame_counter_t counter, frame_counter_summary_t* summary) {
+    ESP_RETURN_ON_FALSE((unsigned)counter < FRAME_COUNTER_NUM, ESP_ERR_INVALID_ARG, TAG, "Counter %d out of range", counter);
+    ESP_RETURN_ON_FALSE(summary, ESP_ERR_INVALID_ARG, TAG, "Summary is NULL");
+
+    hist_summary(&counters[counter], summary);
+    return ESP_OK;
+}
+
+void frame_stats_print(void) {
+    frame_stage_summary_t summary;
+    frame_counter_summary_t counter;
+
+    ESP_LOGI(TAG,
+             "frame budget %lu us, I2C clock %lu / %lu kHz",
+             (unsigned long)budget_us,
+             (unsigned long)(i2c_hz[0] / 1000),
+             (unsigned long)(i2c_hz[1] / 1000));
+    for(int i = 0; i < FRAME_STAGE_NUM; i++) {
+        if(frame_stats_get((frame_stage_t)i, &summary) != ESP_OK) {
+            continue;
+        }
+        ESP_LOGI(TAG,
+                 "%-8s n=%-7lu min %5lu  p50 %5lu  p99 %5lu  max %5lu us, %lu overruns",
+                 STAGE_NAMES[i],
+                 (unsigned long)summary.count,
+                 (unsigned long)summary.min_us,
+                 (unsigned long)summary.p50_us,
+                 (unsigned long)summary.p99_us,
+                 (unsigned long)summary.max_us,
+                 (unsigned long)summary.overruns);
+    }
+
+    for(int i = 0; i < FRAME_COUNTER_NUM; i++) {
+        if(frame_stats_get_counter((frame_counter_t)i, &counter) != ESP_OK) {
+            continue;
+        }
+        char over[40] = "";
+        if(counter_limits[i]) {
+            snprintf(over, sizeof(over), ", %lu over %lu", (unsigned long)counter.overruns, (unsigned long)counter_limits[i]);
+        }
+        ESP_LOGI(TAG,
+                 "%-8s n=%-7lu min %5lu  p50 %5lu  p99 %5lu  max %5lu  avg %5lu %s%s",
+                 COUNTER_NAMES[i],
+                 (unsigned long)counter.count,
+                 (unsigned long)counter.min,
+                 (unsigned long)counter.p50,
+                 (unsigned long)counter.p99,
+                 (unsigned long)counter.max,
+                 (unsigned long)counter.avg,
+                 COUNTER_UNITS[i],
+                 over);
+    }
+}
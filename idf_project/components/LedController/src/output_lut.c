@@ -0,0 +1,163 @@
+#include "output_lut.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "esp_log.h"
+
+#include "BoardConfig.h"
+
+static const char* TAG = "OutputLut";
+
+static const float GAMMAS[OUTPUT_LUT_NUM] = {OUTPUT_GAMMA_WS2812B, OUTPUT_GAMMA_PCA9955B};
+
+static uint16_t curves[OUTPUT_LUT_NUM][256];   /*!< Gamma curves at full brightness, 8.8 fixed point */
+static uint16_t tables16[OUTPUT_LUT_NUM][256]; /*!< Curves at the current brightness, 8.8 fixed point */
+static uint8_t tables[OUTPUT_LUT_NUM][256];    /*!< Integer part of tables16 */
+static volatile bool identity[OUTPUT_LUT_NUM];
+static volatile uint32_t version = 0;
+static bool initialized = false;
+static bool gamma_enabled = OUTPUT_GAMMA;
+static uint8_t brightness = OUTPUT_DEFAULT_BRIGHTNESS;
+
+static void output_lut_build(void) {
+    for(int t = 0; t < OUTPUT_LUT_NUM; t++) {
+        bool same = true;
+
+        // Linear levels scale exactly: (i * 256 * 256) >> 8 == i * 256
+        for(int i = 0; i < 256; i++) {
+            uint32_t level = gamma_enabled ? curves[t][i] : i * 256;
+            uint16_t value = (uint16_t)((level * (brightness + 1)) >> 8);
+            same &= value == i * 256;
+            tables16[t][i] = value;
+            tables[t][i] = (uint8_t)(value >> 8);
+        }
+        identity[t] = same;
+    }
+    version++;
+}
+
+void output_lut_init(void) {
+    if(initialized) {
+        return;
+    }
+
+    // Float only here, once per boot
+    for(int t = 0; t < OUTPUT_LUT_NUM; t++) {
+        for(int i = 0; i < 256; i++) {
+            curves[t][i] = (uint16_t)lroundf(powf(i / 255.0f, GAMMAS[t]) * 255.0f * 256.0f);
+        }
+    }
+    output_lut_build();
+    initialized = true;
+
+    ESP_LOGI(TAG, "Gamma %s (WS2812B %.1f, PCA9955B %.1f), brightness %d", gamma_enabled ? "on" : "off", GAMMAS[0], GAMMAS[1], brightness);
+}
+
+void output_lut_set_brightness(uint8_t value) {
+    brightness = value;
+    if(initialized) {
+        output_lut_build();
+    }
+}
+
+uint8_t output_lut_get_brightness(void) {
+    return brightness;
+}
+
+void output_lut_set_gamma(bool enable) {
+    gamma_enabled = enable;
+    if(initialized) {
+        output_lut_build();
+    }
+}
+
+bool output_lut_get_gamma(void) {
+    return gamma_enabled;
+}
+
+uint32_t output_lut_get_version(void) {
+    return version;
+}
+
+const uint8_t* output_lut_get(output_lut_type_t type) {
+    if(!initialized) {
+        output_lut_init();
+    }
+    return tables[type];
+}
+
+const uint16_t* output_lut_get16(output_lut_type_t type) {
+    if(!initialized) {
+        output_lut_init();
+    }
+    return tables16[type];
+}
+
+void output_lut_copy(output_lut_type_t type, uint8_t* dst, const uint8_t* src, size_t len) {
+    const uint8_t* lut = output_lut_get(type);
+
+    if(identity[type]) {
+        memcpy(dst, src, len);
+        return;
+    }
+
+    // 1. Bytes up to the first aligned destination word
+    while(len > 0 && ((uintptr_t)dst & 3)) {
+        *dst++ = lut[*src++];
+        len--;
+    }
+
+    // 2. Whole words, little-endian; the source is read as a word too when it shares the alignment
+    if(((uintptr_t)src & 3) == 0) {
+        for(; len >= 4; len -= 4, src += 4, dst += 4) {
+            uint32_t in;
+            memcpy(&in, __builtin_assume_aligned(src, 4), 4);
+            uint32_t out = lut[in & 0xFF] | lut[(in >> 8) & 0xFF] << 8 | lut[(in >> 16) & 0xFF] << 16 | (uint32_t)lut[in >> 24] << 24;
+            memcpy(__builtin_assume_aligned(dst, 4), &out, 4);
+        }
+    } else {
+        for(; len >= 4; len -= 4, src += 4, dst += 4) {
+            uint32_t out = lut[src[0]] | lut[src[1]] << 8 | lut[src[2]] << 16 | (uint32_t)lut[src[3]] << 24;
+            memcpy(__builtin_assume_aligned(dst, 4), &out, 4);
+        }
+    }
+
+    // 3. Tail
+    while(len > 0) {
+        *dst++ = lut[*src++];
+        len--;
+    }
+}
+
+void output_lut_copy_scaled(output_lut_type_t type, uint8_t* dst, const uint8_t* src, size_t len, uint16_t scale) {
+    if(scale >= OUTPUT_LUT_SCALE_NONE) {
+        output_lut_copy(type, dst, src, len);
+        return;
+    }
+
+    const uint8_t* lut = output_lut_get(type);
+    for(size_t i = 0; i < len; i++) {
+        dst[i] = (uint8_t)((lut[src[i]] * scale) >> 8);
+    }
+}
+
+size_t output_lut_dither(output_lut_type_t type, const uint8_t* src, uint16_t scale, uint8_t* error, uint8_t* dst, size_t len) {
+    const uint16_t* lut = output_lut_get16(type);
+    size_t last = 0;
+
+    // Levels never exceed 255.0, so the carry cannot overflow a byte
+    for(size_t i = 0; i < len; i++) {
+        uint32_t level = lut[src[i]];
+        uint32_t frac = level & 0xFF;
+        uint32_t acc = frac + error[i];
+        uint32_t value = (level >> 8) + (acc >> 8);
+        dst[i] = (uint8_t)(scale >= OUTPUT_LUT_SCALE_NONE ? value : (value * scale) >> 8);
+        error[i] = (uint8_t)acc;
+        if(frac) {
+            last = i + 1;
+        }
+    }
+
+    return last;
+}
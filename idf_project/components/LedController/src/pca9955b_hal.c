@@ -2,19 +2,194 @@
 
 #include "string.h"
 
+#include "driver/gpio.h"
 #include "esp_check.h"
 #include "esp_log.h"
+#include "esp_rom_sys.h"
 #include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
+#include "output_lut.h"
+
 #define PCA9955B_PWM0_ADDR 0x08  // Address of PWM0 register
 #define PCA9955B_AUTO_INC 0x80   // Auto-Increment for all registers
 #define PCA9955B_IREFALL_ADDR 0x45
+#define PCA9955B_GRPFREQ_ADDR 0x07  // Group blink period, unused while MODE2 DMBLNK = 0
+#define I2C_CLEAR_HALF_PERIOD_US 5  // 100 kHz while clocking a stuck bus free by hand
 
 static const char* TAG = "PCA9955B";
 
-esp_err_t pca9955b_init(uint8_t i2c_addr, i2c_master_bus_handle_t i2c_bus_handle, pca9955b_handle_t* pca9955b) {
+/**
+ * @brief Copies `size` colour values into the shadow buffer, marking the channels that change.
+ */
+static void pca9955b_update(pca9955b_dev_t* dev, int first, const uint8_t* data, int size) {
+    const uint8_t* lut = output_lut_get(OUTPUT_LUT_PCA9955B);
+
+    for(int i = 0; i < size; i++) {
+        uint8_t value = data[i];
+        if(dev->buffer.data[first + i] != value) {
+            dev->level_sum += lut[value] - lut[dev->buffer.data[first + i]];
+            dev->buffer.data[first + i] = value;
+            dev->dirty_mask |= 1 << (first + i);
+        }
+    }
+}
+
+/**
+ * @brief Packs the dirty PWM span into `tx_buffer` through the gamma / brightness
+ *        table and the current limiter, and clears the dirty mask.
+ *
+ * One burst from the first to the last dirty channel: the clean channels in
+ * between cost a byte each, less than the start, address and command bytes of
+ * a second transaction.
+ *
+ * @return Bytes to transmit from `tx_buffer`, command byte included.
+ */
+static size_t pca9955b_pack(pca9955b_dev_t* dev) {
+    int first = __builtin_ctz(dev->dirty_mask);
+    int last = 31 - __builtin_clz(dev->dirty_mask);
+
+    dev->tx_buffer.command_byte = (PCA9955B_PWM0_ADDR + first) | PCA9955B_AUTO_INC;
+    output_lut_copy_scaled(OUTPUT_LUT_PCA9955B, dev->tx_buffer.data, dev->buffer.data + first, last - first + 1, dev->scale);
+    dev->dirty_mask = 0;
+
+    return 1 + last - first + 1;
+}
+
+/**
+ * @brief Updates the link state with the result of a transfer.
+ *
+ * Only a write that leaves the chip up to date proves it healthy: a chip that
+ * takes the short IREF command but fails every burst keeps backing off.
+ */
+static void pca9955b_record(pca9955b_dev_t* dev, esp_err_t result) {
+    // 1. Success
+    if(result == ESP_OK) {
+        dev->health_stats.ok++;
+        if(dev->health != PCA9955B_HEALTHY) {
+            dev->health_stats.recovered++;
+            ESP_LOGI(TAG, "PCA9955B 0x%02x recovered after %d failures", dev->i2c_addr, dev->fail_streak);
+        }
+        dev->health = PCA9955B_HEALTHY;
+        dev->fail_streak = 0;
+        return;
+    }
+
+    // 2. Failure: retry on the next frame once, then after MIN, 2 * MIN, ... MAX
+    dev->health_stats.failed++;
+    if(dev->fail_streak < UINT8_MAX) {
+        dev->fail_streak++;
+    }
+    uint32_t backoff_ms = 0;
+    if(dev->fail_streak > 1) {
+        int shift = dev->fail_streak - 2;
+        backoff_ms = shift < 16 ? (uint32_t)PCA9955B_RETRY_MIN_MS << shift : PCA9955B_RETRY_MAX_MS;
+        backoff_ms = backoff_ms < PCA9955B_RETRY_MAX_MS ? backoff_ms : PCA9955B_RETRY_MAX_MS;
+    }
+    dev->retry_us = esp_timer_get_time() + (int64_t)backoff_ms * 1000;
+
+    // 3. Log state changes only, a dead chip would flood the console otherwise
+    pca9955b_health_t health = dev->fail_streak >= PCA9955B_DEAD_FAILS ? PCA9955B_DEAD : PCA9955B_SUSPECT;
+    if(health != dev->health) {
+        ESP_LOGW(TAG, "PCA9955B 0x%02x %s: %s", dev->i2c_addr, health == PCA9955B_DEAD ? "dead" : "suspect", esp_err_to_name(result));
+    }
+    dev->health = health;
+}
+
+/**
+ * @brief True while an unhealthy chip waits out its backoff; counts the skipped frame.
+ */
+static bool pca9955b_backing_off(pca9955b_dev_t* dev) {
+    if(dev->health == PCA9955B_HEALTHY || esp_timer_get_time() >= dev->retry_us) {
+        return false;
+    }
+    dev->health_stats.skipped++;
+    return true;
+}
+
+#if PCA9955B_ASYNC
+/**
+ * @brief I2C completion callback (ISR context).
+ *
+ * Only one transfer per device is ever queued, so every completion ends it.
+ */
+static bool IRAM_ATTR pca9955b_on_trans_done(i2c_master_dev_handle_t i2c_dev, const i2c_master_event_data_t* evt_data, void* arg) {
+    pca9955b_dev_t* dev = (pca9955b_dev_t*)arg;
+    BaseType_t high_task_wakeup = pdFALSE;
+
+    if(evt_data->event != I2C_EVENT_DONE) {
+        dev->tx_error = true;
+    }
+    dev->done_us = esp_timer_get_time();
+    dev->in_flight = false;
+
+    if(dev->done_group) {
+        xEventGroupSetBitsFromISR(dev->done_group, dev->done_bit, &high_task_wakeup);
+    }
+    return high_task_wakeup == pdTRUE;
+}
+#endif
+
+/**
+ * @brief Blocking transmit that works in both sync and async bus modes.
+ *
+ * `data` must stay valid until the call returns.
+ */
+static esp_err_t pca9955b_transmit_blocking(pca9955b_dev_t* dev, const uint8_t* data, size_t size) {
+#if PCA9955B_ASYNC
+    esp_err_t ret = ESP_OK;
+
+    dev->tx_error = false;
+    dev->in_flight = true;
+    dev->done_group = NULL;
+
+    ret = i2c_master_transmit(dev->i2c_dev_handle, data, size, I2C_TIMEOUT_MS);
+    if(ret == ESP_OK) {
+        ret = i2c_master_bus_wait_all_done(dev->i2c_bus_handle, I2C_TIMEOUT_MS);
+    }
+    if(ret == ESP_OK && dev->tx_error) {
+        ret = ESP_FAIL;
+    }
+    dev->in_flight = false;
+    return ret;
+#else
+    return i2c_master_transmit(dev->i2c_dev_handle, data, size, I2C_TIMEOUT_MS);
+#endif
+}
+
+/**
+ * @brief Adds the device to `i2c_bus_handle` at its address and clock, with the completion callback.
+ */
+static esp_err_t pca9955b_add_device(pca9955b_dev_t* dev, i2c_master_bus_handle_t i2c_bus_handle) {
+    esp_err_t ret = ESP_OK;
+
+    i2c_device_config_t i2c_dev_config = {
+        .dev_addr_length = I2C_ADDR_BIT_LEN_7, /*!< 7-bit address mode */
+        .device_address = dev->i2c_addr,       /*!< Target device address */
+        .scl_speed_hz = dev->scl_speed_hz,     /*!< Bus clock frequency */
+        .flags.disable_ack_check = false,      // We want to ensure device is connected (ALLCALL: every chip acknowledges)
+    };
+    ESP_RETURN_ON_ERROR(i2c_master_bus_add_device(i2c_bus_handle, &i2c_dev_config, &dev->i2c_dev_handle), TAG, "Failed to add I2C device");
+
+#if PCA9955B_ASYNC
+    i2c_master_event_callbacks_t cbs = {
+        .on_trans_done = pca9955b_on_trans_done,
+    };
+    ret = i2c_master_register_event_callbacks(dev->i2c_dev_handle, &cbs, dev);
+    if(ret != ESP_OK) {
+        i2c_master_bus_rm_device(dev->i2c_dev_handle);
+        dev->i2c_dev_handle = NULL;
+        ESP_LOGE(TAG, "Failed to register I2C callback: %s", esp_err_to_name(ret));
+        return ret;
+    }
+#endif
+
+    dev->i2c_bus_handle = i2c_bus_handle;
+    return ret;
+}
+
+esp_err_t pca9955b_init(uint8_t i2c_addr, i2c_master_bus_handle_t i2c_bus_handle, uint32_t scl_speed_hz, pca9955b_handle_t* pca9955b) {
     esp_err_t ret = ESP_OK;
     pca9955b_dev_t* dev = NULL;
 
@@ -28,7 +203,7 @@ esp_err_t pca9955b_init(uint8_t i2c_addr, i2c_master_bus_handle_t i2c_bus_handle
     ESP_RETURN_ON_FALSE(dev, ESP_ERR_NO_MEM, TAG, "Failed to allocate memory for PCA9955B context");
 
     dev->i2c_addr = i2c_addr;
-    dev->need_update = true;
+    dev->scl_speed_hz = scl_speed_hz;
 
     dev->need_reset_IREF = true;
     dev->IREF_cmd[0] = PCA9955B_IREFALL_ADDR;
@@ -36,28 +211,16 @@ esp_err_t pca9955b_init(uint8_t i2c_addr, i2c_master_bus_handle_t i2c_bus_handle
 
     dev->buffer.command_byte = PCA9955B_PWM0_ADDR | PCA9955B_AUTO_INC;
     memset(dev->buffer.data, 0, sizeof(dev->buffer.data));
+    dev->scale = OUTPUT_LUT_SCALE_NONE;
 
-    i2c_device_config_t i2c_dev_config = {
-        .dev_addr_length = I2C_ADDR_BIT_LEN_7, /*!< 7-bit address mode */
-        .device_address = i2c_addr,            /*!< Target device address */
-        .scl_speed_hz = I2C_FREQ,              /*!< Bus clock frequency */
-        .flags.disable_ack_check = false,      // We want to ensure device is connected
-    };
-
-    ESP_GOTO_ON_ERROR(i2c_master_bus_add_device(i2c_bus_handle, &i2c_dev_config, &dev->i2c_dev_handle), err, TAG, "Failed to add I2C device");
+    ESP_GOTO_ON_ERROR(pca9955b_add_device(dev, i2c_bus_handle), err, TAG, "Failed to attach PCA9955B 0x%02x", i2c_addr);
 
     // 1. Set IREF (Current Gain)
-    uint8_t iref_cmd[2] = {PCA9955B_IREFALL_ADDR, 0xFF};
-    ESP_GOTO_ON_ERROR(
-        i2c_master_transmit(dev->i2c_dev_handle, iref_cmd, sizeof(iref_cmd), I2C_TIMEOUT_MS), err_dev, TAG, "Failed to set default IREF");
+    ESP_GOTO_ON_ERROR(pca9955b_transmit_blocking(dev, dev->IREF_cmd, sizeof(dev->IREF_cmd)), err_dev, TAG, "Failed to set default IREF");
     dev->need_reset_IREF = false;
 
     // 2. Clear LEDs (Set Black)
-    ESP_GOTO_ON_ERROR(i2c_master_transmit(dev->i2c_dev_handle, (uint8_t*)&dev->buffer, sizeof(pca9955b_buffer_t), I2C_TIMEOUT_MS),
-                      err_dev,
-                      TAG,
-                      "Failed to clear LEDs (Black)");
-    dev->need_update = false;
+    ESP_GOTO_ON_ERROR(pca9955b_transmit_blocking(dev, (uint8_t*)&dev->buffer, sizeof(pca9955b_buffer_t)), err_dev, TAG, "Failed to clear LEDs (Black)");
 
     ESP_LOGI(TAG, "Device initialized at address 0x%02x", i2c_addr);
     *pca9955b = dev;
@@ -72,20 +235,127 @@ err:
     return ret;
 }
 
+esp_err_t pca9955b_init_allcall(i2c_master_bus_handle_t i2c_bus_handle, uint32_t scl_speed_hz, pca9955b_handle_t* allcall) {
+    esp_err_t ret = ESP_OK;
+    pca9955b_dev_t* dev = NULL;
+
+    // 1. Input Validation
+    ESP_RETURN_ON_FALSE(i2c_bus_handle && allcall, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    *allcall = NULL;
+
+    dev = (pca9955b_dev_t*)calloc(1, sizeof(pca9955b_dev_t));
+    ESP_RETURN_ON_FALSE(dev, ESP_ERR_NO_MEM, TAG, "Failed to allocate memory for PCA9955B ALLCALL context");
+
+    dev->i2c_addr = PCA9955B_ALLCALL_ADDR;
+    dev->scl_speed_hz = scl_speed_hz;
+    dev->IREF_cmd[0] = PCA9955B_IREFALL_ADDR;
+    dev->IREF_cmd[1] = 0xFF;
+    dev->buffer.command_byte = PCA9955B_PWM0_ADDR | PCA9955B_AUTO_INC;
+    dev->scale = OUTPUT_LUT_SCALE_NONE;
+
+    // 2. Every chip acknowledges, so ACK checking works as for a single chip
+    ESP_GOTO_ON_ERROR(pca9955b_add_device(dev, i2c_bus_handle), err, TAG, "Failed to add ALLCALL device");
+
+    *allcall = dev;
+    return ESP_OK;
+
+err:
+    free(dev);
+    return ret;
+}
+
+/**
+ * @brief Checks that no chip of a broadcast has an async transfer that could land after it.
+ *
+ * Unhealthy chips are not waited for: broadcasts leave them fully dirty.
+ */
+static esp_err_t pca9955b_check_idle(pca9955b_handle_t allcall, pca9955b_handle_t* devs, int dev_num) {
+    ESP_RETURN_ON_FALSE(allcall && devs && dev_num >= 0, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE(!allcall->in_flight, ESP_ERR_INVALID_STATE, TAG, "Async transfer still pending");
+    for(int i = 0; i < dev_num; i++) {
+        ESP_RETURN_ON_FALSE(devs[i] == NULL || devs[i]->health != PCA9955B_HEALTHY || !devs[i]->in_flight,
+                            ESP_ERR_INVALID_STATE,
+                            TAG,
+                            "Async transfer to 0x%02x still pending",
+                            devs[i]->i2c_addr);
+    }
+    return ESP_OK;
+}
+
+esp_err_t pca9955b_broadcast_write(pca9955b_handle_t allcall, pca9955b_handle_t* devs, int dev_num) {
+    esp_err_t ret = ESP_OK;
+
+    // 1. Validation
+    ESP_RETURN_ON_ERROR(pca9955b_check_idle(allcall, devs, dev_num), TAG, "Broadcast not possible");
+
+    // 2. One full burst reaches every chip
+    allcall->dirty_mask = PCA9955B_DIRTY_ALL;
+    ret = pca9955b_transmit_blocking(allcall, (uint8_t*)&allcall->tx_buffer, pca9955b_pack(allcall));
+    if(ret != ESP_OK) {
+        ESP_LOGE(TAG, "ALLCALL transmit failed: %s", esp_err_to_name(ret));
+        return ESP_FAIL;
+    }
+
+    // 3. The chips now show the broadcast colours: only channels written since differ
+    for(int i = 0; i < dev_num; i++) {
+        if(devs[i] == NULL || devs[i]->i2c_bus_handle != allcall->i2c_bus_handle) {
+            continue;
+        }
+        // A failing chip may have missed it, it gets everything once it answers again
+        // So does a chip limited by another factor: the same colour came out differently.
+        if(devs[i]->health != PCA9955B_HEALTHY || devs[i]->scale != allcall->scale) {
+            devs[i]->dirty_mask = PCA9955B_DIRTY_ALL;
+            continue;
+        }
+        for(int ch = 0; ch < 15; ch++) {
+            if(devs[i]->buffer.data[ch] == allcall->buffer.data[ch]) {
+                devs[i]->dirty_mask &= ~(1 << ch);
+            } else {
+                devs[i]->dirty_mask |= 1 << ch;
+            }
+        }
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t pca9955b_broadcast_brightness(pca9955b_handle_t allcall, pca9955b_handle_t* devs, int dev_num, uint8_t brightness) {
+    // 1. Validation
+    ESP_RETURN_ON_ERROR(pca9955b_check_idle(allcall, devs, dev_num), TAG, "Broadcast not possible");
+
+    // 2. Every chip keeps the level for its own IREF restoration
+    allcall->IREF_cmd[1] = brightness;
+    for(int i = 0; i < dev_num; i++) {
+        if(devs[i] && devs[i]->i2c_bus_handle == allcall->i2c_bus_handle) {
+            devs[i]->IREF_cmd[1] = brightness;
+            devs[i]->need_reset_IREF |= devs[i]->health != PCA9955B_HEALTHY;  // May miss the broadcast
+        }
+    }
+
+    // 3. One 2-byte write dims every chip
+    esp_err_t ret = pca9955b_transmit_blocking(allcall, allcall->IREF_cmd, sizeof(allcall->IREF_cmd));
+    if(ret != ESP_OK) {
+        for(int i = 0; i < dev_num; i++) {
+            if(devs[i] && devs[i]->i2c_bus_handle == allcall->i2c_bus_handle) {
+                devs[i]->need_reset_IREF = true;
+            }
+        }
+        ESP_LOGE(TAG, "ALLCALL brightness failed: %s", esp_err_to_name(ret));
+        return ESP_FAIL;
+    }
+
+    return ESP_OK;
+}
+
 esp_err_t pca9955b_set_pixel(pca9955b_handle_t pca9955b, uint8_t pixel_idx, uint8_t red, uint8_t green, uint8_t blue) {
     // 1. Validate Input
     ESP_RETURN_ON_FALSE(pca9955b, ESP_ERR_INVALID_ARG, TAG, "Handle is NULL");
     ESP_RETURN_ON_FALSE(pixel_idx < 5, ESP_ERR_INVALID_ARG, TAG, "Pixel index out of range (0-4)");
 
-    // 2. Write to Shadow Buffer
+    // 2. Write to Shadow Buffer, marking the channels that change
     // Assuming RGB order. Adjust indices if your hardware is GRB.
-    pca9955b->buffer.ch[pixel_idx][0] = red;   /*!< Red channel */
-    pca9955b->buffer.ch[pixel_idx][1] = green; /*!< Green channel */
-    pca9955b->buffer.ch[pixel_idx][2] = blue;  /*!< Blue channel */
-
-    // 3. Set Dirty Flag
-    // This tells the flush function that there is new data to send.
-    pca9955b->need_update = true;
+    const uint8_t rgb[3] = {red, green, blue};
+    pca9955b_update(pca9955b, pixel_idx * 3, rgb, 3);
 
     return ESP_OK;
 }
@@ -96,11 +366,8 @@ esp_err_t pca9955b_write(pca9955b_handle_t pca9955b, const uint8_t* _buffer) {
     ESP_RETURN_ON_FALSE(_buffer, ESP_ERR_INVALID_ARG, TAG, "Input buffer is NULL");
 
     // 2. Bulk Copy Logic
-    // Copy 15 bytes (5 RGB LEDs x 3 colors) directly into the shadow buffer
-    memcpy(pca9955b->buffer.data, _buffer, 15 * sizeof(uint8_t));
-
-    // 3. Mark as Dirty
-    pca9955b->need_update = true;
+    // Copy 15 bytes (5 RGB LEDs x 3 colors) into the shadow buffer, marking the channels that change
+    pca9955b_update(pca9955b, 0, _buffer, 15);
 
     return ESP_OK;
 }
@@ -110,16 +377,22 @@ esp_err_t pca9955b_show(pca9955b_handle_t pca9955b) {
 
     // 1. Input Validation
     ESP_RETURN_ON_FALSE(pca9955b, ESP_ERR_INVALID_ARG, TAG, "Handle is NULL");
+    ESP_RETURN_ON_FALSE(!pca9955b->in_flight, ESP_ERR_INVALID_STATE, TAG, "Async transfer still pending");
 
     // 2. Optimization: Skip if nothing changed AND hardware is healthy
     // If we don't need to update colors AND we don't need to restore IREF, return immediately.
-    if(!pca9955b->need_update && !pca9955b->need_reset_IREF) {
+    if(pca9955b->dirty_mask == 0 && !pca9955b->need_reset_IREF) {
+        return ESP_OK;
+    }
+
+    // A failing chip is left alone until its backoff has elapsed
+    if(pca9955b_backing_off(pca9955b)) {
         return ESP_OK;
     }
 
     // 3. IREF Restoration Logic (Recover from previous failure)
     if(pca9955b->need_reset_IREF) {
-        ret = i2c_master_transmit(pca9955b->i2c_dev_handle, pca9955b->IREF_cmd, 2, I2C_TIMEOUT_MS);
+        ret = pca9955b_transmit_blocking(pca9955b, pca9955b->IREF_cmd, 2);
 
         if(ret == ESP_OK) {
             pca9955b->need_reset_IREF = false; /*!< IREF reset completed */
@@ -127,28 +400,135 @@ esp_err_t pca9955b_show(pca9955b_handle_t pca9955b) {
         } else {
             // If IREF fails, we can't show colors properly anyway.
             ESP_LOGW(TAG, "Failed to restore IREF: %s", esp_err_to_name(ret));
+            pca9955b_record(pca9955b, ret);
             return ret;
         }
     }
 
+    // IREF was the only thing pending
+    if(pca9955b->dirty_mask == 0) {
+        pca9955b_record(pca9955b, ESP_OK);
+        return ESP_OK;
+    }
+
     // 4. Transmit Buffer (Burst Write)
-    // Send 16 bytes: Command Byte (PWM0 + AI) + 15 Color Bytes
-    ret = i2c_master_transmit(pca9955b->i2c_dev_handle,
-                              (uint8_t*)&pca9955b->buffer,
-                              sizeof(pca9955b_buffer_t),  // Safer than hardcoding '16'
-                              I2C_TIMEOUT_MS);
+    // Command Byte (first dirty PWM + AI) + the color bytes up to the last dirty one
+    ret = pca9955b_transmit_blocking(pca9955b, (uint8_t*)&pca9955b->tx_buffer, pca9955b_pack(pca9955b));
+    pca9955b_record(pca9955b, ret);
 
     if(ret != ESP_OK) {
         // 5. Error Handling & Recovery Prep
         // If transmission failed, assume device might have reset or disconnected.
-        // Mark IREF to be re-sent next time we try to show.
+        // Mark IREF and every channel to be re-sent next time we try to show.
         pca9955b->need_reset_IREF = true;
+        pca9955b->dirty_mask = PCA9955B_DIRTY_ALL;
         ESP_LOGE(TAG, "I2C Transmit failed: %s", esp_err_to_name(ret));
         return ret;
     }
 
-    // 6. Success: Clear the dirty flag
-    pca9955b->need_update = false;
+    return ESP_OK;
+}
+
+esp_err_t pca9955b_show_async(pca9955b_handle_t pca9955b, EventGroupHandle_t done_group, EventBits_t done_bit) {
+#if PCA9955B_ASYNC
+    esp_err_t ret = ESP_OK;
+
+    // 1. Input Validation
+    ESP_RETURN_ON_FALSE(pca9955b, ESP_ERR_INVALID_ARG, TAG, "Handle is NULL");
+    ESP_RETURN_ON_FALSE(done_group, ESP_ERR_INVALID_ARG, TAG, "Event group is NULL");
+
+    // 2. A failing chip's transfer still on the bus reports through done_bit itself,
+    // a finished one is collected first (logged and recorded there)
+    if(pca9955b->done_group != NULL) {
+        if(pca9955b->in_flight) {
+            ESP_RETURN_ON_FALSE(pca9955b->health != PCA9955B_HEALTHY, ESP_ERR_INVALID_STATE, TAG, "Previous transfer not collected");
+            return ESP_OK;
+        }
+        pca9955b_finish_async(pca9955b);
+    }
+
+    // 3. Nothing to send, or backing off: report completion right away
+    if((pca9955b->dirty_mask == 0 && !pca9955b->need_reset_IREF) || pca9955b_backing_off(pca9955b)) {
+        xEventGroupSetBits(done_group, done_bit);
+        return ESP_OK;
+    }
+
+    xEventGroupClearBits(done_group, done_bit);
+    pca9955b->done_group = done_group;
+    pca9955b->done_bit = done_bit;
+    pca9955b->tx_error = false;
+    pca9955b->done_us = 0;
+    pca9955b->in_flight = true;
+
+    // 4. Queue one transfer per frame: the IREF restoration takes precedence,
+    // the colors stay dirty and go out with the next call.
+    if(pca9955b->need_reset_IREF) {
+        pca9955b->tx_is_IREF = true;
+        ret = i2c_master_transmit(pca9955b->i2c_dev_handle, pca9955b->IREF_cmd, 2, I2C_TIMEOUT_MS);
+    } else {
+        // Snapshot the dirty span so the caller can keep writing into `buffer`
+        pca9955b->tx_is_IREF = false;
+        ret = i2c_master_transmit(pca9955b->i2c_dev_handle, (uint8_t*)&pca9955b->tx_buffer, pca9955b_pack(pca9955b), I2C_TIMEOUT_MS);
+    }
+
+    // 5. Queueing failed: no callback will come, undo the state
+    if(ret != ESP_OK) {
+        pca9955b->in_flight = false;
+        pca9955b->done_group = NULL;
+        pca9955b->dirty_mask = PCA9955B_DIRTY_ALL;
+        pca9955b->need_reset_IREF = true;
+        pca9955b_record(pca9955b, ret);
+        xEventGroupSetBits(done_group, done_bit);
+        ESP_LOGE(TAG, "I2C queue failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    return ESP_OK;
+#else
+    ESP_RETURN_ON_FALSE(done_group, ESP_ERR_INVALID_ARG, TAG, "Event group is NULL");
+    esp_err_t ret = pca9955b_show(pca9955b);
+    xEventGroupSetBits(done_group, done_bit);
+    return ret;
+#endif
+}
+
+esp_err_t pca9955b_finish_async(pca9955b_handle_t pca9955b) {
+    // 1. Input Validation
+    ESP_RETURN_ON_FALSE(pca9955b, ESP_ERR_INVALID_ARG, TAG, "Handle is NULL");
+
+#if PCA9955B_ASYNC
+    // 2. Nothing was queued since the last collection
+    if(pca9955b->done_group == NULL) {
+        return ESP_OK;
+    }
+    if(pca9955b->in_flight) {
+        // Past the frame deadline: stop waiting for the chip, the transfer is collected once it ends
+        if(pca9955b->health == PCA9955B_HEALTHY) {
+            pca9955b_record(pca9955b, ESP_ERR_TIMEOUT);
+        }
+        return ESP_ERR_TIMEOUT;
+    }
+    pca9955b->done_group = NULL;
+
+    // 3. Failure: resend IREF and colors on the next frame
+    if(pca9955b->tx_error) {
+        pca9955b->tx_error = false;
+        pca9955b->need_reset_IREF = true;
+        pca9955b->dirty_mask = PCA9955B_DIRTY_ALL;
+        pca9955b_record(pca9955b, ESP_FAIL);
+        ESP_LOGE(TAG, "I2C transfer to 0x%02x failed", pca9955b->i2c_addr);
+        return ESP_FAIL;
+    }
+
+    // 4. Success
+    if(pca9955b->tx_is_IREF) {
+        pca9955b->need_reset_IREF = false;
+        ESP_LOGI(TAG, "PCA9955B IREF recovered");
+    }
+    if(!pca9955b->tx_is_IREF || pca9955b->dirty_mask == 0) {
+        pca9955b_record(pca9955b, ESP_OK);
+    }
+#endif
 
     return ESP_OK;
 }
@@ -164,10 +544,19 @@ esp_err_t pca9955b_del(pca9955b_handle_t* pca9955b) {
     pca9955b_dev_t* dev = *pca9955b; /*!< Local device pointer */
     uint8_t i2c_addr = dev->i2c_addr;
 
+#if PCA9955B_ASYNC
+    // 0. Let a pending async transfer finish before touching the buffers
+    if(dev->in_flight) {
+        i2c_master_bus_wait_all_done(dev->i2c_bus_handle, I2C_TIMEOUT_MS);
+    }
+    pca9955b_finish_async(dev);
+#endif
+
     // 1. Turn off all LEDs (Safety feature)
     // Clear the data payload
     memset(dev->buffer.data, 0, sizeof(dev->buffer.data));
-    dev->need_update = true;
+    dev->level_sum = 0;
+    dev->dirty_mask = PCA9955B_DIRTY_ALL;
     pca9955b_show(dev);
 
     // 2. Remove from I2C Bus
@@ -189,24 +578,76 @@ esp_err_t pca9955b_del(pca9955b_handle_t* pca9955b) {
     return ESP_OK;
 }
 
+esp_err_t pca9955b_detach(pca9955b_handle_t pca9955b) {
+    // 1. Input Validation
+    ESP_RETURN_ON_FALSE(pca9955b, ESP_ERR_INVALID_ARG, TAG, "Handle is NULL");
+    if(pca9955b->i2c_dev_handle == NULL) {
+        return ESP_OK;
+    }
+
+    // 2. Drop the transfer in progress, a waiter must not hang on it
+    pca9955b->in_flight = false;
+    pca9955b->tx_error = false;
+    if(pca9955b->done_group) {
+        xEventGroupSetBits(pca9955b->done_group, pca9955b->done_bit);
+        pca9955b->done_group = NULL;
+    }
+
+    // 3. The chip may have lost anything: IREF and every channel go out once re-attached
+    pca9955b->need_reset_IREF = true;
+    pca9955b->dirty_mask = PCA9955B_DIRTY_ALL;
+
+    esp_err_t ret = i2c_master_bus_rm_device(pca9955b->i2c_dev_handle);
+    pca9955b->i2c_dev_handle = NULL;
+    pca9955b->i2c_bus_handle = NULL;
+    return ret;
+}
+
+esp_err_t pca9955b_attach(pca9955b_handle_t pca9955b, i2c_master_bus_handle_t i2c_bus_handle) {
+    // 1. Input Validation
+    ESP_RETURN_ON_FALSE(pca9955b && i2c_bus_handle, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE(pca9955b->i2c_dev_handle == NULL, ESP_ERR_INVALID_STATE, TAG, "PCA9955B 0x%02x still attached", pca9955b->i2c_addr);
+
+    // 2. Same address and clock on the new bus; a failing chip is retried on the next frame
+    ESP_RETURN_ON_ERROR(pca9955b_add_device(pca9955b, i2c_bus_handle), TAG, "Failed to attach PCA9955B 0x%02x", pca9955b->i2c_addr);
+    pca9955b->retry_us = 0;
+    return ESP_OK;
+}
+
+void pca9955b_refresh(pca9955b_handle_t pca9955b) {
+    if(pca9955b == NULL) {
+        return;
+    }
+    const uint8_t* lut = output_lut_get(OUTPUT_LUT_PCA9955B);
+    pca9955b->level_sum = 0;
+    for(int ch = 0; ch < 15; ch++) {
+        pca9955b->level_sum += lut[pca9955b->buffer.data[ch]];
+    }
+    pca9955b->dirty_mask = PCA9955B_DIRTY_ALL;
+}
+
+void pca9955b_set_scale(pca9955b_handle_t pca9955b, uint16_t scale) {
+    if(pca9955b == NULL || pca9955b->scale == scale) {
+        return;
+    }
+    pca9955b->scale = scale;
+    pca9955b->dirty_mask = PCA9955B_DIRTY_ALL;
+}
+
 esp_err_t pca9955b_fill(pca9955b_handle_t pca9955b, uint8_t red, uint8_t green, uint8_t blue) {
     // 1. Input Validation
     ESP_RETURN_ON_FALSE(pca9955b, ESP_ERR_INVALID_ARG, TAG, "Handle is NULL");
 
     // 2. Loop through all 5 LEDs and set color
+    const uint8_t rgb[3] = {red, green, blue};
     for(int i = 0; i < 5; i++) {
-        pca9955b->buffer.ch[i][0] = red;
-        pca9955b->buffer.ch[i][1] = green;
-        pca9955b->buffer.ch[i][2] = blue;
+        pca9955b_update(pca9955b, i * 3, rgb, 3);
     }
 
-    // 3. Mark as Dirty
-    pca9955b->need_update = true;
-
     return ESP_OK;
 }
 
-esp_err_t i2c_bus_init(gpio_num_t i2c_gpio_sda, gpio_num_t i2c_gpio_scl, i2c_master_bus_handle_t* ret_i2c_bus_handle) {
+esp_err_t i2c_bus_init(i2c_port_num_t i2c_port, gpio_num_t i2c_gpio_sda, gpio_num_t i2c_gpio_scl, i2c_master_bus_handle_t* ret_i2c_bus_handle) {
     esp_err_t ret = ESP_OK;
 
     // 1. Input Validation
@@ -219,12 +660,15 @@ esp_err_t i2c_bus_init(gpio_num_t i2c_gpio_sda, gpio_num_t i2c_gpio_scl, i2c_mas
 
     // 2. Configuration
     i2c_master_bus_config_t i2c_bus_config = {
-        .i2c_port = I2C_NUM_0,                /*!< Use I2C port 0 */
+        .i2c_port = i2c_port,                 /*!< I2C controller */
         .sda_io_num = i2c_gpio_sda,           /*!< SDA GPIO pin */
         .scl_io_num = i2c_gpio_scl,           /*!< SCL GPIO pin */
         .clk_source = I2C_CLK_SRC_DEFAULT,    /*!< Select default clock source */
         .glitch_ignore_cnt = 7,               /*!< Glitch filter (typical value) */
         .flags.enable_internal_pullup = true, /*!< Enable internal weak pull-ups */
+#if PCA9955B_ASYNC
+        .trans_queue_depth = I2C_TRANS_QUEUE_DEPTH, /*!< Non-zero makes transmits asynchronous */
+#endif
     };
 
     // 3. Install Driver
@@ -236,13 +680,143 @@ esp_err_t i2c_bus_init(gpio_num_t i2c_gpio_sda, gpio_num_t i2c_gpio_scl, i2c_mas
         return ret;
     }
 
-    ESP_LOGI(TAG, "I2C Bus initialized on SDA:%d SCL:%d", i2c_gpio_sda, i2c_gpio_scl);
+    ESP_LOGI(TAG, "I2C Bus %d initialized on SDA:%d SCL:%d", i2c_port, i2c_gpio_sda, i2c_gpio_scl);
+    return ESP_OK;
+}
+
+/**
+ * @brief Writes test patterns to the GRPFREQ register of one chip and reads them back.
+ */
+static bool i2c_probe_chip(i2c_master_bus_handle_t bus, uint8_t i2c_addr, uint32_t scl_speed_hz) {
+    static const uint8_t patterns[] = {0x55, 0xAA, 0x0F, 0xF0, 0x00};  // Ends on the reset value
+    i2c_master_dev_handle_t dev = NULL;
+    bool ok = true;
+
+    i2c_device_config_t i2c_dev_config = {
+        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
+        .device_address = i2c_addr,
+        .scl_speed_hz = scl_speed_hz,
+        .flags.disable_ack_check = false,
+    };
+    if(i2c_master_bus_add_device(bus, &i2c_dev_config, &dev) != ESP_OK) {
+        return false;
+    }
+
+    for(size_t i = 0; i < sizeof(patterns) && ok; i++) {
+        uint8_t cmd[2] = {PCA9955B_GRPFREQ_ADDR, patterns[i]};
+        uint8_t readback = ~patterns[i];
+        ok = i2c_master_transmit(dev, cmd, sizeof(cmd), I2C_TIMEOUT_MS) == ESP_OK &&
+             i2c_master_transmit_receive(dev, cmd, 1, &readback, 1, I2C_TIMEOUT_MS) == ESP_OK && readback == patterns[i];
+    }
+
+    i2c_master_bus_rm_device(dev);
+    return ok;
+}
+
+esp_err_t i2c_bus_probe_speed(i2c_port_num_t i2c_port,
+                              gpio_num_t i2c_gpio_sda,
+                              gpio_num_t i2c_gpio_scl,
+                              const uint8_t* i2c_addrs,
+                              int addr_num,
+                              uint32_t* scl_speed_hz) {
+    static const uint32_t freqs[] = I2C_PROBE_FREQS;
+    i2c_master_bus_handle_t bus = NULL;
+    int passed = -1;
+
+    // 1. Input Validation
+    ESP_RETURN_ON_FALSE(i2c_addrs && scl_speed_hz, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    *scl_speed_hz = I2C_FREQ;
+
+    // 2. Temporary synchronous bus: the readback needs blocking transfers
+    i2c_master_bus_config_t i2c_bus_config = {
+        .i2c_port = i2c_port,
+        .sda_io_num = i2c_gpio_sda,
+        .scl_io_num = i2c_gpio_scl,
+        .clk_source = I2C_CLK_SRC_DEFAULT,
+        .glitch_ignore_cnt = 7,
+        .flags.enable_internal_pullup = true,
+    };
+    ESP_RETURN_ON_ERROR(i2c_new_master_bus(&i2c_bus_config, &bus), TAG, "Failed to create probe bus");
+
+    // 3. Increasing clocks until one chip fails
+    for(int f = 0; f < (int)(sizeof(freqs) / sizeof(freqs[0])); f++) {
+        int failed = -1;
+        for(int i = 0; i < addr_num && failed < 0; i++) {
+            if(!i2c_probe_chip(bus, i2c_addrs[i], freqs[f])) {
+                failed = i;
+                ESP_LOGW(TAG, "0x%02x fails readback at %lu kHz", i2c_addrs[i], (unsigned long)(freqs[f] / 1000));
+            }
+        }
+        if(failed >= 0) {
+            // Rerun the chip at the last good clock, it left GRPFREQ garbled
+            if(passed >= 0) {
+                i2c_probe_chip(bus, i2c_addrs[failed], freqs[passed]);
+            }
+            break;
+        }
+        passed = f;
+    }
+
+    i2c_del_master_bus(bus);
+
+    // 4. A failing first clock is a wiring problem, not a speed choice
+    ESP_RETURN_ON_FALSE(passed >= 0, ESP_ERR_NOT_FOUND, TAG, "No I2C clock reads back correctly");
+    *scl_speed_hz = freqs[passed];
+    ESP_LOGI(TAG, "I2C bus %d clock settled at %lu kHz", i2c_port, (unsigned long)(*scl_speed_hz / 1000));
+    return ESP_OK;
+}
+
+bool i2c_bus_sda_stuck(gpio_num_t i2c_gpio_sda) {
+    return gpio_get_level(i2c_gpio_sda) == 0;
+}
+
+esp_err_t i2c_bus_clear(gpio_num_t i2c_gpio_sda, gpio_num_t i2c_gpio_scl) {
+    int clocks = 0;
+
+    // 1. Take both lines as open-drain GPIOs, released
+    gpio_config_t io_config = {
+        .pin_bit_mask = (1ULL << i2c_gpio_sda) | (1ULL << i2c_gpio_scl),
+        .mode = GPIO_MODE_INPUT_OUTPUT_OD,
+        .pull_up_en = GPIO_PULLUP_ENABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE,
+    };
+    ESP_RETURN_ON_ERROR(gpio_config(&io_config), TAG, "Failed to take the I2C pins");
+    gpio_set_level(i2c_gpio_sda, 1);
+    gpio_set_level(i2c_gpio_scl, 1);
+    esp_rom_delay_us(I2C_CLEAR_HALF_PERIOD_US);
+
+    // 2. A target stuck mid-byte shifts out its remaining bits and lets go within 9 clocks
+    while(gpio_get_level(i2c_gpio_sda) == 0 && clocks < 9) {
+        gpio_set_level(i2c_gpio_scl, 0);
+        esp_rom_delay_us(I2C_CLEAR_HALF_PERIOD_US);
+        gpio_set_level(i2c_gpio_scl, 1);
+        esp_rom_delay_us(I2C_CLEAR_HALF_PERIOD_US);
+        clocks++;
+    }
+
+    // 3. STOP (SDA rises while SCL is high) resets every target's state machine
+    gpio_set_level(i2c_gpio_scl, 0);
+    gpio_set_level(i2c_gpio_sda, 0);
+    esp_rom_delay_us(I2C_CLEAR_HALF_PERIOD_US);
+    gpio_set_level(i2c_gpio_scl, 1);
+    esp_rom_delay_us(I2C_CLEAR_HALF_PERIOD_US);
+    gpio_set_level(i2c_gpio_sda, 1);
+    esp_rom_delay_us(I2C_CLEAR_HALF_PERIOD_US);
+    bool released = gpio_get_level(i2c_gpio_sda) == 1;
+
+    // 4. Hand the pins back for the next i2c_bus_init()
+    gpio_reset_pin(i2c_gpio_sda);
+    gpio_reset_pin(i2c_gpio_scl);
+
+    ESP_RETURN_ON_FALSE(released, ESP_FAIL, TAG, "SDA:%d still held low after %d clocks", i2c_gpio_sda, clocks);
+    ESP_LOGI(TAG, "I2C bus on SDA:%d cleared with %d clocks", i2c_gpio_sda, clocks);
     return ESP_OK;
 }
 
 void pca9955b_test1() {
     i2c_master_bus_handle_t bus_handle;
-    i2c_bus_init(GPIO_NUM_21, GPIO_NUM_22, &bus_handle);
+    i2c_bus_init(I2C_NUM_0, GPIO_NUM_21, GPIO_NUM_22, &bus_handle);
 
     pca9955b_handle_t pca9955b[PCA9955B_NUM];
 
@@ -254,7 +828,7 @@ void pca9955b_test1() {
     ESP_LOGI("pca9955b_test", "testing pca9955b_init");
 
     for(int idx = 0; idx < PCA9955B_NUM; idx++) {
-        ret = pca9955b_init(BOARD_HW_CONFIG.i2c_addrs[idx], bus_handle, &pca9955b[idx]);
+        ret = pca9955b_init(BOARD_HW_CONFIG.i2c_addrs[idx], bus_handle, I2C_FREQ, &pca9955b[idx]);
         if(ret != ESP_OK) {
             ESP_LOGE("pca9955b_test", "pca9955b_init failed");
         }
@@ -294,7 +868,7 @@ void pca9955b_test2() {
     i2c_master_bus_handle_t bus_handle = NULL;
     ESP_LOGI(TAG_TEST, "Initializing I2C Bus...");
 
-    ret = i2c_bus_init(GPIO_NUM_21, GPIO_NUM_22, &bus_handle);
+    ret = i2c_bus_init(I2C_NUM_0, GPIO_NUM_21, GPIO_NUM_22, &bus_handle);
     if(ret != ESP_OK) {
         ESP_LOGE(TAG_TEST, "I2C Bus Init Failed");
         return;
@@ -307,7 +881,7 @@ void pca9955b_test2() {
     for(int idx = 0; idx < PCA9955B_NUM; idx++) {
         uint8_t addr = BOARD_HW_CONFIG.i2c_addrs[idx];
 
-        ret = pca9955b_init(addr, bus_handle, &pca9955b[idx]);
+        ret = pca9955b_init(addr, bus_handle, I2C_FREQ, &pca9955b[idx]);
 
         if(ret != ESP_OK) {
             ESP_LOGE(TAG_TEST, "Device [%d] (Addr 0x%02X) Init Failed!", idx, addr);
@@ -1,5 +1,7 @@
 #include "ws2812b_encoder.h"
 
+#include <string.h>
+
 #include "esp_attr.h"
 
 #define WS2812B_RESOLUTION 10000000 /*!< RMT tick resolution: 10 MHz (1 tick = 0.1 us) */
@@ -26,6 +28,36 @@
             },                                                                                        \
     }
 
+/*! One WS2812B bit as an RMT symbol, same timing as RMT_BYTES_ENCODER_CONFIG_DEFAULT() */
+#define WS2812B_T0H_TICKS ((uint32_t)(0.4 * (WS2812B_RESOLUTION) / 1000000))
+#define WS2812B_T0L_TICKS ((uint32_t)(0.85 * (WS2812B_RESOLUTION) / 1000000))
+#define WS2812B_T1H_TICKS ((uint32_t)(0.8 * (WS2812B_RESOLUTION) / 1000000))
+#define WS2812B_T1L_TICKS ((uint32_t)(0.45 * (WS2812B_RESOLUTION) / 1000000))
+
+#define LUT_BIT(byte, bit)                                                          \
+    {                                                                               \
+        .duration0 = ((byte) >> (bit)) & 1 ? WS2812B_T1H_TICKS : WS2812B_T0H_TICKS, \
+        .level0 = 1,                                                                \
+        .duration1 = ((byte) >> (bit)) & 1 ? WS2812B_T1L_TICKS : WS2812B_T0L_TICKS, \
+        .level1 = 0,                                                                \
+    }
+#define LUT_BYTE(b) {LUT_BIT(b, 7), LUT_BIT(b, 6), LUT_BIT(b, 5), LUT_BIT(b, 4), LUT_BIT(b, 3), LUT_BIT(b, 2), LUT_BIT(b, 1), LUT_BIT(b, 0)}
+#define LUT_BYTES_4(b) LUT_BYTE(b), LUT_BYTE((b) + 1), LUT_BYTE((b) + 2), LUT_BYTE((b) + 3)
+#define LUT_BYTES_16(b) LUT_BYTES_4(b), LUT_BYTES_4((b) + 4), LUT_BYTES_4((b) + 8), LUT_BYTES_4((b) + 12)
+#define LUT_BYTES_64(b) LUT_BYTES_16(b), LUT_BYTES_16((b) + 16), LUT_BYTES_16((b) + 32), LUT_BYTES_16((b) + 48)
+
+/**
+ * @brief The 8 RMT symbols of every byte value, MSB first (8 KiB).
+ *
+ * Kept in DRAM so the refill interrupt can read it while the flash cache is disabled.
+ */
+static const DRAM_ATTR rmt_symbol_word_t byte_symbols[256][8] = {
+    LUT_BYTES_64(0),
+    LUT_BYTES_64(64),
+    LUT_BYTES_64(128),
+    LUT_BYTES_64(192),
+};
+
 /*! Reset code length for WS2812B: ≥ 50 us (converted to 10 MHz RMT ticks) */
 #define WS2812B_RESET_TICKS (WS2812B_RESOLUTION / 1000000 * 50 / 2)
 
@@ -47,8 +79,11 @@ typedef struct {
     rmt_encoder_t base;           /*!< RMT encoder base interface */
     rmt_encoder_t* bytes_encoder; /*!< Encoder for bit-level 0/1 waveform (T0H/T0L/T1H/T1L) */
     rmt_encoder_t* copy_encoder;  /*!< Optional encoder for fast buffer copy */
+    rmt_encoder_t* lut_encoder;   /*!< Lookup-table encoder, replaces both of the above */
+    bool image;                   /*!< Payload is already encoded, copy_encoder sends it alone */
     int state;                    /*!< Internal FSM state of encoder */
     rmt_symbol_word_t reset_code; /*!< RMT reset symbol for WS2812B timing */
+    volatile uint32_t calls;      /*!< encode() calls, one per refill / trans-done interrupt */
 } encoder_t;
 
 /**
@@ -80,6 +115,19 @@ encode(rmt_encoder_t* rmt_encoder, rmt_channel_handle_t rmt_channel, const void*
     rmt_encode_state_t state = RMT_ENCODING_RESET; /*!< Output flags to return */
     size_t encoded_symbols = 0;
 
+    ws2812b_encoder->calls++;
+
+    /* Lookup-table encoder: pixels and reset in one pass */
+    if(ws2812b_encoder->lut_encoder) {
+        rmt_encoder_handle_t lut_encoder = ws2812b_encoder->lut_encoder;
+        return lut_encoder->encode(lut_encoder, rmt_channel, buffer, buffer_size, ret_state);
+    }
+
+    /* Pre-encoded image: reset symbol included */
+    if(ws2812b_encoder->image) {
+        return copy_encoder->encode(copy_encoder, rmt_channel, buffer, buffer_size, ret_state);
+    }
+
     switch(ws2812b_encoder->state) {
         case 0: /*!< Encode pixel bytes */
             encoded_symbols += bytes_encoder->encode(bytes_encoder, rmt_channel, buffer, buffer_size, &session_state);
@@ -137,6 +185,14 @@ esp_err_t del_encoder(rmt_encoder_t* rmt_encoder) {
         }
     }
 
+    /* Delete lookup-table encoder */
+    if(ws2812b_encoder->lut_encoder) {
+        ret = rmt_del_encoder(ws2812b_encoder->lut_encoder);
+        if(ret != ESP_OK) {
+            last_error = ret;
+        }
+    }
+
     /* Delete reset copy encoder */
     if(ws2812b_encoder->copy_encoder) {
         ret = rmt_del_encoder(ws2812b_encoder->copy_encoder);
@@ -174,13 +230,68 @@ esp_err_t encoder_reset(rmt_encoder_t* rmt_encoder) {
     if(ws2812b_encoder->copy_encoder) {
         rmt_encoder_reset(ws2812b_encoder->copy_encoder); /*!< Reset WS2812B reset-symbol encoder */
     }
+    if(ws2812b_encoder->lut_encoder) {
+        rmt_encoder_reset(ws2812b_encoder->lut_encoder); /*!< Restart the lookup-table encoder at byte 0 */
+    }
 
     /* Restore encoding FSM */
     ws2812b_encoder->state = RMT_ENCODING_RESET; /*!< Set to initial encoding state */
     return ESP_OK;
 }
 
+/**
+ * @brief Simple encoder callback: copies 8 precomputed symbols per pixel byte, then the reset symbol.
+ *
+ * Only whole bytes are written, so the byte to continue from is symbols_written / 8.
+ *
+ * @param data             Raw pixel byte buffer
+ * @param data_size        Size of pixel buffer (bytes)
+ * @param symbols_written  Symbols produced so far in this transaction
+ * @param symbols_free     Free space in `symbols`
+ * @param symbols          Destination (channel memory or DMA buffer)
+ * @param done             Set once the reset symbol has been written
+ * @param arg              Composite encoder, for the reset symbol
+ * @return Number of symbols written, 0 if not even one byte fits
+ */
+static IRAM_ATTR size_t
+lut_encode(const void* data, size_t data_size, size_t symbols_written, size_t symbols_free, rmt_symbol_word_t* symbols, bool* done, void* arg) {
+    const encoder_t* ws2812b_encoder = (const encoder_t*)arg;
+    const uint8_t* bytes = (const uint8_t*)data;
+    size_t byte_idx = symbols_written / 8;
+    size_t byte_num = symbols_free / 8;
+    size_t written = 0;
+
+    /* Pixel bytes, as many as fit */
+    if(byte_num > data_size - byte_idx) {
+        byte_num = data_size - byte_idx;
+    }
+    for(size_t i = 0; i < byte_num; i++) {
+        memcpy(symbols + written, byte_symbols[bytes[byte_idx + i]], sizeof(byte_symbols[0]));
+        written += 8;
+    }
+
+    /* Reset symbol right behind the last byte */
+    if(byte_idx + byte_num == data_size && written < symbols_free) {
+        symbols[written++] = ws2812b_encoder->reset_code;
+        *done = true;
+    }
+
+    return written;
+}
+
+size_t ws2812b_encode_symbols(const uint8_t* data, size_t size, rmt_symbol_word_t* symbols) {
+    for(size_t i = 0; i < size; i++) {
+        memcpy(symbols + i * 8, byte_symbols[data[i]], sizeof(byte_symbols[0]));
+    }
+    symbols[size * 8] = WS2812B_RESET_CODE_DEFAULT();
+    return size * 8 + 1;
+}
+
 esp_err_t rmt_new_encoder(rmt_encoder_handle_t* ret_encoder) {
+    return rmt_new_encoder_with_type(WS2812B_LUT_ENCODER ? WS2812B_ENCODER_LUT : WS2812B_ENCODER_BYTES, ret_encoder);
+}
+
+esp_err_t rmt_new_encoder_with_type(ws2812b_encoder_type_t type, rmt_encoder_handle_t* ret_encoder) {
     esp_err_t ret = ESP_OK;
     if(ret_encoder == NULL) {
         return ESP_ERR_INVALID_ARG; /*!< Output handle must not be NULL */
@@ -202,6 +313,41 @@ esp_err_t rmt_new_encoder(rmt_encoder_handle_t* ret_encoder) {
     /* Initialize sub-encoder pointers */
     ws2812b_encoder->bytes_encoder = NULL; /*!< Will hold bit waveform encoder */
     ws2812b_encoder->copy_encoder = NULL;  /*!< Will hold reset-symbol encoder */
+    ws2812b_encoder->lut_encoder = NULL;   /*!< Will hold the lookup-table encoder */
+
+    /* Assign precomputed WS2812B reset symbol */
+    ws2812b_encoder->reset_code = WS2812B_RESET_CODE_DEFAULT();
+
+    /* Lookup-table encoder: a single simple encoder does the whole frame */
+    if(type == WS2812B_ENCODER_LUT) {
+        rmt_simple_encoder_config_t rmt_simple_encoder_config = {
+            .callback = lut_encode,
+            .arg = ws2812b_encoder,
+            .min_chunk_size = 8, /*!< One byte */
+        };
+        ret = rmt_new_simple_encoder(&rmt_simple_encoder_config, &ws2812b_encoder->lut_encoder);
+        if(ret != ESP_OK) {
+            free(ws2812b_encoder);
+            return ret;
+        }
+
+        *ret_encoder = &ws2812b_encoder->base;
+        return ESP_OK;
+    }
+
+    /* Symbol image: only the copy encoder is needed */
+    rmt_copy_encoder_config_t rmt_copy_encoder_config = {};
+    if(type == WS2812B_ENCODER_IMAGE) {
+        ret = rmt_new_copy_encoder(&rmt_copy_encoder_config, &ws2812b_encoder->copy_encoder);
+        if(ret != ESP_OK) {
+            free(ws2812b_encoder);
+            return ret;
+        }
+        ws2812b_encoder->image = true;
+
+        *ret_encoder = &ws2812b_encoder->base;
+        return ESP_OK;
+    }
 
     /* Create pixel byte waveform encoder (bit timing config) */
     rmt_bytes_encoder_config_t rmt_bytes_encoder_config = RMT_BYTES_ENCODER_CONFIG_DEFAULT();
@@ -212,7 +358,6 @@ esp_err_t rmt_new_encoder(rmt_encoder_handle_t* ret_encoder) {
     }
 
     /* Create copy encoder for reset symbol transmission */
-    rmt_copy_encoder_config_t rmt_copy_encoder_config = {};
     ret = rmt_new_copy_encoder(&rmt_copy_encoder_config, &ws2812b_encoder->copy_encoder);
     if(ret != ESP_OK) {
         rmt_del_encoder(ws2812b_encoder->bytes_encoder);
@@ -220,9 +365,13 @@ esp_err_t rmt_new_encoder(rmt_encoder_handle_t* ret_encoder) {
         return ret;
     }
 
-    /* Assign precomputed WS2812B reset symbol */
-    ws2812b_encoder->reset_code = WS2812B_RESET_CODE_DEFAULT();
-
     *ret_encoder = &ws2812b_encoder->base; /*!< Return base interface pointer as encoder handle */
     return ESP_OK;
 }
+
+uint32_t rmt_encoder_get_calls(rmt_encoder_handle_t encoder) {
+    if(encoder == NULL) {
+        return 0;
+    }
+    return __containerof(encoder, encoder_t, base)->calls;
+}
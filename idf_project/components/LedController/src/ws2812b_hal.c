@@ -3,48 +3,130 @@
 #include "string.h"
 
 #include "esp_check.h"
+#include "esp_heap_caps.h"
 #include "esp_log.h"
 #include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
+#include "output_lut.h"
+
 #define WS2812B_RESOLUTION 10000000
 
 static const char* TAG = "WS2812";
 
+/**
+ * @brief Sum of the output levels of `len` colours from `first` on, before the limiter, in 8.8 fixed point.
+ */
+static uint32_t ws2812b_level_sum(const ws2812b_dev_t* dev, size_t first, size_t len) {
+    const uint16_t* lut16 = output_lut_get16(OUTPUT_LUT_WS2812B);
+    uint32_t sum = 0;
+
+    for(size_t i = first; i < first + len; i++) {
+        sum += lut16[dev->pixels[i]];
+    }
+    return sum;
+}
+
+esp_err_t ws2812b_plan_mem(const uint16_t* pixel_num, int strip_num, ws2812b_mem_config_t* mem) {
+    // 1. Validation
+    ESP_RETURN_ON_FALSE(pixel_num && mem && strip_num >= 0, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    memset(mem, 0, strip_num * sizeof(ws2812b_mem_config_t));
+
+    int free_blocks = WS2812B_MEM_BLOCK_NUM;
+
+#if SOC_RMT_SUPPORT_DMA && WS2812B_DMA
+    // 2. DMA for the longest strips (a DMA channel still occupies one block)
+    for(int n = 0; n < WS2812B_DMA_CHANNEL_NUM; n++) {
+        int longest = -1;
+        for(int i = 0; i < strip_num; i++) {
+            if(pixel_num[i] > 0 && !mem[i].with_dma && (longest < 0 || pixel_num[i] > pixel_num[longest])) {
+                longest = i;
+            }
+        }
+        if(longest < 0) {
+            break;
+        }
+        mem[longest].with_dma = true;
+        mem[longest].mem_block_symbols = WS2812B_DMA_MEM_SYMBOLS;
+        free_blocks--;
+    }
+#endif
+
+    // 3. One block for every other strip in use
+    for(int i = 0; i < strip_num; i++) {
+        if(pixel_num[i] > 0 && !mem[i].with_dma) {
+            mem[i].mem_block_symbols = WS2812B_MEM_BLOCK_SYMBOLS;
+            free_blocks--;
+        }
+    }
+    ESP_RETURN_ON_FALSE(free_blocks >= 0, ESP_ERR_NOT_SUPPORTED, TAG, "%d strips need more than %d RMT channels", strip_num, WS2812B_MEM_BLOCK_NUM);
+
+    // 4. Spare blocks go to the strip with the most symbols per block, until it holds its whole frame
+    while(free_blocks > 0) {
+        int best = -1;
+        for(int i = 0; i < strip_num; i++) {
+            if(mem[i].with_dma || mem[i].mem_block_symbols == 0 || mem[i].mem_block_symbols >= WS2812B_FRAME_SYMBOLS(pixel_num[i])) {
+                continue;
+            }
+            if(best < 0 || (uint32_t)pixel_num[i] * mem[best].mem_block_symbols > (uint32_t)pixel_num[best] * mem[i].mem_block_symbols) {
+                best = i;
+            }
+        }
+        if(best < 0) {
+            break;
+        }
+        mem[best].mem_block_symbols += WS2812B_MEM_BLOCK_SYMBOLS;
+        free_blocks--;
+    }
+
+    return ESP_OK;
+}
+
 /**
  * @brief Initializes the RMT TX channel for WS2812B data transmission.
  *
- * @param[in]  gpio_num   GPIO pin for data signal (Must be a valid output pin).
- * @param[in]  pixel_num  Total LED count (Used for buffer size estimation).
- * @param[out] channel    Pointer to store the created RMT channel handle.
+ * @param[in]     gpio_num   GPIO pin for data signal (Must be a valid output pin).
+ * @param[in,out] mem        Requested RMT memory; updated if the channel fell back to one block.
+ * @param[out]    channel    Pointer to store the created RMT channel handle.
  *
  * @return
  * - ESP_OK: Success.
  * - ESP_ERR_INVALID_ARG: Null pointer or invalid GPIO.
- * - ESP_ERR_NO_MEM: Insufficient RMT memory blocks.
+ * - ESP_ERR_NOT_FOUND: No free RMT channel.
  */
-static esp_err_t ws2812b_init_channel(gpio_num_t gpio_num, uint16_t pixel_num, rmt_channel_handle_t* channel) {
+static esp_err_t ws2812b_init_channel(gpio_num_t gpio_num, ws2812b_mem_config_t* mem, rmt_channel_handle_t* channel) {
     // Check for critical null pointer and hardware validity
-    ESP_RETURN_ON_FALSE(channel, ESP_ERR_INVALID_ARG, TAG, "Channel pointer is invalid");
+    ESP_RETURN_ON_FALSE(channel && mem, ESP_ERR_INVALID_ARG, TAG, "Channel pointer is invalid");
     ESP_RETURN_ON_FALSE(GPIO_IS_VALID_OUTPUT_GPIO(gpio_num), ESP_ERR_INVALID_ARG, TAG, "Invalid GPIO %d", gpio_num);
 
     rmt_tx_channel_config_t rmt_tx_channel_config = {
         .gpio_num = gpio_num,
         .clk_src = RMT_CLK_SRC_DEFAULT,
         .resolution_hz = WS2812B_RESOLUTION,
-        .mem_block_symbols = 64,
+        .mem_block_symbols = mem->mem_block_symbols,
         .trans_queue_depth = 8,
-        .flags.with_dma = 0,
+        .flags.with_dma = mem->with_dma,
     };
 
+    if(rmt_new_tx_channel(&rmt_tx_channel_config, channel) == ESP_OK) {
+        return ESP_OK;
+    }
+
+    // The DMA channel or the extra blocks may be taken, a single block still works
+    ESP_LOGW(TAG, "GPIO %d: no RMT channel with %u symbols%s, falling back to one block", gpio_num, (unsigned)mem->mem_block_symbols, mem->with_dma ? " (DMA)" : "");
+    mem->mem_block_symbols = WS2812B_MEM_BLOCK_SYMBOLS;
+    mem->with_dma = false;
+    rmt_tx_channel_config.mem_block_symbols = mem->mem_block_symbols;
+    rmt_tx_channel_config.flags.with_dma = 0;
+
     // Attempt to create channel, auto-log error if fails
     ESP_RETURN_ON_ERROR(rmt_new_tx_channel(&rmt_tx_channel_config, channel), TAG, "RMT create failed on GPIO %d", gpio_num);
 
     return ESP_OK;
 }
 
-esp_err_t ws2812b_init(gpio_num_t gpio_num, uint16_t pixel_num, ws2812b_handle_t* ws2812b) {
+esp_err_t ws2812b_init(gpio_num_t gpio_num, uint16_t pixel_num, const ws2812b_mem_config_t* mem, ws2812b_handle_t* ws2812b) {
     esp_err_t ret = ESP_OK;
     ws2812b_dev_t* dev = NULL;
 
@@ -58,16 +140,52 @@ esp_err_t ws2812b_init(gpio_num_t gpio_num, uint16_t pixel_num, ws2812b_handle_t
     ESP_GOTO_ON_FALSE(dev, ESP_ERR_NO_MEM, err, TAG, "Device allocation failed");
     dev->gpio_num = gpio_num;
     dev->pixel_num = pixel_num;
+    dev->tx_pixel_num = pixel_num;
+    dev->scale = OUTPUT_LUT_SCALE_NONE;
+    dev->tx_scale = OUTPUT_LUT_SCALE_NONE;
+    dev->mem.mem_block_symbols = WS2812B_MEM_BLOCK_SYMBOLS;
+    if(mem && mem->mem_block_symbols > 0) {
+        dev->mem = *mem;
+    }
 
-    // 3. Allocation (Pixel Buffer)
+    // 3. Allocation (Shadow, Back & Front Pixel Buffers)
+    dev->pixels = heap_caps_calloc(pixel_num * 3, 1, MALLOC_CAP_8BIT);
+    ESP_GOTO_ON_FALSE(dev->pixels, ESP_ERR_NO_MEM, err, TAG, "Shadow buffer allocation failed");
     dev->buffer = heap_caps_calloc(pixel_num * 3, 1, MALLOC_CAP_8BIT);
     ESP_GOTO_ON_FALSE(dev->buffer, ESP_ERR_NO_MEM, err, TAG, "Buffer allocation failed");
+    dev->tx_buffer = heap_caps_calloc(pixel_num * 3, 1, MALLOC_CAP_8BIT);
+    ESP_GOTO_ON_FALSE(dev->tx_buffer, ESP_ERR_NO_MEM, err, TAG, "TX buffer allocation failed");
 
     // 4. RMT Encoder Setup
     ESP_GOTO_ON_ERROR(rmt_new_encoder(&dev->rmt_encoder), err, TAG, "Encoder creation failed");
 
+#if WS2812B_SYMBOL_CACHE
+    // Optional: the cache only saves CPU, the strip works without it
+    dev->symbols = heap_caps_calloc(WS2812B_FRAME_SYMBOLS(pixel_num), sizeof(rmt_symbol_word_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if(dev->symbols == NULL || rmt_new_encoder_with_type(WS2812B_ENCODER_IMAGE, &dev->image_encoder) != ESP_OK) {
+        ESP_LOGW(TAG, "GPIO %d: no memory for the symbol cache, encoding in the RMT interrupt", gpio_num);
+        free(dev->symbols);
+        dev->symbols = NULL;
+    } else {
+        ws2812b_encode_symbols(dev->tx_buffer, pixel_num * 3, dev->symbols);
+    }
+#endif
+
+#if WS2812B_DITHER
+    // Optional too: without the error buffer the strip falls back to 8-bit output
+    dev->error = heap_caps_malloc(pixel_num * 3, MALLOC_CAP_8BIT);
+    if(dev->error == NULL) {
+        ESP_LOGW(TAG, "GPIO %d: no memory for dithering, sending 8-bit levels", gpio_num);
+    } else {
+        // Spread the starting fractions so equal levels do not step up in the same frame
+        for(int i = 0; i < pixel_num * 3; i++) {
+            dev->error[i] = (uint8_t)(i * 167);
+        }
+    }
+#endif
+
     // 5. RMT Channel Setup
-    ESP_GOTO_ON_ERROR(ws2812b_init_channel(gpio_num, pixel_num, &dev->rmt_channel), err, TAG, "Channel init failed");
+    ESP_GOTO_ON_ERROR(ws2812b_init_channel(gpio_num, &dev->mem, &dev->rmt_channel), err, TAG, "Channel init failed");
 
     // 6. Enable RMT
     ESP_GOTO_ON_ERROR(rmt_enable(dev->rmt_channel), err, TAG, "RMT enable failed");
@@ -77,10 +195,16 @@ esp_err_t ws2812b_init(gpio_num_t gpio_num, uint16_t pixel_num, ws2812b_handle_t
     };
     ESP_GOTO_ON_ERROR(rmt_transmit(dev->rmt_channel, dev->rmt_encoder, dev->buffer, pixel_num * 3, &tx_config), err, TAG, "Failed to clear LEDs");
     rmt_tx_wait_all_done(dev->rmt_channel, RMT_TIMEOUT_MS);
+    dev->irq_seen = rmt_encoder_get_calls(dev->rmt_encoder) + rmt_encoder_get_calls(dev->image_encoder);
 
     // Success: Assign handle and return
     *ws2812b = dev;
-    ESP_LOGI(TAG, "WS2812B driver initialized (GPIO: %d, Pixels: %d)", gpio_num, pixel_num);
+    ESP_LOGI(TAG,
+             "WS2812B driver initialized (GPIO: %d, Pixels: %d, RMT: %u symbols%s)",
+             gpio_num,
+             pixel_num,
+             (unsigned)dev->mem.mem_block_symbols,
+             dev->mem.with_dma ? " DMA" : "");
     return ESP_OK;
 
 err:
@@ -91,9 +215,18 @@ err:
         if(dev->rmt_encoder) {
             rmt_del_encoder(dev->rmt_encoder);
         }
+        if(dev->image_encoder) {
+            rmt_del_encoder(dev->image_encoder);
+        }
+        free(dev->symbols);
+        free(dev->error);
+        free(dev->pixels);
         if(dev->buffer) {
             free(dev->buffer);
         }
+        if(dev->tx_buffer) {
+            free(dev->tx_buffer);
+        }
         free(dev);
     }
 
@@ -114,11 +247,18 @@ esp_err_t ws2812b_set_pixel(ws2812b_handle_t ws2812b, int pixel_idx, uint8_t red
         return ESP_ERR_INVALID_ARG;
     }
 
-    // 3. Set Color (GRB Format for WS2812B)
+    // 3. Set the colour (GRB Format for WS2812B)
     uint32_t offset = pixel_idx * 3;
-    ws2812b->buffer[offset + 0] = green;
-    ws2812b->buffer[offset + 1] = red;
-    ws2812b->buffer[offset + 2] = blue;
+    ws2812b->power_sum -= ws2812b_level_sum(ws2812b, offset, 3);
+    ws2812b->pixels[offset + 0] = green;
+    ws2812b->pixels[offset + 1] = red;
+    ws2812b->pixels[offset + 2] = blue;
+    ws2812b->power_sum += ws2812b_level_sum(ws2812b, offset, 3);
+
+    // 4. Extend the dirty prefix
+    if(pixel_idx >= ws2812b->dirty_num) {
+        ws2812b->dirty_num = pixel_idx + 1;
+    }
 
     return ESP_OK;
 }
@@ -131,10 +271,36 @@ esp_err_t ws2812b_write(ws2812b_handle_t ws2812b, uint8_t* _buffer) {
     ESP_RETURN_ON_FALSE(_buffer, ESP_ERR_INVALID_ARG, TAG, "Source buffer is NULL");
 
     // 3. Validate Internal Buffer (Defensive Programming)
-    ESP_RETURN_ON_FALSE(ws2812b->buffer, ESP_ERR_INVALID_STATE, TAG, "Internal buffer is not allocated");
+    ESP_RETURN_ON_FALSE(ws2812b->pixels, ESP_ERR_INVALID_STATE, TAG, "Internal buffer is not allocated");
 
-    // 4. Perform Fast Copy
-    memcpy(ws2812b->buffer, _buffer, ws2812b->pixel_num * 3 * sizeof(uint8_t));
+    // 4. Copy into the shadow buffer, the output tables are applied when the frame is staged
+    memcpy(ws2812b->pixels, _buffer, ws2812b->pixel_num * 3 * sizeof(uint8_t));
+    ws2812b->power_sum = ws2812b_level_sum(ws2812b, 0, ws2812b->pixel_num * 3);
+    ws2812b->dirty_num = ws2812b->pixel_num;
+
+    return ESP_OK;
+}
+
+esp_err_t ws2812b_write_pixels(ws2812b_handle_t ws2812b, int pixel_idx, const uint8_t* src_data, int pixel_count) {
+    // 1. Validation
+    ESP_RETURN_ON_FALSE(ws2812b && src_data, ESP_ERR_INVALID_ARG, TAG, "Null pointer");
+    ESP_RETURN_ON_FALSE(ws2812b->pixels, ESP_ERR_INVALID_STATE, TAG, "Internal buffer is not allocated");
+
+    // 2. Bounds Check (CRITICAL)
+    if(pixel_idx < 0 || pixel_count < 0 || pixel_idx + pixel_count > ws2812b->pixel_num) {
+        ESP_LOGE(TAG, "Pixel range %d+%d out of bounds (Max: %d)", pixel_idx, pixel_count, ws2812b->pixel_num);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // 3. Copy the run into the shadow buffer, keeping the level sum of the strip current
+    ws2812b->power_sum -= ws2812b_level_sum(ws2812b, pixel_idx * 3, pixel_count * 3);
+    memcpy(ws2812b->pixels + pixel_idx * 3, src_data, pixel_count * 3);
+    ws2812b->power_sum += ws2812b_level_sum(ws2812b, pixel_idx * 3, pixel_count * 3);
+
+    // 4. Extend the dirty prefix
+    if(pixel_idx + pixel_count > ws2812b->dirty_num) {
+        ws2812b->dirty_num = pixel_idx + pixel_count;
+    }
 
     return ESP_OK;
 }
@@ -150,6 +316,11 @@ static const rmt_transmit_config_t rmt_tx_config = {
 };
 
 esp_err_t ws2812b_show(ws2812b_handle_t ws2812b) {
+    ESP_RETURN_ON_ERROR(ws2812b_stage(ws2812b), TAG, "Stage failed");
+    return ws2812b_kick(ws2812b);
+}
+
+esp_err_t ws2812b_stage(ws2812b_handle_t ws2812b) {
 
     // 1. Basic Pointer Validation
     ESP_RETURN_ON_FALSE(ws2812b, ESP_ERR_INVALID_ARG, TAG, "Handle is NULL");
@@ -157,11 +328,102 @@ esp_err_t ws2812b_show(ws2812b_handle_t ws2812b) {
     // 2. State Validation
     ESP_RETURN_ON_FALSE(ws2812b->rmt_channel && ws2812b->rmt_encoder, ESP_ERR_INVALID_STATE, TAG, "RMT not initialized");
 
-    // 3. Transmit
-    size_t payload_size = ws2812b->pixel_num * 3;
+    // 3. The changed pixels, and those whose fraction moves them every frame
+    uint16_t num = ws2812b->dirty_num > ws2812b->dither_num ? ws2812b->dirty_num : ws2812b->dither_num;
+
+    // 4. A new limiter factor changes every pixel
+    if(ws2812b->scale != ws2812b->tx_scale) {
+        num = ws2812b->pixel_num;
+        ws2812b->tx_scale = ws2812b->scale;
+    }
+
+    // 5. Optimization: Skip if nothing changed
+    ws2812b->dirty_num = 0;
+    if(num == 0) {
+        return ESP_OK;
+    }
+
+    // 6. Run the prefix through the output tables and the limiter into the back buffer
+    size_t payload_size = num * 3;
+    if(ws2812b->error) {
+        size_t fraction_size = output_lut_dither(OUTPUT_LUT_WS2812B, ws2812b->pixels, ws2812b->scale, ws2812b->error, ws2812b->buffer, payload_size);
+        ws2812b->dither_num = (fraction_size + 2) / 3;
+    } else {
+        output_lut_copy_scaled(OUTPUT_LUT_WS2812B, ws2812b->buffer, ws2812b->pixels, payload_size, ws2812b->scale);
+    }
+
+    // 7. Trim pixels that come out the same as last frame: the strip still shows them
+    while(payload_size > 0 && ws2812b->buffer[payload_size - 1] == ws2812b->tx_buffer[payload_size - 1]) {
+        payload_size--;
+    }
+    if(payload_size == 0) {
+        return ESP_OK;
+    }
+    payload_size = (payload_size + 2) / 3 * 3;
+
+    // 8. The front buffer is still owned by the RMT until the previous frame is done
+    ESP_RETURN_ON_ERROR(rmt_tx_wait_all_done(ws2812b->rmt_channel, RMT_TIMEOUT_MS), TAG, "Previous frame still on the wire");
+
+    // 9. Swap Back/Front and keep the back buffer coherent with the strip
+    // The buffers only differ in the prefix, the front buffer still mirrors the whole strip.
+    uint8_t* front = ws2812b->buffer;
+    ws2812b->buffer = ws2812b->tx_buffer;
+    ws2812b->tx_buffer = front;
+    memcpy(ws2812b->buffer, ws2812b->tx_buffer, payload_size);
+    ws2812b->tx_pixel_num = payload_size / 3;
+
+    // 10. Encode here rather than in the refill interrupt, the image is reused until the frame changes
+    if(ws2812b->symbols) {
+        ws2812b_encode_symbols(ws2812b->tx_buffer, payload_size, ws2812b->symbols);
+    }
+
+    // 11. Success: the new frame now waits in the front buffer
+    ws2812b->staged = true;
+
+    return ESP_OK;
+}
+
+esp_err_t ws2812b_stage_repeat(ws2812b_handle_t ws2812b) {
+    // 1. Validation
+    ESP_RETURN_ON_FALSE(ws2812b, ESP_ERR_INVALID_ARG, TAG, "Handle is NULL");
+    ESP_RETURN_ON_FALSE(ws2812b->rmt_channel && ws2812b->rmt_encoder, ESP_ERR_INVALID_STATE, TAG, "RMT not initialized");
+
+    if(ws2812b->staged) {
+        return ESP_OK;
+    }
+
+    // 2. The front buffer (and its symbol image) still hold the last prefix sent
+    ESP_RETURN_ON_ERROR(rmt_tx_wait_all_done(ws2812b->rmt_channel, RMT_TIMEOUT_MS), TAG, "Previous frame still on the wire");
+    ws2812b->staged = true;
+
+    return ESP_OK;
+}
+
+esp_err_t ws2812b_kick(ws2812b_handle_t ws2812b) {
+    // 1. Validation
+    ESP_RETURN_ON_FALSE(ws2812b, ESP_ERR_INVALID_ARG, TAG, "Handle is NULL");
+    ESP_RETURN_ON_FALSE(ws2812b->rmt_channel && ws2812b->rmt_encoder, ESP_ERR_INVALID_STATE, TAG, "RMT not initialized");
+
+    if(!ws2812b->staged) {
+        return ESP_OK;
+    }
 
-    ESP_RETURN_ON_ERROR(
-        rmt_transmit(ws2812b->rmt_channel, ws2812b->rmt_encoder, ws2812b->buffer, payload_size, &rmt_tx_config), TAG, "Failed to transmit");
+    // 2. Transmit (returns as soon as the frame is queued)
+    if(ws2812b->symbols) {
+        ESP_RETURN_ON_ERROR(rmt_transmit(ws2812b->rmt_channel,
+                                         ws2812b->image_encoder,
+                                         ws2812b->symbols,
+                                         WS2812B_FRAME_SYMBOLS(ws2812b->tx_pixel_num) * sizeof(rmt_symbol_word_t),
+                                         &rmt_tx_config),
+                            TAG,
+                            "Failed to transmit");
+    } else {
+        ESP_RETURN_ON_ERROR(
+            rmt_transmit(ws2812b->rmt_channel, ws2812b->rmt_encoder, ws2812b->tx_buffer, ws2812b->tx_pixel_num * 3, &rmt_tx_config),
+            TAG,
+            "Failed to transmit");
+    }
+    ws2812b->staged = false;
 
     return ESP_OK;
 }
@@ -208,11 +470,22 @@ esp_err_t ws2812b_del(ws2812b_handle_t* ws2812b) {
             ESP_LOGE(TAG, "Failed to delete RMT encoder");
         }
     }
+    if(dev->image_encoder) {
+        if(rmt_del_encoder(dev->image_encoder) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to delete RMT image encoder");
+        }
+    }
 
     // 4. Free Memory
+    free(dev->symbols);
+    free(dev->error);
+    free(dev->pixels);
     if(dev->buffer) {
         free(dev->buffer);
     }
+    if(dev->tx_buffer) {
+        free(dev->tx_buffer);
+    }
 
     free(dev);
 
@@ -228,27 +501,46 @@ esp_err_t ws2812b_fill(ws2812b_handle_t ws2812b, uint8_t red, uint8_t green, uin
     ESP_RETURN_ON_FALSE(ws2812b, ESP_ERR_INVALID_ARG, TAG, "Handle is NULL");
 
     // Defensive check: Ensure buffer was allocated
-    ESP_RETURN_ON_FALSE(ws2812b->buffer, ESP_ERR_INVALID_STATE, TAG, "Buffer is NULL");
+    ESP_RETURN_ON_FALSE(ws2812b->pixels, ESP_ERR_INVALID_STATE, TAG, "Buffer is NULL");
 
     // 2. Optimization check
     // If all colors are 0 (turning off), memset is significantly faster than a loop
     if(red == 0 && green == 0 && blue == 0) {
-        memset(ws2812b->buffer, 0, ws2812b->pixel_num * 3);
+        memset(ws2812b->pixels, 0, ws2812b->pixel_num * 3);
+        ws2812b->power_sum = 0;
+        ws2812b->dirty_num = ws2812b->pixel_num;
         return ESP_OK;
     }
 
     // 3. Fill Buffer
     // Loop unrolling or pointer arithmetic could optimize this, but compiler usually handles it well.
-    uint8_t* ptr = ws2812b->buffer;
+    uint8_t* ptr = ws2812b->pixels;
     for(int i = 0; i < ws2812b->pixel_num; i++) {
         *ptr++ = green;  // G
         *ptr++ = red;    // R
         *ptr++ = blue;   // B
     }
 
+    const uint16_t* lut16 = output_lut_get16(OUTPUT_LUT_WS2812B);
+    ws2812b->power_sum = (uint32_t)ws2812b->pixel_num * (lut16[green] + lut16[red] + lut16[blue]);
+    ws2812b->dirty_num = ws2812b->pixel_num;
+
     return ESP_OK;
 }
 
+void ws2812b_refresh(ws2812b_handle_t ws2812b) {
+    if(ws2812b) {
+        ws2812b->power_sum = ws2812b_level_sum(ws2812b, 0, ws2812b->pixel_num * 3);
+        ws2812b->dirty_num = ws2812b->pixel_num;
+    }
+}
+
+void ws2812b_set_scale(ws2812b_handle_t ws2812b, uint16_t scale) {
+    if(ws2812b) {
+        ws2812b->scale = scale;
+    }
+}
+
 esp_err_t ws2812b_wait_done(ws2812b_handle_t ws2812b) {
     // 1. Safety Check
     ESP_RETURN_ON_FALSE(ws2812b, ESP_ERR_INVALID_ARG, TAG, "Handle is NULL");
@@ -278,22 +570,33 @@ esp_err_t ws2812b_print_buffer(ws2812b_handle_t ws2812b) {
 }
 
 esp_err_t ws2812b_get_pixel(ws2812b_handle_t ws2812b, int pixel_idx, uint8_t* red, uint8_t* green, uint8_t* blue) {
-    if(!ws2812b || !ws2812b->buffer || pixel_idx < 0 || pixel_idx >= ws2812b->pixel_num) {
+    if(!ws2812b || !ws2812b->pixels || pixel_idx < 0 || pixel_idx >= ws2812b->pixel_num) {
         return ESP_ERR_INVALID_ARG;
     }
-    // GRB mapping
-    *green = ws2812b->buffer[pixel_idx * 3 + 0];
-    *red = ws2812b->buffer[pixel_idx * 3 + 1];
-    *blue = ws2812b->buffer[pixel_idx * 3 + 2];
+    // GRB mapping, colours as written
+    *green = ws2812b->pixels[pixel_idx * 3 + 0];
+    *red = ws2812b->pixels[pixel_idx * 3 + 1];
+    *blue = ws2812b->pixels[pixel_idx * 3 + 2];
     return ESP_OK;
 }
 
+uint32_t ws2812b_take_irq_count(ws2812b_handle_t ws2812b) {
+    if(ws2812b == NULL) {
+        return 0;
+    }
+
+    uint32_t calls = rmt_encoder_get_calls(ws2812b->rmt_encoder) + rmt_encoder_get_calls(ws2812b->image_encoder);
+    uint32_t count = calls - ws2812b->irq_seen;
+    ws2812b->irq_seen = calls;
+    return count;
+}
+
 void ws2812b_test() {
     ws2812b_handle_t ws2812b[WS2812B_NUM];
     uint8_t pixel_num = 10;
 
     for(int idx = 0; idx < WS2812B_NUM; idx++) {
-        ws2812b_init(BOARD_HW_CONFIG.rmt_pins[idx], pixel_num, &ws2812b[idx]);
+        ws2812b_init(BOARD_HW_CONFIG.rmt_pins[idx], pixel_num, NULL, &ws2812b[idx]);
     }
 
     uint8_t r[3] = {15, 0, 0};
@@ -332,7 +635,7 @@ void ws2812b_test2() {
     for(int idx = 0; idx < WS2812B_NUM; idx++) {
         gpio_num_t pin = BOARD_HW_CONFIG.rmt_pins[idx];
 
-        ret = ws2812b_init(pin, TEST_PIXEL_NUM, &ws2812b[idx]);
+        ret = ws2812b_init(pin, TEST_PIXEL_NUM, NULL, &ws2812b[idx]);
 
         if(ret != ESP_OK) {
             ESP_LOGE(TAG_WS_TEST, "Strip [%d] (GPIO %d) Init Failed!", idx, pin);
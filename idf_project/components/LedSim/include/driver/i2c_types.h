@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    I2C_NUM_0 = 0,
+    I2C_NUM_1 = 1,
+    I2C_NUM_MAX,
+} i2c_port_num_t;
+
+typedef enum {
+    I2C_ADDR_BIT_LEN_7 = 0,
+} i2c_addr_bit_len_t;
+
+typedef enum {
+    I2C_CLK_SRC_APB = 4,
+    I2C_CLK_SRC_DEFAULT = I2C_CLK_SRC_APB,
+} i2c_clock_source_t;
+
+typedef enum {
+    I2C_EVENT_ALIVE,   /*!< Bus is alive */
+    I2C_EVENT_DONE,    /*!< Transaction finished */
+    I2C_EVENT_NACK,    /*!< Device did not acknowledge */
+    I2C_EVENT_TIMEOUT, /*!< Bus timed out */
+} i2c_master_event_t;
+
+typedef struct i2c_master_bus_t* i2c_master_bus_handle_t;
+typedef struct i2c_master_dev_t* i2c_master_dev_handle_t;
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "driver/rmt_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct rmt_encoder_t rmt_encoder_t;
+typedef rmt_encoder_t* rmt_encoder_handle_t;
+
+typedef enum {
+    RMT_ENCODING_RESET = 0,         /*!< The encoding session is in reset state */
+    RMT_ENCODING_COMPLETE = 1 << 0, /*!< The encoding session is finished */
+    RMT_ENCODING_MEM_FULL = 1 << 1, /*!< No free space in the channel memory */
+} rmt_encode_state_t;
+
+/**
+ * @brief Encoder interface, identical to ESP-IDF so custom encoders run unchanged.
+ */
+struct rmt_encoder_t {
+    size_t (*encode)(rmt_encoder_t* encoder, rmt_channel_handle_t tx_channel, const void* primary_data, size_t data_size, rmt_encode_state_t* ret_state);
+    esp_err_t (*reset)(rmt_encoder_t* encoder);
+    esp_err_t (*del)(rmt_encoder_t* encoder);
+};
+
+typedef struct {
+    rmt_symbol_word_t bit0; /*!< Symbol for a 0 bit */
+    rmt_symbol_word_t bit1; /*!< Symbol for a 1 bit */
+    struct {
+        uint32_t msb_first : 1; /*!< Encode the most significant bit first */
+    } flags;
+} rmt_bytes_encoder_config_t;
+
+typedef struct {
+} rmt_copy_encoder_config_t;
+
+/**
+ * @brief Fills `symbols` (at most `symbols_free`) with the data following `symbols_written`; sets `done` after the last symbol.
+ *
+ * @return Symbols written, 0 if the callback needs more free space.
+ */
+typedef size_t (*rmt_encode_simple_cb_t)(const void* data, size_t data_size, size_t symbols_written, size_t symbols_free, rmt_symbol_word_t* symbols, bool* done, void* arg);
+
+typedef struct {
+    rmt_encode_simple_cb_t callback;
+    void* arg;
+    size_t min_chunk_size; /*!< Free space the callback always makes progress with (0 = 64) */
+} rmt_simple_encoder_config_t;
+
+esp_err_t rmt_new_bytes_encoder(const rmt_bytes_encoder_config_t* config, rmt_encoder_handle_t* ret_encoder);
+esp_err_t rmt_new_copy_encoder(const rmt_copy_encoder_config_t* config, rmt_encoder_handle_t* ret_encoder);
+esp_err_t rmt_new_simple_encoder(const rmt_simple_encoder_config_t* config, rmt_encoder_handle_t* ret_encoder);
+esp_err_t rmt_del_encoder(rmt_encoder_handle_t encoder);
+esp_err_t rmt_encoder_reset(rmt_encoder_handle_t encoder);
+
+#ifdef __cplusplus
+}
+#endif
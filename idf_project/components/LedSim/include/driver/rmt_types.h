@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct rmt_channel_t* rmt_channel_handle_t;
+typedef struct rmt_sync_manager_t* rmt_sync_manager_handle_t;
+
+/**
+ * @brief One RMT symbol: two (level, duration) pairs, same layout as the hardware.
+ */
+typedef union {
+    struct {
+        uint16_t duration0 : 15; /*!< Duration of level0 */
+        uint16_t level0 : 1;     /*!< Level of the first part */
+        uint16_t duration1 : 15; /*!< Duration of level1 */
+        uint16_t level1 : 1;     /*!< Level of the second part */
+    };
+    uint32_t val;
+} rmt_symbol_word_t;
+
+typedef enum {
+    RMT_CLK_SRC_APB = 4,
+    RMT_CLK_SRC_DEFAULT = RMT_CLK_SRC_APB,
+} rmt_clock_source_t;
+
+typedef struct {
+    size_t num_symbols; /*!< Symbols sent by the finished transaction */
+} rmt_tx_done_event_data_t;
+
+typedef bool (*rmt_tx_done_callback_t)(rmt_channel_handle_t tx_chan, const rmt_tx_done_event_data_t* edata, void* user_ctx);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "driver/gpio.h"
+#include "driver/rmt_encoder.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Traffic seen on one simulated WS2812B wire (one GPIO).
+ */
+typedef struct {
+    uint32_t transactions;  /*!< rmt_transmit() calls */
+    uint32_t frames;        /*!< Frames latched by a reset pulse (>= 50 us low) */
+    uint32_t encode_calls;  /*!< Calls into the encoder */
+    uint32_t refills;       /*!< Channel memory refills, one per half memory block sent (threshold interrupts) */
+    uint32_t timing_errors; /*!< Bits outside the WS2812B T0H/T1H/period windows */
+    uint64_t symbols;       /*!< Symbols put on the wire */
+    uint64_t bytes;         /*!< Bytes decoded from the waveform */
+    uint64_t wire_us;       /*!< Modelled wire time */
+    int64_t start_us;       /*!< Modelled start of the last transaction on the wire */
+} led_sim_rmt_stats_t;
+
+/**
+ * @brief Traffic seen by one simulated I2C target address.
+ */
+typedef struct {
+    uint32_t transfers; /*!< Write transactions addressed to the target */
+    uint32_t nacks;     /*!< Transactions that were not acknowledged */
+    uint64_t bytes;     /*!< Payload bytes accepted */
+    uint64_t wire_us;   /*!< Modelled wire time */
+} led_sim_i2c_stats_t;
+
+/**
+ * @brief Clears all statistics, recorded frames and injected faults.
+ */
+void led_sim_reset(void);
+
+/**
+ * @brief Makes waits block until the modelled wire time has elapsed.
+ *
+ * Disabled by default: wire time is only accounted, so show() can be
+ * benchmarked for CPU cost and the wire-bound frame rate read from the stats.
+ * Switching it on starts from an idle wire; time accounted before is dropped.
+ */
+void led_sim_set_realtime(bool realtime);
+
+/**
+ * @brief Returns the traffic statistics of the WS2812B strip on `gpio_num`.
+ */
+esp_err_t led_sim_rmt_get_stats(gpio_num_t gpio_num, led_sim_rmt_stats_t* stats);
+
+/**
+ * @brief Copies the bytes of the last latched frame on `gpio_num` (GRB, as decoded from the waveform).
+ *
+ * Like a real strip, a frame shorter than the previous ones only replaces their first bytes.
+ *
+ * @return Number of bytes in the frame (may exceed `size`, only `size` bytes are copied).
+ */
+size_t led_sim_rmt_get_frame(gpio_num_t gpio_num, uint8_t* data, size_t size);
+
+/**
+ * @brief Runs `encoder` over a payload against a scratch channel memory, without a wire.
+ *
+ * Uses the same fill / half-refill pattern as rmt_transmit(), so encoders can be
+ * compared and benchmarked in isolation.
+ *
+ * @param[out] out       Optional copy of the produced symbols (at most `out_size`).
+ *
+ * @return Symbols produced, 0 if the encoder failed to make progress.
+ */
+size_t led_sim_rmt_encode(rmt_encoder_handle_t encoder, const void* payload, size_t payload_bytes, size_t mem_block_symbols, rmt_symbol_word_t* out, size_t out_size);
+
+/**
+ * @brief Returns the traffic statistics of the I2C target at `addr`.
+ */
+esp_err_t led_sim_i2c_get_stats(uint8_t addr, led_sim_i2c_stats_t* stats);
+
+/**
+ * @brief Reads a register of the simulated target at `addr`.
+ *
+ * Targets model auto-incrementing register files: the first byte of a write is
+ * the register address (bit 7 = auto-increment), the following bytes are data.
+ */
+uint8_t led_sim_i2c_get_reg(uint8_t addr, uint8_t reg);
+
+/**
+ * @brief Makes the target at `addr` also take the writes sent to `group_addr` (e.g. an ALLCALL address).
+ */
+void led_sim_i2c_join_group(uint8_t group_addr, uint8_t addr);
+
+/**
+ * @brief Fastest SCL clock the simulated wiring passes (0 = any); faster transfers corrupt their data bytes.
+ */
+void led_sim_i2c_set_max_speed(uint32_t hz);
+
+/**
+ * @brief NACKs the next `count` transactions to `addr` (LED_SIM_NACK_FOREVER: target absent).
+ */
+void led_sim_i2c_inject_nack(uint8_t addr, uint32_t count);
+
+#define LED_SIM_NACK_FOREVER UINT32_MAX
+
+/**
+ * @brief Makes a target hold the wire on `pin` low until it has seen `clocks`
+ *        rising edges on `clock_pin` (0 releases it), like an I2C target
+ *        stuck mid-byte holding SDA.
+ *
+ * I2C transfers on a bus whose SDA is held time out without reaching any target.
+ */
+void led_sim_gpio_hold_low(gpio_num_t pin, gpio_num_t clock_pin, uint32_t clocks);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,103 @@
+#include "driver/gpio.h"
+
+#include <string.h>
+
+#include "esp_check.h"
+
+#include "led_sim.h"
+#include "led_sim_priv.h"
+
+/*
+ * Simulated GPIO: every pin is an open-drain wire with a pull-up. The only
+ * behaviour modelled is what I2C bus recovery needs: a target can hold a wire
+ * low until it has seen a number of clock pulses on another pin.
+ */
+
+typedef struct {
+    bool driven_low;      /*!< The pin itself pulls the wire low */
+    int8_t clock_pin;     /*!< Pin whose rising edges count down hold_clocks */
+    uint32_t hold_clocks; /*!< Rising edges left until a target releases the wire */
+} sim_pin_t;
+
+static const char* TAG = "gpio_sim";
+
+static sim_pin_t pins[GPIO_NUM_MAX];
+
+void gpio_sim_reset(void) {
+    sim_lock();
+    memset(pins, 0, sizeof(pins));
+    sim_unlock();
+}
+
+void led_sim_gpio_hold_low(gpio_num_t pin, gpio_num_t clock_pin, uint32_t clocks) {
+    if(!GPIO_IS_VALID_GPIO(pin) || !GPIO_IS_VALID_GPIO(clock_pin)) {
+        return;
+    }
+    sim_lock();
+    pins[pin].clock_pin = clock_pin;
+    pins[pin].hold_clocks = clocks;
+    sim_unlock();
+}
+
+bool sim_gpio_held_low(int pin) {
+    bool held;
+
+    if(pin < 0 || pin >= GPIO_NUM_MAX) {
+        return false;
+    }
+    sim_lock();
+    held = pins[pin].hold_clocks > 0;
+    sim_unlock();
+    return held;
+}
+
+esp_err_t gpio_config(const gpio_config_t* config) {
+    ESP_RETURN_ON_FALSE(config && config->pin_bit_mask < (1ULL << GPIO_NUM_MAX), ESP_ERR_INVALID_ARG, TAG, "Invalid pin mask");
+
+    sim_lock();
+    for(int pin = 0; pin < GPIO_NUM_MAX; pin++) {
+        if(config->pin_bit_mask & (1ULL << pin)) {
+            pins[pin].driven_low = false;
+        }
+    }
+    sim_unlock();
+    return ESP_OK;
+}
+
+esp_err_t gpio_reset_pin(gpio_num_t gpio_num) {
+    ESP_RETURN_ON_FALSE(GPIO_IS_VALID_GPIO(gpio_num), ESP_ERR_INVALID_ARG, TAG, "Invalid pin");
+
+    sim_lock();
+    pins[gpio_num].driven_low = false;
+    sim_unlock();
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level) {
+    ESP_RETURN_ON_FALSE(GPIO_IS_VALID_OUTPUT_GPIO(gpio_num), ESP_ERR_INVALID_ARG, TAG, "Invalid output pin");
+
+    sim_lock();
+    // A released wire rises: a clock pulse for the targets counting on this pin
+    if(pins[gpio_num].driven_low && level) {
+        for(int pin = 0; pin < GPIO_NUM_MAX; pin++) {
+            if(pins[pin].hold_clocks > 0 && pins[pin].clock_pin == gpio_num) {
+                pins[pin].hold_clocks--;
+            }
+        }
+    }
+    pins[gpio_num].driven_low = !level;
+    sim_unlock();
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio_num) {
+    int level;
+
+    if(!GPIO_IS_VALID_GPIO(gpio_num)) {
+        return 0;
+    }
+    sim_lock();
+    level = !(pins[gpio_num].driven_low || pins[gpio_num].hold_clocks > 0);
+    sim_unlock();
+    return level;
+}
@@ -0,0 +1,421 @@
+#include "driver/i2c_master.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_check.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+
+#include "led_sim.h"
+#include "led_sim_priv.h"
+
+/*
+ * Simulated I2C master: every write is applied to a register-file model of the
+ * addressed target and timed as (address + payload) * 9 clocks + start/stop at
+ * the device's scl_speed_hz. Transfers on one bus are serialised. In async mode
+ * (trans_queue_depth > 0) completions are delivered from a worker task at the
+ * modelled end of each transfer, through the registered on_trans_done callback.
+ * Writes to a group address land in every present target of the group wired
+ * to the same controller too.
+ * Above the bus speed limit every data byte has a bit flipped, like a bus whose
+ * pull-ups are too weak for the clock. While a target holds SDA low (see
+ * led_sim_gpio_hold_low()) every transfer on the bus times out.
+ */
+
+#define SIM_I2C_ADDR_NUM 128
+#define SIM_I2C_REG_NUM 128
+#define SIM_I2C_AUTO_INC 0x80
+
+typedef struct {
+    led_sim_i2c_stats_t stats;
+    uint8_t regs[SIM_I2C_REG_NUM];
+    uint32_t nack_count; /*!< Transactions left to NACK */
+    uint8_t group_addr;  /*!< Broadcast address the target also listens to, 0 = none */
+    i2c_port_num_t port; /*!< Controller the target was last attached to */
+} sim_target_t;
+
+struct i2c_master_bus_t {
+    i2c_port_num_t port;
+    gpio_num_t sda;
+    bool async;
+    int64_t busy_until_us; /*!< Modelled end of the last queued transfer */
+
+    QueueHandle_t done_queue; /*!< Completions waiting for their modelled time */
+    TaskHandle_t worker;
+    int pending;               /*!< Async transfers not completed yet (atomic) */
+    volatile bool worker_done; /*!< Worker has exited */
+    int dev_count;
+};
+
+struct i2c_master_dev_t {
+    i2c_master_bus_handle_t bus;
+    uint16_t addr;
+    uint32_t scl_speed_hz;
+    bool ack_check;
+
+    i2c_master_callback_t on_trans_done;
+    void* user_data;
+};
+
+typedef struct {
+    i2c_master_dev_handle_t dev; /*!< NULL stops the worker */
+    int64_t done_at_us;
+    i2c_master_event_t event;
+} sim_completion_t;
+
+static const char* TAG = "i2c_sim";
+
+static sim_target_t targets[SIM_I2C_ADDR_NUM];
+static uint32_t max_speed_hz; /*!< Fastest clock the simulated wiring passes, 0 = any */
+static i2c_master_bus_handle_t buses[I2C_NUM_MAX];
+
+// ================= Target model =================
+
+void i2c_sim_reset(void) {
+    sim_lock();
+    memset(targets, 0, sizeof(targets));
+    max_speed_hz = 0;
+    sim_unlock();
+}
+
+void i2c_sim_drop_backlog(void) {
+    sim_lock();
+    int64_t now = sim_now_us();
+    for(int i = 0; i < I2C_NUM_MAX; i++) {
+        if(buses[i] && buses[i]->busy_until_us > now) {
+            buses[i]->busy_until_us = now;
+        }
+    }
+    sim_unlock();
+}
+
+esp_err_t led_sim_i2c_get_stats(uint8_t addr, led_sim_i2c_stats_t* stats) {
+    ESP_RETURN_ON_FALSE(addr < SIM_I2C_ADDR_NUM && stats, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+
+    sim_lock();
+    *stats = targets[addr].stats;
+    sim_unlock();
+    return ESP_OK;
+}
+
+uint8_t led_sim_i2c_get_reg(uint8_t addr, uint8_t reg) {
+    uint8_t value = 0;
+
+    if(addr < SIM_I2C_ADDR_NUM && reg < SIM_I2C_REG_NUM) {
+        sim_lock();
+        value = targets[addr].regs[reg];
+        sim_unlock();
+    }
+    return value;
+}
+
+void led_sim_i2c_inject_nack(uint8_t addr, uint32_t count) {
+    if(addr >= SIM_I2C_ADDR_NUM) {
+        return;
+    }
+    sim_lock();
+    targets[addr].nack_count = count;
+    sim_unlock();
+}
+
+void led_sim_i2c_join_group(uint8_t group_addr, uint8_t addr) {
+    if(addr >= SIM_I2C_ADDR_NUM || group_addr >= SIM_I2C_ADDR_NUM) {
+        return;
+    }
+    sim_lock();
+    targets[addr].group_addr = group_addr;
+    sim_unlock();
+}
+
+void led_sim_i2c_set_max_speed(uint32_t hz) {
+    sim_lock();
+    max_speed_hz = hz;
+    sim_unlock();
+}
+
+/**
+ * @brief Bits flipped in every data byte of a transfer clocked faster than the wiring passes.
+ *
+ * Writes and reads flip different bits, so a readback cannot undo the damage.
+ */
+static uint8_t garble_mask(i2c_master_dev_handle_t dev, uint8_t bits) {
+    return max_speed_hz != 0 && dev->scl_speed_hz > max_speed_hz ? bits : 0x00;
+}
+
+/**
+ * @brief Applies a write: the first byte selects the register, the rest is data.
+ */
+static void target_write(sim_target_t* target, const uint8_t* data, size_t size, uint8_t garble) {
+    uint8_t reg = data[0] & (SIM_I2C_REG_NUM - 1);
+    for(size_t i = 1; i < size; i++) {
+        target->regs[reg] = data[i] ^ garble;
+        if(data[0] & SIM_I2C_AUTO_INC) {
+            reg = (reg + 1) & (SIM_I2C_REG_NUM - 1);
+        }
+    }
+}
+
+/**
+ * @brief Runs one write transaction against the target model.
+ *
+ * @param[out] done_at_us Modelled completion time.
+ * @return I2C_EVENT_DONE, I2C_EVENT_NACK or I2C_EVENT_TIMEOUT.
+ */
+static i2c_master_event_t sim_transfer(i2c_master_dev_handle_t dev, const uint8_t* data, size_t size, int64_t* done_at_us) {
+    i2c_master_event_t event = I2C_EVENT_DONE;
+    size_t wire_bytes = 1 + size;  // Address byte + payload
+    bool sda_stuck = sim_gpio_held_low(dev->bus->sda);
+
+    sim_lock();
+    sim_target_t* target = &targets[dev->addr & (SIM_I2C_ADDR_NUM - 1)];
+    target->stats.transfers++;
+
+    // 1. Stuck SDA: no START condition, the controller gives up after the address byte time
+    if(sda_stuck) {
+        wire_bytes = 1;
+        event = I2C_EVENT_TIMEOUT;
+    } else if(target->nack_count > 0) {
+        // NACK: the transaction stops after the address byte
+        if(target->nack_count != LED_SIM_NACK_FOREVER) {
+            target->nack_count--;
+        }
+        target->stats.nacks++;
+        wire_bytes = 1;
+        event = I2C_EVENT_NACK;
+    } else if(size > 0) {
+        // 2. ACK: the target and the present members of its group take the write
+        target_write(target, data, size, garble_mask(dev, 0x01));
+        target->stats.bytes += size;
+        for(int addr = 0; addr < SIM_I2C_ADDR_NUM; addr++) {
+            if(addr != dev->addr && targets[addr].group_addr == dev->addr && targets[addr].port == dev->bus->port &&
+               targets[addr].nack_count != LED_SIM_NACK_FOREVER) {
+                target_write(&targets[addr], data, size, garble_mask(dev, 0x01));
+            }
+        }
+    }
+
+    // 3. Wire time: 9 clocks per byte (8 data + ACK) plus start and stop
+    int64_t wire_us = (int64_t)(wire_bytes * 9 + 2) * 1000000 / dev->scl_speed_hz;
+    target->stats.wire_us += wire_us;
+
+    int64_t now = sim_now_us();
+    int64_t start = dev->bus->busy_until_us > now ? dev->bus->busy_until_us : now;
+    dev->bus->busy_until_us = start + wire_us;
+    *done_at_us = dev->bus->busy_until_us;
+    sim_unlock();
+
+    return event;
+}
+
+// ================= Bus =================
+
+static void i2c_sim_worker(void* arg) {
+    i2c_master_bus_handle_t bus = (i2c_master_bus_handle_t)arg;
+    sim_completion_t completion;
+
+    while(xQueueReceive(bus->done_queue, &completion, portMAX_DELAY) == pdTRUE) {
+        if(completion.dev == NULL) {
+            break;
+        }
+
+        sim_wait_until(completion.done_at_us, -1);
+        if(completion.dev->on_trans_done) {
+            i2c_master_event_data_t evt_data = {.event = completion.event};
+            completion.dev->on_trans_done(completion.dev, &evt_data, completion.dev->user_data);
+        }
+        __atomic_sub_fetch(&bus->pending, 1, __ATOMIC_SEQ_CST);
+    }
+
+    bus->worker_done = true;
+    vTaskDelete(NULL);
+}
+
+esp_err_t i2c_new_master_bus(const i2c_master_bus_config_t* bus_config, i2c_master_bus_handle_t* ret_bus_handle) {
+    ESP_RETURN_ON_FALSE(bus_config && ret_bus_handle, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    ESP_RETURN_ON_FALSE(bus_config->i2c_port < I2C_NUM_MAX, ESP_ERR_INVALID_ARG, TAG, "Invalid port %d", bus_config->i2c_port);
+    ESP_RETURN_ON_FALSE(bus_config->sda_io_num != bus_config->scl_io_num, ESP_ERR_INVALID_ARG, TAG, "SDA and SCL on the same pin");
+
+    i2c_master_bus_handle_t bus = (i2c_master_bus_handle_t)calloc(1, sizeof(struct i2c_master_bus_t));
+    ESP_RETURN_ON_FALSE(bus, ESP_ERR_NO_MEM, TAG, "No memory for bus");
+
+    bus->port = bus_config->i2c_port;
+    bus->sda = bus_config->sda_io_num;
+    bus->async = bus_config->trans_queue_depth > 0;
+
+    if(bus->async) {
+        bus->done_queue = xQueueCreate(bus_config->trans_queue_depth + 1, sizeof(sim_completion_t));
+        if(bus->done_queue == NULL || xTaskCreate(i2c_sim_worker, "i2c_sim", 4096, bus, 10, &bus->worker) != pdPASS) {
+            if(bus->done_queue) {
+                vQueueDelete(bus->done_queue);
+            }
+            free(bus);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    sim_lock();
+    buses[bus->port] = bus;
+    sim_unlock();
+    *ret_bus_handle = bus;
+    return ESP_OK;
+}
+
+esp_err_t i2c_del_master_bus(i2c_master_bus_handle_t bus) {
+    ESP_RETURN_ON_FALSE(bus, ESP_ERR_INVALID_ARG, TAG, "Bus is NULL");
+    ESP_RETURN_ON_FALSE(bus->dev_count == 0, ESP_ERR_INVALID_STATE, TAG, "Devices still attached");
+
+    if(bus->async) {
+        sim_completion_t stop = {.dev = NULL};
+        xQueueSend(bus->done_queue, &stop, portMAX_DELAY);
+        while(!bus->worker_done) {
+            vTaskDelay(1);
+        }
+        vQueueDelete(bus->done_queue);
+    }
+
+    sim_lock();
+    buses[bus->port] = NULL;
+    sim_unlock();
+    free(bus);
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_bus_add_device(i2c_master_bus_handle_t bus, const i2c_device_config_t* dev_config, i2c_master_dev_handle_t* ret_handle) {
+    ESP_RETURN_ON_FALSE(bus && dev_config && ret_handle, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    ESP_RETURN_ON_FALSE(dev_config->device_address < SIM_I2C_ADDR_NUM, ESP_ERR_INVALID_ARG, TAG, "Only 7-bit addresses are simulated");
+    ESP_RETURN_ON_FALSE(dev_config->scl_speed_hz > 0, ESP_ERR_INVALID_ARG, TAG, "Invalid SCL speed");
+
+    i2c_master_dev_handle_t dev = (i2c_master_dev_handle_t)calloc(1, sizeof(struct i2c_master_dev_t));
+    ESP_RETURN_ON_FALSE(dev, ESP_ERR_NO_MEM, TAG, "No memory for device");
+
+    dev->bus = bus;
+    dev->addr = dev_config->device_address;
+    dev->scl_speed_hz = dev_config->scl_speed_hz;
+    dev->ack_check = !dev_config->flags.disable_ack_check;
+    targets[dev->addr].port = bus->port;
+    bus->dev_count++;
+
+    *ret_handle = dev;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_bus_rm_device(i2c_master_dev_handle_t dev) {
+    ESP_RETURN_ON_FALSE(dev, ESP_ERR_INVALID_ARG, TAG, "Device is NULL");
+
+    dev->bus->dev_count--;
+    free(dev);
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_register_event_callbacks(i2c_master_dev_handle_t dev, const i2c_master_event_callbacks_t* cbs, void* user_data) {
+    ESP_RETURN_ON_FALSE(dev && cbs, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    ESP_RETURN_ON_FALSE(dev->bus->async, ESP_ERR_INVALID_STATE, TAG, "Callbacks require an async bus");
+
+    dev->on_trans_done = cbs->on_trans_done;
+    dev->user_data = user_data;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_transmit(i2c_master_dev_handle_t dev, const uint8_t* write_buffer, size_t write_size, int xfer_timeout_ms) {
+    int64_t done_at_us = 0;
+
+    ESP_RETURN_ON_FALSE(dev && write_buffer && write_size > 0, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+
+    // 1. Async: the completion is delivered by the worker at its modelled time
+    if(dev->bus->async) {
+        sim_completion_t completion = {.dev = dev};
+        completion.event = sim_transfer(dev, write_buffer, write_size, &done_at_us);
+        completion.done_at_us = done_at_us;
+        if(!dev->ack_check && completion.event == I2C_EVENT_NACK) {
+            completion.event = I2C_EVENT_DONE;
+        }
+
+        __atomic_add_fetch(&dev->bus->pending, 1, __ATOMIC_SEQ_CST);
+        if(xQueueSend(dev->bus->done_queue, &completion, pdMS_TO_TICKS(xfer_timeout_ms)) != pdTRUE) {
+            __atomic_sub_fetch(&dev->bus->pending, 1, __ATOMIC_SEQ_CST);
+            return ESP_ERR_TIMEOUT;
+        }
+        return ESP_OK;
+    }
+
+    // 2. Sync: block for the wire time
+    i2c_master_event_t event = sim_transfer(dev, write_buffer, write_size, &done_at_us);
+    if(!sim_wait_until(done_at_us, xfer_timeout_ms)) {
+        return ESP_ERR_TIMEOUT;
+    }
+    if(event == I2C_EVENT_TIMEOUT) {
+        return ESP_ERR_TIMEOUT;
+    }
+    if(event == I2C_EVENT_NACK && dev->ack_check) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_transmit_receive(i2c_master_dev_handle_t dev,
+                                      const uint8_t* write_buffer,
+                                      size_t write_size,
+                                      uint8_t* read_buffer,
+                                      size_t read_size,
+                                      int xfer_timeout_ms) {
+    int64_t done_at_us = 0;
+
+    ESP_RETURN_ON_FALSE(dev && write_buffer && write_size == 1 && read_buffer, ESP_ERR_INVALID_ARG, TAG, "Only register reads are simulated");
+    ESP_RETURN_ON_FALSE(!dev->bus->async, ESP_ERR_NOT_SUPPORTED, TAG, "Reads are simulated on synchronous buses only");
+
+    // 1. Register select (the read bytes after the repeated start are not timed)
+    i2c_master_event_t event = sim_transfer(dev, write_buffer, write_size, &done_at_us);
+
+    sim_lock();
+    sim_target_t* target = &targets[dev->addr & (SIM_I2C_ADDR_NUM - 1)];
+    uint8_t reg = write_buffer[0] & (SIM_I2C_REG_NUM - 1);
+    for(size_t i = 0; i < read_size; i++) {
+        read_buffer[i] = target->regs[reg] ^ garble_mask(dev, 0x02);
+        if(write_buffer[0] & SIM_I2C_AUTO_INC) {
+            reg = (reg + 1) & (SIM_I2C_REG_NUM - 1);
+        }
+    }
+    sim_unlock();
+
+    // 2. Block for the wire time
+    if(!sim_wait_until(done_at_us, xfer_timeout_ms)) {
+        return ESP_ERR_TIMEOUT;
+    }
+    if(event == I2C_EVENT_TIMEOUT) {
+        return ESP_ERR_TIMEOUT;
+    }
+    if(event == I2C_EVENT_NACK && dev->ack_check) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_probe(i2c_master_bus_handle_t bus, uint16_t address, int xfer_timeout_ms) {
+    ESP_RETURN_ON_FALSE(bus && address < SIM_I2C_ADDR_NUM, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+
+    sim_lock();
+    bool present = targets[address].nack_count != LED_SIM_NACK_FOREVER;
+    sim_unlock();
+    return present ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t i2c_master_bus_reset(i2c_master_bus_handle_t bus) {
+    ESP_RETURN_ON_FALSE(bus, ESP_ERR_INVALID_ARG, TAG, "Bus is NULL");
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_bus_wait_all_done(i2c_master_bus_handle_t bus, int timeout_ms) {
+    ESP_RETURN_ON_FALSE(bus, ESP_ERR_INVALID_ARG, TAG, "Bus is NULL");
+
+    TickType_t start = xTaskGetTickCount();
+    while(__atomic_load_n(&bus->pending, __ATOMIC_SEQ_CST) > 0) {
+        if(timeout_ms >= 0 && xTaskGetTickCount() - start > pdMS_TO_TICKS(timeout_ms)) {
+            return ESP_ERR_TIMEOUT;
+        }
+        vTaskDelay(1);
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,57 @@
+#include "led_sim.h"
+
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "led_sim_priv.h"
+
+static pthread_mutex_t sim_mutex = PTHREAD_MUTEX_INITIALIZER;
+static volatile bool sim_realtime = false;
+
+int64_t sim_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+bool sim_wait_until(int64_t deadline_us, int timeout_ms) {
+    // Accounting-only mode: the wire finishes instantly
+    if(!sim_realtime) {
+        return true;
+    }
+
+    int64_t remaining = deadline_us - sim_now_us();
+    if(remaining <= 0) {
+        return true;
+    }
+    if(timeout_ms >= 0 && remaining > (int64_t)timeout_ms * 1000) {
+        usleep(timeout_ms * 1000);
+        return false;
+    }
+    usleep(remaining);
+    return true;
+}
+
+void sim_lock(void) {
+    pthread_mutex_lock(&sim_mutex);
+}
+
+void sim_unlock(void) {
+    pthread_mutex_unlock(&sim_mutex);
+}
+
+void led_sim_reset(void) {
+    rmt_sim_reset();
+    i2c_sim_reset();
+    gpio_sim_reset();
+}
+
+void led_sim_set_realtime(bool realtime) {
+    // Accounted transfers queue up far ahead of the host clock, they are not waited for
+    if(realtime && !sim_realtime) {
+        rmt_sim_drop_backlog();
+        i2c_sim_drop_backlog();
+    }
+    sim_realtime = realtime;
+}
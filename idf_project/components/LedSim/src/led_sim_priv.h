@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef __containerof
+#define __containerof(ptr, type, member) ((type*)((char*)(ptr) - offsetof(type, member)))
+#endif
+
+/**
+ * @brief Monotonic host time in microseconds.
+ */
+int64_t sim_now_us(void);
+
+/**
+ * @brief Blocks until `deadline_us` in realtime mode; always succeeds immediately otherwise.
+ *
+ * @return false if the deadline is further away than `timeout_ms` (-1 waits forever).
+ */
+bool sim_wait_until(int64_t deadline_us, int timeout_ms);
+
+/**
+ * @brief Global lock shared by the simulated peripherals.
+ */
+void sim_lock(void);
+void sim_unlock(void);
+
+/**
+ * @brief True while a target holds the wire on `pin` low (see led_sim_gpio_hold_low()).
+ */
+bool sim_gpio_held_low(int pin);
+
+void rmt_sim_reset(void);
+void i2c_sim_reset(void);
+void gpio_sim_reset(void);
+
+/**
+ * @brief Moves every channel and bus that is modelled busy past now back to idle now.
+ */
+void rmt_sim_drop_backlog(void);
+void i2c_sim_drop_backlog(void);
@@ -0,0 +1,733 @@
+#include "driver/rmt_tx.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_check.h"
+#include "esp_log.h"
+
+#include "led_sim.h"
+#include "led_sim_priv.h"
+
+/*
+ * Simulated RMT TX: rmt_transmit() runs the encoder against a channel memory of
+ * mem_block_symbols, exactly like the driver's refill loop, and feeds every
+ * block to a WS2812B model on the channel's GPIO. The model decodes the
+ * waveform back into bytes, checks the bit timing and latches a frame on each
+ * reset pulse. Like the hardware, the first encoder call fills the whole
+ * channel memory and every refill only the half that has been sent, so
+ * refills match the interrupt count of the real driver.
+ *
+ * Channel memory comes from the ESP32 pool of SIM_RMT_BLOCK_NUM blocks; a
+ * channel occupies consecutive blocks starting at its own, and DMA is not
+ * available. Channels in a sync manager are armed by rmt_transmit() and all
+ * start on the wire when the last one of the group is armed.
+ */
+
+// WS2812B datasheet windows, in ns
+#define WS_T0H_MIN_NS 250
+#define WS_T0H_MAX_NS 550
+#define WS_T1H_MIN_NS 650
+#define WS_T1H_MAX_NS 950
+#define WS_BIT_MIN_NS 650
+#define WS_BIT_MAX_NS 1850
+#define WS_BIT_THRESHOLD_NS 600
+#define WS_RESET_NS 50000
+
+// ESP32 RMT memory
+#define SIM_RMT_BLOCK_SYMBOLS 64
+#define SIM_RMT_BLOCK_NUM 8
+
+/**
+ * @brief Strip attached to one GPIO. Outlives channel handles, like real hardware.
+ */
+typedef struct {
+    led_sim_rmt_stats_t stats;
+
+    uint8_t* frame; /*!< Bytes received since the last latch */
+    size_t frame_len;
+    size_t frame_cap;
+    uint8_t* latched; /*!< Last latched frame */
+    size_t latched_len;
+
+    uint8_t cur_byte; /*!< Bits received of the current byte */
+    int cur_bits;
+} sim_wire_t;
+
+struct rmt_channel_t {
+    gpio_num_t gpio_num;
+    uint32_t resolution_hz;
+    bool enabled;
+
+    int block_idx;          /*!< First memory block (= channel number) */
+    int block_num;          /*!< Memory blocks occupied */
+    rmt_symbol_word_t* mem; /*!< Simulated channel memory */
+    size_t mem_symbols;
+    size_t mem_pos;
+    size_t mem_limit; /*!< Symbols the current encoder call may write */
+
+    int64_t busy_until_us; /*!< Modelled end of the last transaction */
+    int64_t pending_us;    /*!< Wire time of the transaction waiting for its sync group */
+    rmt_sync_manager_handle_t sync;
+
+    rmt_tx_done_callback_t on_trans_done;
+    void* user_data;
+};
+
+struct rmt_sync_manager_t {
+    rmt_channel_handle_t channels[SIM_RMT_BLOCK_NUM];
+    size_t channel_num;
+    uint32_t armed_mask; /*!< Channels whose transaction waits for the rest of the group */
+    int64_t start_us;    /*!< Earliest time the group can start (all members idle) */
+};
+
+typedef struct {
+    rmt_encoder_t base;
+    rmt_bytes_encoder_config_t config;
+    size_t byte_pos;
+    int bit_pos;
+} sim_bytes_encoder_t;
+
+typedef struct {
+    rmt_encoder_t base;
+    size_t symbol_pos;
+} sim_copy_encoder_t;
+
+typedef struct {
+    rmt_encoder_t base;
+    rmt_simple_encoder_config_t config;
+    size_t symbols_written; /*!< Symbols produced so far in this transaction */
+} sim_simple_encoder_t;
+
+static const char* TAG = "rmt_sim";
+
+static sim_wire_t wires[GPIO_NUM_MAX];
+static bool blocks_used[SIM_RMT_BLOCK_NUM];
+static rmt_channel_handle_t channels[SIM_RMT_BLOCK_NUM]; /*!< Channel starting at each block */
+
+// ================= WS2812B model =================
+
+static void wire_push_byte(sim_wire_t* wire, uint8_t byte) {
+    if(wire->frame_len == wire->frame_cap) {
+        size_t cap = wire->frame_cap ? wire->frame_cap * 2 : 256;
+        uint8_t* frame = (uint8_t*)realloc(wire->frame, cap);
+        if(frame == NULL) {
+            return;
+        }
+        wire->frame = frame;
+        wire->frame_cap = cap;
+    }
+    wire->frame[wire->frame_len++] = byte;
+    wire->stats.bytes++;
+}
+
+static void wire_latch(sim_wire_t* wire) {
+    if(wire->cur_bits != 0) {
+        wire->stats.timing_errors++;  // Partial byte
+        wire->cur_bits = 0;
+    }
+    if(wire->frame_len == 0) {
+        return;
+    }
+
+    // Every pixel keeps the first 24 bits it sees, so a short frame only updates the first pixels
+    size_t len = wire->frame_len > wire->latched_len ? wire->frame_len : wire->latched_len;
+    uint8_t* latched = (uint8_t*)realloc(wire->latched, len);
+    if(latched != NULL) {
+        memcpy(latched, wire->frame, wire->frame_len);
+        wire->latched = latched;
+        wire->latched_len = len;
+    }
+    wire->frame_len = 0;
+    wire->stats.frames++;
+}
+
+/**
+ * @brief Puts a block of symbols on the wire.
+ *
+ * @return Wire time of the block in ns.
+ */
+static uint64_t wire_put_symbols(sim_wire_t* wire, uint32_t resolution_hz, const rmt_symbol_word_t* symbols, size_t num) {
+    uint64_t total_ns = 0;
+
+    for(size_t i = 0; i < num; i++) {
+        rmt_symbol_word_t sym = symbols[i];
+        uint32_t ns0 = (uint32_t)((uint64_t)sym.duration0 * 1000000000ULL / resolution_hz);
+        uint32_t ns1 = (uint32_t)((uint64_t)sym.duration1 * 1000000000ULL / resolution_hz);
+
+        if(ns0 == 0 && ns1 == 0) {
+            continue;
+        }
+        total_ns += ns0 + ns1;
+        wire->stats.symbols++;
+
+        // 1. High then low: one data bit
+        if(sym.level0 == 1 && sym.level1 == 0) {
+            int bit = ns0 >= WS_BIT_THRESHOLD_NS;
+            bool in_window = bit ? (ns0 >= WS_T1H_MIN_NS && ns0 <= WS_T1H_MAX_NS) : (ns0 >= WS_T0H_MIN_NS && ns0 <= WS_T0H_MAX_NS);
+            if(!in_window || ns0 + ns1 < WS_BIT_MIN_NS || (ns0 + ns1 > WS_BIT_MAX_NS && ns1 < WS_RESET_NS)) {
+                wire->stats.timing_errors++;
+            }
+
+            wire->cur_byte = (wire->cur_byte << 1) | bit;
+            if(++wire->cur_bits == 8) {
+                wire_push_byte(wire, wire->cur_byte);
+                wire->cur_bits = 0;
+            }
+            if(ns1 >= WS_RESET_NS) {
+                wire_latch(wire);
+            }
+            continue;
+        }
+
+        // 2. Low pulse: latches the frame if long enough
+        if(sym.level0 == 0 && (sym.level1 == 0 ? ns0 + ns1 : ns0) >= WS_RESET_NS) {
+            wire_latch(wire);
+            continue;
+        }
+
+        wire->stats.timing_errors++;  // Not a WS2812B waveform
+    }
+
+    return total_ns;
+}
+
+void rmt_sim_reset(void) {
+    sim_lock();
+    for(int i = 0; i < GPIO_NUM_MAX; i++) {
+        free(wires[i].frame);
+        free(wires[i].latched);
+        memset(&wires[i], 0, sizeof(sim_wire_t));
+    }
+    sim_unlock();
+}
+
+void rmt_sim_drop_backlog(void) {
+    sim_lock();
+    int64_t now = sim_now_us();
+    for(int i = 0; i < SIM_RMT_BLOCK_NUM; i++) {
+        // Armed sync members (INT64_MAX) still wait for their group
+        if(channels[i] && channels[i]->busy_until_us > now && channels[i]->busy_until_us != INT64_MAX) {
+            channels[i]->busy_until_us = now;
+        }
+    }
+    sim_unlock();
+}
+
+esp_err_t led_sim_rmt_get_stats(gpio_num_t gpio_num, led_sim_rmt_stats_t* stats) {
+    ESP_RETURN_ON_FALSE(GPIO_IS_VALID_GPIO(gpio_num) && stats, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+
+    sim_lock();
+    *stats = wires[gpio_num].stats;
+    sim_unlock();
+    return ESP_OK;
+}
+
+size_t led_sim_rmt_get_frame(gpio_num_t gpio_num, uint8_t* data, size_t size) {
+    size_t len = 0;
+
+    if(!GPIO_IS_VALID_GPIO(gpio_num)) {
+        return 0;
+    }
+
+    sim_lock();
+    len = wires[gpio_num].latched_len;
+    if(data) {
+        memcpy(data, wires[gpio_num].latched, len < size ? len : size);
+    }
+    sim_unlock();
+    return len;
+}
+
+// ================= Encoders =================
+
+static bool mem_put(rmt_channel_handle_t channel, rmt_symbol_word_t symbol) {
+    if(channel->mem_pos >= channel->mem_limit) {
+        return false;
+    }
+    channel->mem[channel->mem_pos++] = symbol;
+    return true;
+}
+
+static size_t bytes_encode(rmt_encoder_t* encoder, rmt_channel_handle_t channel, const void* data, size_t size, rmt_encode_state_t* ret_state) {
+    sim_bytes_encoder_t* enc = __containerof(encoder, sim_bytes_encoder_t, base);
+    const uint8_t* bytes = (const uint8_t*)data;
+    rmt_encode_state_t state = RMT_ENCODING_RESET;
+    size_t encoded = 0;
+
+    while(enc->byte_pos < size) {
+        int shift = enc->config.flags.msb_first ? 7 - enc->bit_pos : enc->bit_pos;
+        bool one = (bytes[enc->byte_pos] >> shift) & 1;
+        if(!mem_put(channel, one ? enc->config.bit1 : enc->config.bit0)) {
+            state |= RMT_ENCODING_MEM_FULL;
+            break;
+        }
+        encoded++;
+        if(++enc->bit_pos == 8) {
+            enc->bit_pos = 0;
+            enc->byte_pos++;
+        }
+    }
+
+    if(enc->byte_pos >= size) {
+        enc->byte_pos = 0;
+        enc->bit_pos = 0;
+        state |= RMT_ENCODING_COMPLETE;
+    }
+
+    *ret_state = state;
+    return encoded;
+}
+
+static esp_err_t bytes_reset(rmt_encoder_t* encoder) {
+    sim_bytes_encoder_t* enc = __containerof(encoder, sim_bytes_encoder_t, base);
+    enc->byte_pos = 0;
+    enc->bit_pos = 0;
+    return ESP_OK;
+}
+
+static esp_err_t bytes_del(rmt_encoder_t* encoder) {
+    free(__containerof(encoder, sim_bytes_encoder_t, base));
+    return ESP_OK;
+}
+
+static size_t copy_encode(rmt_encoder_t* encoder, rmt_channel_handle_t channel, const void* data, size_t size, rmt_encode_state_t* ret_state) {
+    sim_copy_encoder_t* enc = __containerof(encoder, sim_copy_encoder_t, base);
+    const rmt_symbol_word_t* symbols = (const rmt_symbol_word_t*)data;
+    size_t num = size / sizeof(rmt_symbol_word_t);
+    rmt_encode_state_t state = RMT_ENCODING_RESET;
+    size_t encoded = 0;
+
+    while(enc->symbol_pos < num) {
+        if(!mem_put(channel, symbols[enc->symbol_pos])) {
+            state |= RMT_ENCODING_MEM_FULL;
+            break;
+        }
+        enc->symbol_pos++;
+        encoded++;
+    }
+
+    if(enc->symbol_pos >= num) {
+        enc->symbol_pos = 0;
+        state |= RMT_ENCODING_COMPLETE;
+    }
+
+    *ret_state = state;
+    return encoded;
+}
+
+static esp_err_t copy_reset(rmt_encoder_t* encoder) {
+    __containerof(encoder, sim_copy_encoder_t, base)->symbol_pos = 0;
+    return ESP_OK;
+}
+
+static esp_err_t copy_del(rmt_encoder_t* encoder) {
+    free(__containerof(encoder, sim_copy_encoder_t, base));
+    return ESP_OK;
+}
+
+static size_t simple_encode(rmt_encoder_t* encoder, rmt_channel_handle_t channel, const void* data, size_t size, rmt_encode_state_t* ret_state) {
+    sim_simple_encoder_t* enc = __containerof(encoder, sim_simple_encoder_t, base);
+    rmt_encode_state_t state = RMT_ENCODING_RESET;
+    size_t encoded = 0;
+
+    // The callback writes straight into the channel memory until it is full or done
+    while(1) {
+        size_t free_symbols = channel->mem_limit - channel->mem_pos;
+        bool done = false;
+        size_t n = 0;
+
+        if(free_symbols > 0) {
+            n = enc->config.callback(data, size, enc->symbols_written, free_symbols, channel->mem + channel->mem_pos, &done, enc->config.arg);
+        }
+        if(n > free_symbols) {
+            ESP_LOGE(TAG, "Simple encoder callback overran the channel memory");
+            n = free_symbols;
+        }
+        channel->mem_pos += n;
+        enc->symbols_written += n;
+        encoded += n;
+
+        if(done) {
+            enc->symbols_written = 0;
+            state |= RMT_ENCODING_COMPLETE;
+            break;
+        }
+        if(n == 0) {
+            state |= RMT_ENCODING_MEM_FULL;
+            break;
+        }
+    }
+
+    *ret_state = state;
+    return encoded;
+}
+
+static esp_err_t simple_reset(rmt_encoder_t* encoder) {
+    __containerof(encoder, sim_simple_encoder_t, base)->symbols_written = 0;
+    return ESP_OK;
+}
+
+static esp_err_t simple_del(rmt_encoder_t* encoder) {
+    free(__containerof(encoder, sim_simple_encoder_t, base));
+    return ESP_OK;
+}
+
+esp_err_t rmt_new_bytes_encoder(const rmt_bytes_encoder_config_t* config, rmt_encoder_handle_t* ret_encoder) {
+    ESP_RETURN_ON_FALSE(config && ret_encoder, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+
+    sim_bytes_encoder_t* enc = (sim_bytes_encoder_t*)calloc(1, sizeof(sim_bytes_encoder_t));
+    ESP_RETURN_ON_FALSE(enc, ESP_ERR_NO_MEM, TAG, "No memory for bytes encoder");
+
+    enc->config = *config;
+    enc->base.encode = bytes_encode;
+    enc->base.reset = bytes_reset;
+    enc->base.del = bytes_del;
+    *ret_encoder = &enc->base;
+    return ESP_OK;
+}
+
+esp_err_t rmt_new_copy_encoder(const rmt_copy_encoder_config_t* config, rmt_encoder_handle_t* ret_encoder) {
+    ESP_RETURN_ON_FALSE(config && ret_encoder, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+
+    sim_copy_encoder_t* enc = (sim_copy_encoder_t*)calloc(1, sizeof(sim_copy_encoder_t));
+    ESP_RETURN_ON_FALSE(enc, ESP_ERR_NO_MEM, TAG, "No memory for copy encoder");
+
+    enc->base.encode = copy_encode;
+    enc->base.reset = copy_reset;
+    enc->base.del = copy_del;
+    *ret_encoder = &enc->base;
+    return ESP_OK;
+}
+
+esp_err_t rmt_new_simple_encoder(const rmt_simple_encoder_config_t* config, rmt_encoder_handle_t* ret_encoder) {
+    ESP_RETURN_ON_FALSE(config && config->callback && ret_encoder, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+
+    sim_simple_encoder_t* enc = (sim_simple_encoder_t*)calloc(1, sizeof(sim_simple_encoder_t));
+    ESP_RETURN_ON_FALSE(enc, ESP_ERR_NO_MEM, TAG, "No memory for simple encoder");
+
+    enc->config = *config;
+    if(enc->config.min_chunk_size == 0) {
+        enc->config.min_chunk_size = 64;
+    }
+    enc->base.encode = simple_encode;
+    enc->base.reset = simple_reset;
+    enc->base.del = simple_del;
+    *ret_encoder = &enc->base;
+    return ESP_OK;
+}
+
+esp_err_t rmt_del_encoder(rmt_encoder_handle_t encoder) {
+    ESP_RETURN_ON_FALSE(encoder, ESP_ERR_INVALID_ARG, TAG, "Encoder is NULL");
+    return encoder->del(encoder);
+}
+
+esp_err_t rmt_encoder_reset(rmt_encoder_handle_t encoder) {
+    ESP_RETURN_ON_FALSE(encoder, ESP_ERR_INVALID_ARG, TAG, "Encoder is NULL");
+    return encoder->reset(encoder);
+}
+
+size_t led_sim_rmt_encode(rmt_encoder_handle_t encoder, const void* payload, size_t payload_bytes, size_t mem_block_symbols, rmt_symbol_word_t* out, size_t out_size) {
+    struct rmt_channel_t channel = {0};
+    size_t symbols = 0;
+
+    if(encoder == NULL || payload == NULL || mem_block_symbols < 2) {
+        return 0;
+    }
+    channel.mem = (rmt_symbol_word_t*)calloc(mem_block_symbols, sizeof(rmt_symbol_word_t));
+    if(channel.mem == NULL) {
+        return 0;
+    }
+    channel.mem_symbols = mem_block_symbols;
+    channel.mem_limit = mem_block_symbols;
+
+    // Same refill loop as rmt_transmit(), without a wire behind it
+    rmt_encoder_reset(encoder);
+    while(1) {
+        rmt_encode_state_t state = RMT_ENCODING_RESET;
+        size_t encoded = encoder->encode(encoder, &channel, payload, payload_bytes, &state);
+
+        if(out && symbols < out_size) {
+            size_t n = channel.mem_pos < out_size - symbols ? channel.mem_pos : out_size - symbols;
+            memcpy(out + symbols, channel.mem, n * sizeof(rmt_symbol_word_t));
+        }
+        symbols += channel.mem_pos;
+        channel.mem_pos = 0;
+
+        if(state & RMT_ENCODING_COMPLETE) {
+            break;
+        }
+        if(!(state & RMT_ENCODING_MEM_FULL) || encoded == 0) {
+            symbols = 0;  // No progress
+            break;
+        }
+        channel.mem_limit = channel.mem_symbols / 2;
+    }
+
+    free(channel.mem);
+    return symbols;
+}
+
+// ================= TX Channel =================
+
+/**
+ * @brief Puts the pending transaction on the wire at `start_us`. Called with the lock held.
+ */
+static void channel_start(rmt_channel_handle_t channel, int64_t start_us) {
+    sim_wire_t* wire = &wires[channel->gpio_num];
+
+    channel->busy_until_us = start_us + channel->pending_us;
+    wire->stats.start_us = start_us;
+    wire->stats.wire_us += channel->pending_us;
+    channel->pending_us = 0;
+}
+
+/**
+ * @brief Arms a channel of a sync group; the last one starts them all. Called with the lock held.
+ */
+static void sync_arm(rmt_channel_handle_t channel, int64_t idle_us) {
+    rmt_sync_manager_handle_t sync = channel->sync;
+
+    for(size_t i = 0; i < sync->channel_num; i++) {
+        if(sync->channels[i] == channel) {
+            sync->armed_mask |= 1UL << i;
+        }
+    }
+    if(idle_us > sync->start_us) {
+        sync->start_us = idle_us;
+    }
+    channel->busy_until_us = INT64_MAX;  // Not done before the group starts
+
+    if(sync->armed_mask != (1UL << sync->channel_num) - 1) {
+        return;
+    }
+    for(size_t i = 0; i < sync->channel_num; i++) {
+        channel_start(sync->channels[i], sync->start_us);
+    }
+    sync->armed_mask = 0;
+    sync->start_us = 0;
+}
+
+esp_err_t rmt_new_tx_channel(const rmt_tx_channel_config_t* config, rmt_channel_handle_t* ret_chan) {
+    ESP_RETURN_ON_FALSE(config && ret_chan, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    ESP_RETURN_ON_FALSE(GPIO_IS_VALID_OUTPUT_GPIO(config->gpio_num), ESP_ERR_INVALID_ARG, TAG, "Invalid GPIO %d", config->gpio_num);
+    ESP_RETURN_ON_FALSE(config->resolution_hz > 0, ESP_ERR_INVALID_ARG, TAG, "Invalid resolution");
+    ESP_RETURN_ON_FALSE(config->mem_block_symbols >= SIM_RMT_BLOCK_SYMBOLS && config->mem_block_symbols % 2 == 0,
+                        ESP_ERR_INVALID_ARG,
+                        TAG,
+                        "mem_block_symbols must be even and >= %d",
+                        SIM_RMT_BLOCK_SYMBOLS);
+    ESP_RETURN_ON_FALSE(!config->flags.with_dma, ESP_ERR_NOT_SUPPORTED, TAG, "DMA not supported by the ESP32 RMT");
+
+    // 1. First channel whose own and following blocks are free
+    int block_num = (int)((config->mem_block_symbols + SIM_RMT_BLOCK_SYMBOLS - 1) / SIM_RMT_BLOCK_SYMBOLS);
+    int block_idx = -1;
+    sim_lock();
+    for(int i = 0; i + block_num <= SIM_RMT_BLOCK_NUM && block_idx < 0; i++) {
+        block_idx = i;
+        for(int j = i; j < i + block_num; j++) {
+            if(blocks_used[j]) {
+                block_idx = -1;
+                break;
+            }
+        }
+    }
+    if(block_idx >= 0) {
+        for(int j = block_idx; j < block_idx + block_num; j++) {
+            blocks_used[j] = true;
+        }
+    }
+    sim_unlock();
+    ESP_RETURN_ON_FALSE(block_idx >= 0, ESP_ERR_NOT_FOUND, TAG, "No free channel with %d memory blocks", block_num);
+
+    // 2. Channel
+    rmt_channel_handle_t channel = (rmt_channel_handle_t)calloc(1, sizeof(struct rmt_channel_t));
+    if(channel) {
+        channel->mem = (rmt_symbol_word_t*)calloc(block_num * SIM_RMT_BLOCK_SYMBOLS, sizeof(rmt_symbol_word_t));
+    }
+    if(channel == NULL || channel->mem == NULL) {
+        free(channel);
+        sim_lock();
+        for(int j = block_idx; j < block_idx + block_num; j++) {
+            blocks_used[j] = false;
+        }
+        sim_unlock();
+        return ESP_ERR_NO_MEM;
+    }
+
+    channel->gpio_num = config->gpio_num;
+    channel->resolution_hz = config->resolution_hz;
+    channel->block_idx = block_idx;
+    channel->block_num = block_num;
+    channel->mem_symbols = block_num * SIM_RMT_BLOCK_SYMBOLS;
+
+    sim_lock();
+    channels[block_idx] = channel;
+    sim_unlock();
+    *ret_chan = channel;
+    return ESP_OK;
+}
+
+esp_err_t rmt_del_channel(rmt_channel_handle_t channel) {
+    ESP_RETURN_ON_FALSE(channel, ESP_ERR_INVALID_ARG, TAG, "Channel is NULL");
+    ESP_RETURN_ON_FALSE(!channel->enabled, ESP_ERR_INVALID_STATE, TAG, "Channel not disabled");
+    ESP_RETURN_ON_FALSE(channel->sync == NULL, ESP_ERR_INVALID_STATE, TAG, "Channel still in a sync manager");
+
+    sim_lock();
+    for(int j = channel->block_idx; j < channel->block_idx + channel->block_num; j++) {
+        blocks_used[j] = false;
+    }
+    channels[channel->block_idx] = NULL;
+    sim_unlock();
+
+    free(channel->mem);
+    free(channel);
+    return ESP_OK;
+}
+
+esp_err_t rmt_enable(rmt_channel_handle_t channel) {
+    ESP_RETURN_ON_FALSE(channel, ESP_ERR_INVALID_ARG, TAG, "Channel is NULL");
+    ESP_RETURN_ON_FALSE(!channel->enabled, ESP_ERR_INVALID_STATE, TAG, "Channel already enabled");
+    channel->enabled = true;
+    return ESP_OK;
+}
+
+esp_err_t rmt_disable(rmt_channel_handle_t channel) {
+    ESP_RETURN_ON_FALSE(channel, ESP_ERR_INVALID_ARG, TAG, "Channel is NULL");
+    ESP_RETURN_ON_FALSE(channel->enabled, ESP_ERR_INVALID_STATE, TAG, "Channel not enabled");
+    channel->enabled = false;
+    return ESP_OK;
+}
+
+esp_err_t rmt_tx_register_event_callbacks(rmt_channel_handle_t channel, const rmt_tx_event_callbacks_t* cbs, void* user_data) {
+    ESP_RETURN_ON_FALSE(channel && cbs, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    channel->on_trans_done = cbs->on_trans_done;
+    channel->user_data = user_data;
+    return ESP_OK;
+}
+
+esp_err_t rmt_transmit(rmt_channel_handle_t channel, rmt_encoder_handle_t encoder, const void* payload, size_t payload_bytes, const rmt_transmit_config_t* config) {
+    esp_err_t ret = ESP_OK;
+    uint64_t wire_ns = 0;
+    size_t symbols = 0;
+
+    // 1. Validation
+    ESP_RETURN_ON_FALSE(channel && encoder && payload && config, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    ESP_RETURN_ON_FALSE(config->loop_count == 0, ESP_ERR_NOT_SUPPORTED, TAG, "Loop transmission not simulated");
+    ESP_RETURN_ON_FALSE(channel->enabled, ESP_ERR_INVALID_STATE, TAG, "Channel not enabled");
+
+    sim_lock();
+    sim_wire_t* wire = &wires[channel->gpio_num];
+    wire->stats.transactions++;
+
+    // 2. Refill loop: encode into the channel memory, then put it on the wire
+    // The first call fills the whole memory, every refill the half that was sent.
+    rmt_encoder_reset(encoder);
+    channel->mem_pos = 0;
+    channel->mem_limit = channel->mem_symbols;
+    while(1) {
+        rmt_encode_state_t state = RMT_ENCODING_RESET;
+        size_t encoded = encoder->encode(encoder, channel, payload, payload_bytes, &state);
+        wire->stats.encode_calls++;
+
+        wire_ns += wire_put_symbols(wire, channel->resolution_hz, channel->mem, channel->mem_pos);
+        symbols += channel->mem_pos;
+        channel->mem_pos = 0;
+
+        if(state & RMT_ENCODING_COMPLETE) {
+            break;
+        }
+        if((state & RMT_ENCODING_MEM_FULL) && encoded > 0) {
+            wire->stats.refills++;
+            channel->mem_limit = channel->mem_symbols / 2;
+            continue;
+        }
+        if(encoded == 0) {
+            ESP_LOGE(TAG, "Encoder on GPIO %d made no progress", channel->gpio_num);
+            ret = ESP_FAIL;
+            break;
+        }
+    }
+
+    // 3. Model the wire time; back-to-back transactions queue behind each other
+    int64_t now = sim_now_us();
+    int64_t idle = channel->busy_until_us > now ? channel->busy_until_us : now;
+    channel->pending_us = (int64_t)(wire_ns / 1000);
+    if(channel->sync == NULL) {
+        channel_start(channel, idle);
+    } else {
+        sync_arm(channel, idle);
+    }
+    sim_unlock();
+
+    // 4. Completion is reported as soon as the transaction has been encoded
+    if(ret == ESP_OK && channel->on_trans_done) {
+        rmt_tx_done_event_data_t edata = {.num_symbols = symbols};
+        channel->on_trans_done(channel, &edata, channel->user_data);
+    }
+
+    return ret;
+}
+
+esp_err_t rmt_tx_wait_all_done(rmt_channel_handle_t channel, int timeout_ms) {
+    ESP_RETURN_ON_FALSE(channel, ESP_ERR_INVALID_ARG, TAG, "Channel is NULL");
+    return sim_wait_until(channel->busy_until_us, timeout_ms) ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+// ================= Sync Manager =================
+
+esp_err_t rmt_new_sync_manager(const rmt_sync_manager_config_t* config, rmt_sync_manager_handle_t* ret_synchro) {
+    ESP_RETURN_ON_FALSE(config && ret_synchro && config->tx_channel_array, ESP_ERR_INVALID_ARG, TAG, "Invalid argument");
+    ESP_RETURN_ON_FALSE(config->array_size > 0 && config->array_size <= SIM_RMT_BLOCK_NUM, ESP_ERR_INVALID_ARG, TAG, "Invalid channel count");
+
+    for(size_t i = 0; i < config->array_size; i++) {
+        rmt_channel_handle_t channel = config->tx_channel_array[i];
+        ESP_RETURN_ON_FALSE(channel && channel->enabled, ESP_ERR_INVALID_STATE, TAG, "Channel %u must be enabled", (unsigned)i);
+        ESP_RETURN_ON_FALSE(channel->sync == NULL, ESP_ERR_INVALID_STATE, TAG, "Channel %u already synchronised", (unsigned)i);
+    }
+
+    rmt_sync_manager_handle_t sync = (rmt_sync_manager_handle_t)calloc(1, sizeof(struct rmt_sync_manager_t));
+    ESP_RETURN_ON_FALSE(sync, ESP_ERR_NO_MEM, TAG, "No memory for sync manager");
+
+    sim_lock();
+    for(size_t i = 0; i < config->array_size; i++) {
+        sync->channels[i] = config->tx_channel_array[i];
+        sync->channels[i]->sync = sync;
+    }
+    sync->channel_num = config->array_size;
+    sim_unlock();
+
+    *ret_synchro = sync;
+    return ESP_OK;
+}
+
+esp_err_t rmt_sync_reset(rmt_sync_manager_handle_t synchro) {
+    ESP_RETURN_ON_FALSE(synchro, ESP_ERR_INVALID_ARG, TAG, "Sync manager is NULL");
+
+    // Armed transactions are dropped
+    sim_lock();
+    int64_t now = sim_now_us();
+    for(size_t i = 0; i < synchro->channel_num; i++) {
+        if(synchro->armed_mask & (1UL << i)) {
+            synchro->channels[i]->busy_until_us = now;
+            synchro->channels[i]->pending_us = 0;
+        }
+    }
+    synchro->armed_mask = 0;
+    synchro->start_us = 0;
+    sim_unlock();
+    return ESP_OK;
+}
+
+esp_err_t rmt_del_sync_manager(rmt_sync_manager_handle_t synchro) {
+    ESP_RETURN_ON_FALSE(synchro, ESP_ERR_INVALID_ARG, TAG, "Sync manager is NULL");
+
+    rmt_sync_reset(synchro);
+    sim_lock();
+    for(size_t i = 0; i < synchro->channel_num; i++) {
+        synchro->channels[i]->sync = NULL;
+    }
+    sim_unlock();
+    free(synchro);
+    return ESP_OK;
+}
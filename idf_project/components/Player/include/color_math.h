@@ -0,0 +1,74 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Integer colour helpers for the render path.
+ *
+ * Everything works on 8-bit channels and GRB pixels like the frame buffers,
+ * so renderers never touch the FPU (float use in a task also makes FreeRTOS
+ * save the FPU context on every switch). Fractions are either 8-bit (255 = 1.0)
+ * or 8.8 fixed point (256 = 1.0), as noted per function.
+ */
+
+/**
+ * @brief `x * scale / 255`, rounded down; scale 255 keeps `x`, 0 gives 0.
+ */
+static inline uint8_t color_scale8(uint8_t x, uint8_t scale) {
+    return (uint8_t)((x * (scale + 1)) >> 8);
+}
+
+/**
+ * @brief Mixes `b` into `a` by an 8.8 fraction: 0 gives `a`, 256 gives `b`.
+ */
+static inline uint8_t color_blend8(uint8_t a, uint8_t b, uint16_t frac) {
+    return (uint8_t)((a * (256 - frac) + b * frac) >> 8);
+}
+
+/**
+ * @brief Mixes `b` into `a` by an 8-bit fraction: 0 gives `a`, 255 gives `b`.
+ */
+static inline uint8_t color_lerp8(uint8_t a, uint8_t b, uint8_t frac) {
+    return color_blend8(a, b, frac + (frac >> 7));
+}
+
+/**
+ * @brief color_blend8() on all three channels of a GRB pixel.
+ */
+static inline void color_blend_grb(const uint8_t* a, const uint8_t* b, uint16_t frac, uint8_t* out) {
+    out[0] = color_blend8(a[0], b[0], frac);
+    out[1] = color_blend8(a[1], b[1], frac);
+    out[2] = color_blend8(a[2], b[2], frac);
+}
+
+/**
+ * @brief Sine over a 256-step turn, -127 to 127.
+ *
+ * @param[in] theta Angle, 256 = one full turn.
+ */
+int8_t color_sin8(uint8_t theta);
+
+/**
+ * @brief Cosine over a 256-step turn, -127 to 127.
+ */
+static inline int8_t color_cos8(uint8_t theta) {
+    return color_sin8((uint8_t)(theta + 64));
+}
+
+/**
+ * @brief HSV to a GRB pixel, within 1 LSB of the float conversion.
+ *
+ * @param[in]  hue Hue, 256 = one turn of the colour wheel (0 red, 85 green, 171 blue).
+ * @param[in]  sat Saturation, 255 = fully saturated.
+ * @param[in]  val Value, 255 = full brightness.
+ * @param[out] grb Three bytes, GRB order.
+ */
+void color_hsv_to_grb(uint8_t hue, uint8_t sat, uint8_t val, uint8_t* grb);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdio.h>
+
+#include "esp_err.h"
+
+#include "LedController.hpp"
+#include "effect_format.h"
+
+/**
+ * @brief Evaluates effect cue lists (see effect_format.h) into a FrameTarget.
+ *
+ * The whole cue list is loaded at open(); render() then computes every channel
+ * for a show time from its active cue, so a show costs a few KB instead of a
+ * stored frame per tick. Cues are applied in order as the show time advances,
+ * a jump back replays them from the start. Channels running a static effect
+ * are written once per cue and left clean afterwards, so show() skips them.
+ */
+class EffectEngine {
+  public:
+    EffectEngine();
+    ~EffectEngine();
+
+    esp_err_t open(const char* path);
+    esp_err_t load(const ch_info_t& ch_info, uint8_t fps, const effect_cue_t* list, uint32_t cue_num);
+    void close();
+    bool is_open() const;
+
+    esp_err_t render(FrameTarget& target, uint32_t show_ms);
+    void rewind();
+
+    ch_info_t get_ch_info() const;
+    uint8_t get_fps() const;
+    uint32_t get_duration_ms() const;
+
+    static void render_pixels(const effect_params_t& params, uint32_t t_ms, uint32_t seed, uint8_t* grb, int pixel_count);
+
+  private:
+    esp_err_t validate();
+    esp_err_t alloc_line();
+    void advance(uint32_t show_ms);
+
+    effect_file_header_t header;
+    effect_cue_t* cues; /*!< cue_num entries, sorted by start_ms */
+
+    int32_t active[FRAME_FILE_CH_NUM];   /*!< Cue driving each channel, -1 = none yet (dark) */
+    int32_t rendered[FRAME_FILE_CH_NUM]; /*!< Static cue last written to the channel, -2 = nothing written */
+    uint32_t next_cue;                   /*!< First cue not applied yet */
+    uint32_t cursor_ms;                  /*!< Show time of the last advance() */
+
+    uint8_t* line; /*!< One channel of pixels, sized for the longest channel */
+};
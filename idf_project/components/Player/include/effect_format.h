@@ -0,0 +1,102 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "frame_format.h"
+
+/**
+ * @brief Magic bytes at the start of every effect cue file ("LDFX").
+ */
+#define EFFECT_FILE_MAGIC "LDFX"
+
+/**
+ * @brief Current version of the effect cue file layout.
+ */
+#define EFFECT_FILE_VERSION 1
+
+/**
+ * @brief Default location of the effect cue file, used when there is no show file.
+ */
+#define EFFECT_FILE_PATH "/sdcard/show.fx"
+
+/**
+ * @brief Upper bound on cues per file, the whole list is kept in RAM (22 bytes per cue).
+ */
+#define EFFECT_FILE_MAX_CUES 1024
+
+#if FRAME_FILE_CH_NUM > 64
+#error "effect_cue_t::ch_mask holds one bit per channel"
+#endif
+
+/**
+ * @brief Procedural effect primitives.
+ *
+ * `t` is the time since the cue started, `n` the pixel count of the channel.
+ * Colours are GRB like every other buffer in the project.
+ *
+ * | type            | speed                      | size                         | amount             |
+ * |-----------------|----------------------------|------------------------------|--------------------|
+ * | EFFECT_OFF      | -                          | -                            | -                  |
+ * | EFFECT_SOLID    | -                          | -                            | -                  |
+ * | EFFECT_GRADIENT | scroll, pixels/s           | -                            | -                  |
+ * | EFFECT_CHASE    | pixels/s                   | pixels per a / b segment     | -                  |
+ * | EFFECT_RAINBOW  | speed / 16 turns/s         | pixels per turn (0 = n)      | value (brightness) |
+ * | EFFECT_STROBE   | speed / 10 flashes/s       | -                            | duty, of 255       |
+ * | EFFECT_SPARKLE  | re-rolls/s (0 = frozen)    | -                            | density, of 255    |
+ * | EFFECT_WIPE     | pixels/s (0 = instant)     | -                            | -                  |
+ */
+typedef enum {
+    EFFECT_OFF = 0,      /*!< Channel dark */
+    EFFECT_SOLID = 1,    /*!< Every pixel color_a */
+    EFFECT_GRADIENT = 2, /*!< color_a at the first pixel to color_b at the last, mirrored while scrolling */
+    EFFECT_CHASE = 3,    /*!< Alternating color_a / color_b segments moving towards the end */
+    EFFECT_RAINBOW = 4,  /*!< Hue wheel spread over the pixels, turning over time */
+    EFFECT_STROBE = 5,   /*!< Whole channel color_a for `amount` of each period, color_b otherwise */
+    EFFECT_SPARKLE = 6,  /*!< Random pixels color_a over color_b, same pattern for the same show time */
+    EFFECT_WIPE = 7,     /*!< color_a filling the channel from the first pixel over color_b */
+    EFFECT_TYPE_NUM,
+} effect_type_t;
+
+/**
+ * @brief Parameters of one primitive, see effect_type_t for their meaning.
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t type;       /*!< effect_type_t */
+    uint8_t speed;      /*!< Motion rate */
+    uint8_t size;       /*!< Spatial size in pixels */
+    uint8_t amount;     /*!< Value, duty or density */
+    uint8_t color_a[3]; /*!< Primary colour, GRB */
+    uint8_t color_b[3]; /*!< Secondary / background colour, GRB */
+} effect_params_t;
+
+/**
+ * @brief One cue: from `start_ms` on, every channel in `ch_mask` runs `params`.
+ *
+ * A channel keeps its effect until a later cue names it again; an EFFECT_OFF
+ * cue turns it dark. Effect time restarts at every cue.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t start_ms; /*!< Show time the cue takes over */
+    uint64_t ch_mask;  /*!< One bit per channel, ch_info_t order */
+    effect_params_t params;
+} effect_cue_t;
+
+/**
+ * @brief Effect cue file header (little-endian, packed).
+ *
+ * File layout:
+ * [header]                  effect_file_header_t
+ * [cue 0 .. cue_num - 1]    effect_cue_t, sorted by start_ms
+ *
+ * The channel map has the same meaning as in frame_file_header_t, so an
+ * effect file can drive the strips on its own without a show file.
+ */
+typedef struct __attribute__((packed)) {
+    char magic[4];                            /*!< EFFECT_FILE_MAGIC, not NUL terminated */
+    uint8_t version;                          /*!< EFFECT_FILE_VERSION */
+    uint8_t fps;                              /*!< Evaluation frame rate */
+    uint16_t ch_num;                          /*!< Number of entries in pixel_counts, must equal FRAME_FILE_CH_NUM */
+    uint32_t cue_num;                         /*!< Number of cues following the header */
+    uint32_t duration_ms;                     /*!< End of show, 0 = run until stopped */
+    uint16_t pixel_counts[FRAME_FILE_CH_NUM]; /*!< Channel map, same layout as ch_info_t::pixel_counts */
+} effect_file_header_t;
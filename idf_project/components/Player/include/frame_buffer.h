@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+
+#include "esp_err.h"
+
+#include "LedController.hpp"
+
+/**
+ * @brief Flat GRB frame covering every channel of a ch_info_t.
+ *
+ * Channels are stored back to back in ch_info_t order. A bit per channel
+ * records which channels were written since the frame was last handed on,
+ * together with the pixel range the writes covered, so only those pixels
+ * need to be copied or flushed to the LedController.
+ */
+class FrameBuffer: public FrameTarget {
+  public:
+    FrameBuffer();
+    ~FrameBuffer();
+
+    esp_err_t init(const ch_info_t& ch_info);
+    void deinit();
+
+    esp_err_t write_pixels(int ch_idx, int pixel_idx, const uint8_t* data, int pixel_count) override;
+    esp_err_t fill(uint8_t red, uint8_t green, uint8_t blue) override;
+
+    void mark_dirty();
+    void copy_dirty_to(FrameBuffer& dst);
+    esp_err_t flush(FrameTarget& target);
+
+    uint32_t frame_idx; /*!< Index of the frame held in this buffer */
+
+  private:
+    ch_info_t ch_info;
+    uint32_t offsets[WS2812B_NUM + PCA9955B_CH_NUM + 1];
+    uint8_t* data;
+    uint64_t dirty_mask;
+    uint16_t dirty_lo[WS2812B_NUM + PCA9955B_CH_NUM]; /*!< First written pixel of each dirty channel */
+    uint16_t dirty_hi[WS2812B_NUM + PCA9955B_CH_NUM]; /*!< One past the last written pixel of each dirty channel */
+};
+
+/**
+ * @brief Lock-free single-producer / single-consumer ring of frame slots.
+ *
+ * The render task fills the slot returned by acquire_write() and publishes it;
+ * the output task drains slots with acquire_read() / release(). Each index is
+ * written by exactly one side, so no locks are needed.
+ */
+class FrameRing {
+  public:
+    FrameRing();
+    ~FrameRing();
+
+    esp_err_t init(int depth, const ch_info_t& ch_info);
+    void deinit();
+
+    FrameBuffer* acquire_write();
+    void publish();
+    FrameBuffer* acquire_read();
+    void release();
+
+    bool empty() const;
+    uint32_t get_drop_count() const;
+    void count_drop();
+
+  private:
+    FrameBuffer* slots;
+    int depth;
+
+    std::atomic<uint32_t> head; /*!< Written by the producer */
+    std::atomic<uint32_t> tail; /*!< Written by the consumer */
+    std::atomic<uint32_t> drops;
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "BoardConfig.h"
+
+/**
+ * @brief Magic bytes at the start of every show file ("LDFS").
+ */
+#define FRAME_FILE_MAGIC "LDFS"
+
+/**
+ * @brief Current version of the show file layout.
+ */
+#define FRAME_FILE_VERSION 3
+
+/**
+ * @brief Number of channels described by the channel map (WS2812B strips + PCA9955B LEDs).
+ */
+#define FRAME_FILE_CH_NUM (WS2812B_NUM + PCA9955B_CH_NUM)
+
+/**
+ * @brief Default location of the show file on the mounted file system.
+ */
+#define FRAME_FILE_PATH "/sdcard/show.bin"
+
+/**
+ * @brief Show file header (little-endian, packed).
+ *
+ * File layout:
+ * [header]                      frame_file_header_t
+ * [record 0 .. frame_num - 1]   frame_record_header_t + payload
+ * [keyframe index]              frame_index_entry_t[keyframe_num] at index_offset
+ *
+ * A full frame is the concatenation of every channel in ch_info_t order,
+ * `pixel_counts[ch] * 3` bytes per channel, pixels in GRB order.
+ * PCA9955B channels use the same GRB layout as the WS2812B strips.
+ */
+typedef struct __attribute__((packed)) {
+    char magic[4];                            /*!< FRAME_FILE_MAGIC, not NUL terminated */
+    uint8_t version;                          /*!< FRAME_FILE_VERSION */
+    uint8_t fps;                              /*!< Playback frame rate */
+    uint16_t ch_num;                          /*!< Number of entries in pixel_counts, must equal FRAME_FILE_CH_NUM */
+    uint32_t frame_num;                       /*!< Number of frame records following the header */
+    uint32_t frame_stride;                    /*!< Size of one full frame in bytes (sum of pixel_counts * 3) */
+    uint32_t max_record_size;                 /*!< Largest record payload in the file, sizes the decode buffer */
+    uint16_t keyframe_interval;               /*!< Maximum distance between two keyframes */
+    uint16_t reserved;                        /*!< Must be 0 */
+    uint32_t index_offset;                    /*!< File offset of the keyframe index */
+    uint32_t keyframe_num;                    /*!< Number of entries in the keyframe index */
+    uint16_t pixel_counts[FRAME_FILE_CH_NUM]; /*!< Channel map, same layout as ch_info_t::pixel_counts */
+} frame_file_header_t;
+
+/**
+ * @brief Frame record types.
+ */
+typedef enum {
+    FRAME_RECORD_KEY = 0,   /*!< Payload is a full frame of frame_stride bytes */
+    FRAME_RECORD_DELTA = 1, /*!< Payload is a list of runs applied to the previous frame */
+} frame_record_type_t;
+
+/**
+ * @brief Header preceding every frame payload.
+ *
+ * Delta payload layout, pixel positions are flat indices over all channels:
+ * repeat { varint skip; varint count; uint8_t grb[count * 3]; }
+ * `skip` unchanged pixels are left untouched, then `count` literal pixels are written.
+ * Varints are unsigned LEB128.
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t type;    /*!< frame_record_type_t */
+    uint16_t length; /*!< Payload size in bytes */
+} frame_record_header_t;
+
+/**
+ * @brief Keyframe index entry, one per FRAME_RECORD_KEY record in frame order.
+ *
+ * Lets the reader seek to any frame by jumping to the closest keyframe before
+ * it and applying at most keyframe_interval - 1 deltas.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t frame_idx; /*!< Index of the keyframe */
+    uint32_t offset;    /*!< File offset of its frame_record_header_t */
+} frame_index_entry_t;
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdio.h>
+
+#include "esp_err.h"
+
+#include "LedController.hpp"
+#include "frame_format.h"
+
+/**
+ * @brief Streaming reader for show files (see frame_format.h).
+ *
+ * Only the header and a single record are kept in RAM; every call to
+ * read_frame() pulls the next record from the file and applies it to the
+ * target (usually the LedController shadow buffers). Delta records touch only
+ * the changed pixels, so untouched devices stay clean and are skipped by show().
+ * The keyframe index is loaded at open(), so seek() costs one fseek() plus at
+ * most keyframe_interval - 1 deltas regardless of the target frame.
+ */
+class FrameReader {
+  public:
+    FrameReader();
+    ~FrameReader();
+
+    esp_err_t open(const char* path);
+    void close();
+    bool is_open() const;
+
+    esp_err_t read_frame(FrameTarget& target);
+    esp_err_t rewind();
+    esp_err_t seek(uint32_t frame_idx);
+    uint32_t keyframe_before(uint32_t frame_idx) const;
+
+    ch_info_t get_ch_info() const;
+    uint8_t get_fps() const;
+    uint32_t get_frame_num() const;
+    uint32_t get_frame_idx() const;
+
+  private:
+    esp_err_t apply_keyframe(FrameTarget& target, const uint8_t* payload, uint16_t length);
+    esp_err_t apply_delta(FrameTarget& target, const uint8_t* payload, uint16_t length);
+    esp_err_t load_index();
+    int find_keyframe(uint32_t frame_idx) const;
+
+    FILE* file;
+    frame_file_header_t header;
+    uint32_t pixel_total;
+
+    uint8_t* record_buffer;
+    frame_index_entry_t* index; /*!< keyframe_num entries, sorted by frame */
+    uint32_t frame_idx;
+    long data_offset;
+};
@@ -5,17 +5,62 @@
 #include "freertos/queue.h"
 
 #include "LedController.hpp"
+#include "effect_engine.h"
+#include "frame_buffer.h"
+#include "frame_reader.h"
+#include "show_clock.h"
+
+/**
+ * @brief Split rendering and output across both cores.
+ *
+ * When enabled, the Player task renders frames into a ring of PLAYER_RING_DEPTH
+ * slots on PLAYER_RENDER_CORE, and an output task pinned to PLAYER_OUTPUT_CORE
+ * owns the LedController and drives show().
+ */
+#define PLAYER_DUAL_CORE 1
+#define PLAYER_RING_DEPTH 3
+#define PLAYER_RENDER_CORE 0
+#define PLAYER_OUTPUT_CORE 1
+
+/**
+ * @brief Show clock tick placement.
+ *
+ * Ticks are re-aligned every frame to land PLAYER_TICK_GUARD_US after the
+ * frame boundary, so a tick is never early by a few microseconds and shows
+ * the previous frame again. When the clock jumps back by at most
+ * PLAYER_MAX_HOLD_FRAMES the current frame is held, further jumps rewind.
+ */
+#define PLAYER_TICK_GUARD_US 100
+#define PLAYER_MAX_HOLD_FRAMES 2
+
+/**
+ * @brief Frame rates used when the show file does not set one.
+ */
+#define PLAYER_DEFAULT_FPS 30   /*!< Test pattern playback without a show or effect file */
+#define PLAYER_TEST_FPS 1       /*!< TestState, unless EVENT_TEST carries a rate */
+#define PLAYER_TEST_MAX_FPS 120 /*!< Highest rate the console accepts for EVENT_TEST */
 
 typedef enum {
     EVENT_PLAY,
     EVENT_PAUSE,
     EVENT_TEST,
     EVENT_RESET,
+    EVENT_SYNC,
+    EVENT_SEEK,
+    EVENT_BRIGHTNESS,
 } event_t;
 
+/**
+ * @brief EVENT_PLAY data: resume where playback stopped, or start at Event::time_us.
+ */
+#define PLAYER_PLAY_RESUME 0
+#define PLAYER_PLAY_FROM 1
+
 struct Event {
     event_t type;
-    uint32_t data;
+    uint32_t data;    /*!< EVENT_PLAY: PLAYER_PLAY_*, EVENT_TEST: fps (0 = PLAYER_TEST_FPS), EVENT_RESET: 1 = exit, EVENT_BRIGHTNESS: 0-255 */
+    int64_t time_us;  /*!< Show time for EVENT_SYNC, EVENT_SEEK and EVENT_PLAY with PLAYER_PLAY_FROM */
+    int64_t local_us; /*!< esp_timer_get_time() when the event was sent, set by sendEvent() */
 };
 
 class State;
@@ -38,6 +83,9 @@ class Player {
 
     TaskHandle_t& getTaskHandle();
 
+    void printStats();
+    void resetStats();
+
   private:
     Player();
 
@@ -57,13 +105,20 @@ class Player {
     // ================= Resources =================
 
     gptimer_handle_t gptimer;
+    ShowClock clock;
 
     LedController controller;
+    FrameReader reader;
+    EffectEngine effects; /*!< Procedural show, used when there is no show file */
     ch_info_t ch_info;
-    uint8_t** buffers;
+
+    FrameBuffer frame; /*!< Working frame the render stage draws into */
+    FrameRing ring;    /*!< Frames waiting for the output stage */
 
     int cur_frame_idx;
+    int test_fps;
     TaskHandle_t taskHandle;
+    TaskHandle_t outputTaskHandle;
     QueueHandle_t eventQueue;
 
     // ================= Task Managment =================
@@ -72,21 +127,36 @@ class Player {
     static void taskEntry(void* pvParameters);
     void Loop();
 
+    static void outputTaskEntry(void* pvParameters);
+    void outputLoop();
+    void drainPipeline();
+
     // ================= Timer Function Implementation =================
 
     void initTimer();
     void startTimer(int fps);
+    void alignTimer(int64_t show_us, int fps);
     void stopTimer();
     void deinitTimer();
 
+    void startClock(Event& event);
+    void stopClock();
+    void syncClock(Event& event);
+    void seekShow(Event& event);
+    void setBrightness(uint8_t brightness);
+
     // ================= Driver Function Implementation =================
 
     void initDrivers();
+    FrameTarget& renderTarget();
     void computeTestFrame(int frame_idx);
-    void computeFrame();
+    esp_err_t computeFrame();
+    esp_err_t decodeNextFrame();
     void showFrame();
     void deinitDrivers();
-    void allocateBuffer();
+    esp_err_t allocateBuffers();
     void freeBuffers();
     void resetFrameIndex();
+    void seekFrame(uint32_t frame_idx);
+    int getFps();
 };
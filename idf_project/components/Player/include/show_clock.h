@@ -0,0 +1,77 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @brief Re-anchor offsets larger than this are treated as a jump of the
+ *        master (seek) rather than drift, and restart the rate measurement.
+ */
+#define SHOW_CLOCK_STEP_US 100000
+
+/**
+ * @brief Rate correction against the master.
+ *
+ * The rate is measured over the whole interval since the first sync after a
+ * start or step, so transport jitter of the master timestamps averages out;
+ * it is only applied once that interval is SHOW_CLOCK_MIN_BASELINE_US long.
+ */
+#define SHOW_CLOCK_MAX_PPM 500
+#define SHOW_CLOCK_MIN_BASELINE_US (5 * 1000 * 1000)
+
+/**
+ * @brief Drift / jitter statistics of the show clock.
+ */
+typedef struct {
+    uint32_t syncs;          /*!< Master timestamps applied */
+    uint32_t steps;          /*!< Syncs whose offset exceeded SHOW_CLOCK_STEP_US */
+    int32_t last_offset_us;  /*!< Master minus local show time at the last sync */
+    uint32_t max_offset_us;  /*!< Largest |offset| of a non-step sync */
+    int32_t rate_ppm;        /*!< Current rate correction applied to the local clock */
+    uint32_t ticks;          /*!< Timer ticks that rendered a frame */
+    uint32_t skipped;        /*!< Frames decoded but never shown because a tick was late */
+    uint32_t repeated;       /*!< Ticks that held the previous frame because the clock was behind */
+} show_clock_stats_t;
+
+/**
+ * @brief Absolute show clock: microseconds since the start of the show.
+ *
+ * Show time is derived from a local timestamp (esp_timer_get_time()) and an
+ * anchor, so late or coalesced timer ticks never accumulate: every tick asks
+ * which frame is due right now. The anchor can be moved to a master timestamp
+ * at any time; syncs that are not steps also train a ppm rate correction so
+ * the clock keeps following the master between syncs.
+ *
+ * All timestamps are passed in by the caller, which keeps the class free of
+ * any platform dependency.
+ */
+class ShowClock {
+  public:
+    ShowClock();
+
+    void seek(int64_t local_us, int64_t show_us);
+    void start(int64_t local_us);
+    void stop(int64_t local_us);
+    bool is_running() const;
+
+    int64_t now(int64_t local_us) const;
+    bool sync(int64_t local_us, int64_t master_us);
+
+    static uint32_t frame_at(int64_t show_us, int fps);
+    static int64_t frame_time(uint32_t frame_idx, int fps);
+
+    void count_tick(uint32_t skipped);
+    void count_repeat();
+
+    const show_clock_stats_t& get_stats() const;
+    void reset_stats();
+
+  private:
+    int64_t anchor_local_us; /*!< Local time of the anchor */
+    int64_t anchor_show_us;  /*!< Show time at the anchor */
+    int64_t ref_local_us;    /*!< Local time of the rate reference sync */
+    int64_t ref_master_us;   /*!< Master time of the rate reference sync */
+    bool has_ref;
+    bool running;
+
+    show_clock_stats_t stats;
+};
@@ -0,0 +1,70 @@
+#include "color_math.h"
+
+/**
+ * @brief round(127 * sin(2 * pi * i / 256)) for the first quarter turn, i = 0..64.
+ */
+static const int8_t sin_quarter[65] = {
+    0,   3,   6,   9,   12,  16,  19,  22,  25,  28,  31,  34,  37,  40,  43,  46,  49,  51,  54,  57,  60,  63,
+    65,  68,  71,  73,  76,  78,  81,  83,  85,  88,  90,  92,  94,  96,  98,  100, 102, 104, 106, 107, 109, 111,
+    112, 113, 115, 116, 117, 118, 120, 121, 122, 122, 123, 124, 125, 125, 126, 126, 126, 127, 127, 127, 127,
+};
+
+/**
+ * @brief `x / 255` rounded down, exact for x <= 65535.
+ */
+static inline uint32_t div255(uint32_t x) {
+    return (x + 1 + (x >> 8)) >> 8;
+}
+
+int8_t color_sin8(uint8_t theta) {
+    uint8_t idx = theta & 0x3F;
+
+    switch(theta >> 6) {
+        case 0:
+            return sin_quarter[idx];
+        case 1:
+            return sin_quarter[64 - idx];
+        case 2:
+            return (int8_t)-sin_quarter[idx];
+        default:
+            return (int8_t)-sin_quarter[64 - idx];
+    }
+}
+
+void color_hsv_to_grb(uint8_t hue, uint8_t sat, uint8_t val, uint8_t* grb) {
+    // Six sectors of the wheel, `frac` is the 8-bit position inside one
+    uint32_t h6 = hue * 6;
+    uint32_t sector = h6 >> 8;
+    uint32_t frac = h6 & 0xFF;
+
+    uint8_t v = val;
+    uint8_t p = (uint8_t)div255(val * (255 - sat));
+    uint8_t q = (uint8_t)div255(val * (255 - ((sat * frac) >> 8)));
+    uint8_t t = (uint8_t)div255(val * (255 - ((sat * (256 - frac)) >> 8)));
+    uint8_t r, g, b;
+
+    switch(sector) {
+        case 0:
+            r = v, g = t, b = p;
+            break;
+        case 1:
+            r = q, g = v, b = p;
+            break;
+        case 2:
+            r = p, g = v, b = t;
+            break;
+        case 3:
+            r = p, g = q, b = v;
+            break;
+        case 4:
+            r = t, g = p, b = v;
+            break;
+        default:
+            r = v, g = p, b = q;
+            break;
+    }
+
+    grb[0] = g;
+    grb[1] = r;
+    grb[2] = b;
+}
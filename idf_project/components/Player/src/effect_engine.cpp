@@ -0,0 +1,385 @@
+#include "effect_engine.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_check.h"
+#include "esp_log.h"
+
+#include "color_math.h"
+
+static const char* TAG = "EffectEngine";
+
+#define EFFECT_NOT_RENDERED (-2) /*!< EffectEngine::rendered before the first write, -1 is a dark channel */
+
+/**
+ * @brief Cheap stateless hash, so sparkle patterns depend on the show time only.
+ */
+static inline uint32_t hash32(uint32_t seed, uint32_t pixel, uint32_t slot) {
+    uint32_t x = seed * 0x9E3779B1u ^ pixel * 0x85EBCA6Bu ^ slot * 0xC2B2AE35u;
+    x ^= x >> 15;
+    x *= 0x2C1B3C6Du;
+    x ^= x >> 12;
+    return x;
+}
+
+static inline void put(uint8_t* grb, const uint8_t* color) {
+    grb[0] = color[0];
+    grb[1] = color[1];
+    grb[2] = color[2];
+}
+
+/**
+ * @brief Effects whose output does not depend on the time, written once per cue.
+ */
+static bool effect_is_static(const effect_params_t& params) {
+    switch(params.type) {
+        case EFFECT_OFF:
+        case EFFECT_SOLID:
+            return true;
+        case EFFECT_GRADIENT:
+        case EFFECT_CHASE:
+        case EFFECT_RAINBOW:
+        case EFFECT_SPARKLE:
+            return params.speed == 0;
+        default:
+            return false;
+    }
+}
+
+EffectEngine::EffectEngine(): cues(NULL), next_cue(0), cursor_ms(0), line(NULL) {
+    memset(&header, 0, sizeof(header));
+    rewind();
+}
+
+EffectEngine::~EffectEngine() {
+    close();
+}
+
+esp_err_t EffectEngine::open(const char* path) {
+    esp_err_t ret = ESP_OK;
+    FILE* file = NULL;
+
+    ESP_RETURN_ON_FALSE(path, ESP_ERR_INVALID_ARG, TAG, "Path is NULL");
+
+    close();
+
+    // 1. Open File
+    file = fopen(path, "rb");
+    ESP_RETURN_ON_FALSE(file, ESP_ERR_NOT_FOUND, TAG, "Failed to open %s", path);
+
+    // 2. Read & Validate Header
+    ESP_GOTO_ON_FALSE(fread(&header, sizeof(header), 1, file) == 1, ESP_ERR_INVALID_SIZE, err, TAG, "Header truncated");
+    ESP_GOTO_ON_FALSE(memcmp(header.magic, EFFECT_FILE_MAGIC, sizeof(header.magic)) == 0, ESP_ERR_INVALID_RESPONSE, err, TAG, "Bad magic");
+    ESP_GOTO_ON_FALSE(header.version == EFFECT_FILE_VERSION, ESP_ERR_INVALID_VERSION, err, TAG, "Unsupported version %d", header.version);
+    ESP_GOTO_ON_FALSE(header.ch_num == FRAME_FILE_CH_NUM, ESP_ERR_INVALID_SIZE, err, TAG, "Channel count mismatch (%d)", header.ch_num);
+    ESP_GOTO_ON_FALSE(header.fps > 0, ESP_ERR_INVALID_ARG, err, TAG, "Invalid fps");
+    ESP_GOTO_ON_FALSE(header.cue_num <= EFFECT_FILE_MAX_CUES, ESP_ERR_INVALID_SIZE, err, TAG, "Too many cues (%lu)", (unsigned long)header.cue_num);
+
+    // 3. Load every cue; render() never touches the file
+    if(header.cue_num > 0) {
+        cues = (effect_cue_t*)malloc(header.cue_num * sizeof(effect_cue_t));
+        ESP_GOTO_ON_FALSE(cues, ESP_ERR_NO_MEM, err, TAG, "Cue allocation failed");
+        ESP_GOTO_ON_FALSE(fread(cues, sizeof(effect_cue_t), header.cue_num, file) == header.cue_num, ESP_ERR_INVALID_SIZE, err, TAG, "Cues truncated");
+    }
+    fclose(file);
+    file = NULL;
+
+    ESP_GOTO_ON_ERROR(validate(), err, TAG, "Invalid cue list");
+    ESP_GOTO_ON_ERROR(alloc_line(), err, TAG, "Line buffer allocation failed");
+
+    ESP_LOGI(TAG,
+             "Opened %s (%lu cues @ %d fps, %lu bytes)",
+             path,
+             (unsigned long)header.cue_num,
+             header.fps,
+             (unsigned long)(sizeof(header) + header.cue_num * sizeof(effect_cue_t)));
+    return ESP_OK;
+
+err:
+    if(file) {
+        fclose(file);
+    }
+    close();
+    return ret;
+}
+
+/**
+ * @brief Takes a cue list from memory instead of a file (copied, `list` may be freed afterwards).
+ */
+esp_err_t EffectEngine::load(const ch_info_t& ch_info, uint8_t fps, const effect_cue_t* list, uint32_t cue_num) {
+    esp_err_t ret = ESP_OK;
+
+    ESP_RETURN_ON_FALSE(list || cue_num == 0, ESP_ERR_INVALID_ARG, TAG, "Cues are NULL");
+    ESP_RETURN_ON_FALSE(fps > 0, ESP_ERR_INVALID_ARG, TAG, "Invalid fps");
+    ESP_RETURN_ON_FALSE(cue_num <= EFFECT_FILE_MAX_CUES, ESP_ERR_INVALID_SIZE, TAG, "Too many cues (%lu)", (unsigned long)cue_num);
+
+    close();
+
+    memcpy(header.magic, EFFECT_FILE_MAGIC, sizeof(header.magic));
+    header.version = EFFECT_FILE_VERSION;
+    header.fps = fps;
+    header.ch_num = FRAME_FILE_CH_NUM;
+    header.cue_num = cue_num;
+    header.duration_ms = 0;
+    memcpy(header.pixel_counts, ch_info.pixel_counts, sizeof(header.pixel_counts));
+
+    if(cue_num > 0) {
+        cues = (effect_cue_t*)malloc(cue_num * sizeof(effect_cue_t));
+        ESP_GOTO_ON_FALSE(cues, ESP_ERR_NO_MEM, err, TAG, "Cue allocation failed");
+        memcpy(cues, list, cue_num * sizeof(effect_cue_t));
+    }
+
+    ESP_GOTO_ON_ERROR(validate(), err, TAG, "Invalid cue list");
+    ESP_GOTO_ON_ERROR(alloc_line(), err, TAG, "Line buffer allocation failed");
+    return ESP_OK;
+
+err:
+    close();
+    return ret;
+}
+
+/**
+ * @brief Checks the cue list once so render() can trust it.
+ */
+esp_err_t EffectEngine::validate() {
+    const uint64_t ch_bits = FRAME_FILE_CH_NUM >= 64 ? ~0ULL : (1ULL << FRAME_FILE_CH_NUM) - 1;
+
+    for(uint32_t i = 0; i < header.cue_num; i++) {
+        ESP_RETURN_ON_FALSE(cues[i].params.type < EFFECT_TYPE_NUM,
+                            ESP_ERR_INVALID_RESPONSE,
+                            TAG,
+                            "Cue %lu has unknown type %d",
+                            (unsigned long)i,
+                            cues[i].params.type);
+        ESP_RETURN_ON_FALSE((cues[i].ch_mask & ~ch_bits) == 0, ESP_ERR_INVALID_RESPONSE, TAG, "Cue %lu names a missing channel", (unsigned long)i);
+        ESP_RETURN_ON_FALSE(i == 0 || cues[i].start_ms >= cues[i - 1].start_ms, ESP_ERR_INVALID_RESPONSE, TAG, "Cue %lu out of order", (unsigned long)i);
+    }
+    return ESP_OK;
+}
+
+esp_err_t EffectEngine::alloc_line() {
+    int max_pixels = 1;
+    for(int i = 0; i < FRAME_FILE_CH_NUM; i++) {
+        if(header.pixel_counts[i] > max_pixels) {
+            max_pixels = header.pixel_counts[i];
+        }
+    }
+
+    line = (uint8_t*)malloc(max_pixels * 3);
+    ESP_RETURN_ON_FALSE(line, ESP_ERR_NO_MEM, TAG, "Line allocation failed");
+
+    rewind();
+    return ESP_OK;
+}
+
+void EffectEngine::close() {
+    if(cues) {
+        free(cues);
+        cues = NULL;
+    }
+    if(line) {
+        free(line);
+        line = NULL;
+    }
+    header.cue_num = 0;
+    rewind();
+}
+
+bool EffectEngine::is_open() const {
+    return line != NULL;
+}
+
+/**
+ * @brief Forgets applied cues and written channels, the next render() starts over.
+ *
+ * Call it when the target was changed behind the engine's back.
+ */
+void EffectEngine::rewind() {
+    for(int i = 0; i < FRAME_FILE_CH_NUM; i++) {
+        active[i] = -1;
+        rendered[i] = EFFECT_NOT_RENDERED;
+    }
+    next_cue = 0;
+    cursor_ms = 0;
+}
+
+/**
+ * @brief Applies every cue that started by `show_ms`; a jump back replays from the first cue.
+ */
+void EffectEngine::advance(uint32_t show_ms) {
+    if(show_ms < cursor_ms) {
+        for(int i = 0; i < FRAME_FILE_CH_NUM; i++) {
+            active[i] = -1;
+        }
+        next_cue = 0;
+    }
+    cursor_ms = show_ms;
+
+    while(next_cue < header.cue_num && cues[next_cue].start_ms <= show_ms) {
+        uint64_t mask = cues[next_cue].ch_mask;
+        while(mask) {
+            int ch_idx = __builtin_ctzll(mask);
+            active[ch_idx] = next_cue;
+            mask &= mask - 1;
+        }
+        next_cue++;
+    }
+}
+
+/**
+ * @brief Renders every channel for show time `show_ms` into `target`.
+ *
+ * @return
+ * - ESP_OK: Frame rendered.
+ * - ESP_ERR_NOT_FOUND: `show_ms` is past duration_ms, nothing written.
+ * - Other: First error reported by the target.
+ */
+esp_err_t EffectEngine::render(FrameTarget& target, uint32_t show_ms) {
+    static const effect_params_t dark = {};
+    esp_err_t ret = ESP_OK;
+
+    // 1. State Validation
+    ESP_RETURN_ON_FALSE(line, ESP_ERR_INVALID_STATE, TAG, "Engine not opened");
+
+    // 2. End of Show
+    if(header.duration_ms > 0 && show_ms >= header.duration_ms) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    // 3. Active cue per channel
+    advance(show_ms);
+
+    // 4. Evaluate each channel into the line buffer and hand it to the target
+    for(int ch_idx = 0; ch_idx < FRAME_FILE_CH_NUM; ch_idx++) {
+        int pixel_count = header.pixel_counts[ch_idx];
+        int32_t cue_idx = active[ch_idx];
+        if(pixel_count == 0) {
+            continue;
+        }
+
+        const effect_params_t& params = cue_idx >= 0 ? cues[cue_idx].params : dark;
+        if(effect_is_static(params)) {
+            if(rendered[ch_idx] == cue_idx) {
+                continue;
+            }
+            rendered[ch_idx] = cue_idx;
+        } else {
+            rendered[ch_idx] = EFFECT_NOT_RENDERED;
+        }
+
+        uint32_t t_ms = cue_idx >= 0 ? show_ms - cues[cue_idx].start_ms : 0;
+        render_pixels(params, t_ms, ch_idx, line, pixel_count);
+
+        esp_err_t err = target.write_pixels(ch_idx, 0, line, pixel_count);
+        if(err != ESP_OK && ret == ESP_OK) {
+            ret = err;
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Evaluates one primitive over `pixel_count` GRB pixels, `t_ms` after its cue started.
+ *
+ * Integer only, the per-channel terms are worked out before the pixel loop.
+ * `seed` decorrelates the sparkle pattern of different channels.
+ */
+void EffectEngine::render_pixels(const effect_params_t& params, uint32_t t_ms, uint32_t seed, uint8_t* grb, int pixel_count) {
+    const uint8_t* a = params.color_a;
+    const uint8_t* b = params.color_b;
+    uint32_t n = pixel_count;
+    uint32_t moved = (uint32_t)((uint64_t)t_ms * params.speed / 1000);  // pixels (or slots) travelled so far
+
+    switch(params.type) {
+        case EFFECT_SOLID:
+            for(uint32_t i = 0; i < n; i++, grb += 3) {
+                put(grb, a);
+            }
+            break;
+
+        case EFFECT_GRADIENT: {
+            // Mirrored over 2n so scrolling has no seam
+            uint32_t step = n > 1 ? (256 << 16) / (n - 1) : 0;
+            uint32_t p = moved % (2 * n);
+            for(uint32_t i = 0; i < n; i++, grb += 3) {
+                color_blend_grb(a, b, ((p < n ? p : 2 * n - 1 - p) * step) >> 16, grb);
+                if(++p == 2 * n) {
+                    p = 0;
+                }
+            }
+            break;
+        }
+
+        case EFFECT_CHASE: {
+            uint32_t seg = params.size ? params.size : 1;
+            uint32_t p = (2 * seg - moved % (2 * seg)) % (2 * seg);
+            for(uint32_t i = 0; i < n; i++, grb += 3) {
+                put(grb, p < seg ? a : b);
+                if(++p == 2 * seg) {
+                    p = 0;
+                }
+            }
+            break;
+        }
+
+        case EFFECT_RAINBOW: {
+            // Hue in 8.8 fixed point so short spans still step smoothly
+            uint32_t span = params.size ? params.size : n;
+            uint32_t step = (256 << 8) / span;
+            uint32_t hue = (uint32_t)(((uint64_t)t_ms * params.speed / 64) << 8);
+            for(uint32_t i = 0; i < n; i++, grb += 3) {
+                color_hsv_to_grb((uint8_t)(hue >> 8), 255, params.amount, grb);
+                hue += step;
+            }
+            break;
+        }
+
+        case EFFECT_STROBE: {
+            bool on = false;
+            if(params.speed) {
+                uint32_t period_ms = 10000 / params.speed;
+                on = (t_ms % period_ms) * 255 < params.amount * period_ms;
+            }
+            const uint8_t* color = on ? a : b;
+            for(uint32_t i = 0; i < n; i++, grb += 3) {
+                put(grb, color);
+            }
+            break;
+        }
+
+        case EFFECT_SPARKLE:
+            for(uint32_t i = 0; i < n; i++, grb += 3) {
+                put(grb, (hash32(seed, i, moved) & 0xFF) < params.amount ? a : b);
+            }
+            break;
+
+        case EFFECT_WIPE: {
+            uint32_t lit = params.speed ? moved : n;
+            for(uint32_t i = 0; i < n; i++, grb += 3) {
+                put(grb, i < lit ? a : b);
+            }
+            break;
+        }
+
+        case EFFECT_OFF:
+        default:
+            memset(grb, 0, n * 3);
+            break;
+    }
+}
+
+ch_info_t EffectEngine::get_ch_info() const {
+    ch_info_t ch_info;
+    memcpy(ch_info.pixel_counts, header.pixel_counts, sizeof(ch_info.pixel_counts));
+    return ch_info;
+}
+
+uint8_t EffectEngine::get_fps() const {
+    return header.fps;
+}
+
+uint32_t EffectEngine::get_duration_ms() const {
+    return header.duration_ms;
+}
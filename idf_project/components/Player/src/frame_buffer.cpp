@@ -0,0 +1,221 @@
+#include "frame_buffer.h"
+
+#include <string.h>
+#include <new>
+
+#include "esp_check.h"
+#include "esp_log.h"
+
+#define FRAME_CH_NUM (WS2812B_NUM + PCA9955B_CH_NUM)
+
+static const char* TAG = "FrameBuffer";
+
+// ================= FrameBuffer =================
+
+FrameBuffer::FrameBuffer(): frame_idx(0), data(NULL), dirty_mask(0), dirty_lo(), dirty_hi() {
+    memset(&ch_info, 0, sizeof(ch_info));
+    memset(offsets, 0, sizeof(offsets));
+}
+
+FrameBuffer::~FrameBuffer() {
+    deinit();
+}
+
+esp_err_t FrameBuffer::init(const ch_info_t& _ch_info) {
+    deinit();
+    ch_info = _ch_info;
+
+    // 1. Channel offsets into the flat frame
+    offsets[0] = 0;
+    for(int i = 0; i < FRAME_CH_NUM; i++) {
+        offsets[i + 1] = offsets[i] + ch_info.pixel_counts[i] * 3;
+    }
+
+    // 2. Allocation
+    data = (uint8_t*)calloc(offsets[FRAME_CH_NUM], 1);
+    ESP_RETURN_ON_FALSE(data, ESP_ERR_NO_MEM, TAG, "Frame allocation failed");
+
+    frame_idx = 0;
+    dirty_mask = 0;
+    return ESP_OK;
+}
+
+void FrameBuffer::deinit() {
+    if(data) {
+        free(data);
+        data = NULL;
+    }
+    dirty_mask = 0;
+}
+
+esp_err_t FrameBuffer::write_pixels(int ch_idx, int pixel_idx, const uint8_t* src, int pixel_count) {
+    ESP_RETURN_ON_FALSE(data && src, ESP_ERR_INVALID_STATE, TAG, "Frame not allocated");
+    ESP_RETURN_ON_FALSE(ch_idx >= 0 && ch_idx < FRAME_CH_NUM, ESP_ERR_INVALID_ARG, TAG, "Channel index %d out of range", ch_idx);
+    ESP_RETURN_ON_FALSE(pixel_idx >= 0 && pixel_count >= 0 && pixel_idx + pixel_count <= ch_info.pixel_counts[ch_idx],
+                        ESP_ERR_INVALID_ARG,
+                        TAG,
+                        "Pixel range %d+%d out of bounds on channel %d",
+                        pixel_idx,
+                        pixel_count,
+                        ch_idx);
+
+    if(pixel_count == 0) {
+        return ESP_OK;
+    }
+    memcpy(data + offsets[ch_idx] + pixel_idx * 3, src, pixel_count * 3);
+
+    // Grow the channel's dirty range over the run
+    uint16_t lo = (uint16_t)pixel_idx;
+    uint16_t hi = (uint16_t)(pixel_idx + pixel_count);
+    if(!(dirty_mask & (1ULL << ch_idx))) {
+        dirty_lo[ch_idx] = lo;
+        dirty_hi[ch_idx] = hi;
+        dirty_mask |= 1ULL << ch_idx;
+    } else {
+        dirty_lo[ch_idx] = lo < dirty_lo[ch_idx] ? lo : dirty_lo[ch_idx];
+        dirty_hi[ch_idx] = hi > dirty_hi[ch_idx] ? hi : dirty_hi[ch_idx];
+    }
+    return ESP_OK;
+}
+
+esp_err_t FrameBuffer::fill(uint8_t red, uint8_t green, uint8_t blue) {
+    ESP_RETURN_ON_FALSE(data, ESP_ERR_INVALID_STATE, TAG, "Frame not allocated");
+
+    uint8_t* ptr = data;
+    for(uint32_t i = 0; i < offsets[FRAME_CH_NUM] / 3; i++) {
+        *ptr++ = green;  // G
+        *ptr++ = red;    // R
+        *ptr++ = blue;   // B
+    }
+
+    mark_dirty();
+    return ESP_OK;
+}
+
+/**
+ * @brief Marks every channel as written, so the whole frame is handed on again.
+ */
+void FrameBuffer::mark_dirty() {
+    if(!data) {
+        return;
+    }
+    for(int i = 0; i < FRAME_CH_NUM; i++) {
+        if(ch_info.pixel_counts[i] > 0) {
+            dirty_mask |= 1ULL << i;
+            dirty_lo[i] = 0;
+            dirty_hi[i] = ch_info.pixel_counts[i];
+        }
+    }
+}
+
+void FrameBuffer::copy_dirty_to(FrameBuffer& dst) {
+    // Only the pixels written since the last hand-off are copied; the rest of
+    // dst is stale and never flushed, the LedController still holds those pixels.
+    for(int i = 0; i < FRAME_CH_NUM; i++) {
+        if(dirty_mask & (1ULL << i)) {
+            memcpy(dst.data + offsets[i] + dirty_lo[i] * 3, data + offsets[i] + dirty_lo[i] * 3, (dirty_hi[i] - dirty_lo[i]) * 3);
+            dst.dirty_lo[i] = dirty_lo[i];
+            dst.dirty_hi[i] = dirty_hi[i];
+        }
+    }
+    dst.dirty_mask = dirty_mask;
+    dst.frame_idx = frame_idx;
+    dirty_mask = 0;
+}
+
+esp_err_t FrameBuffer::flush(FrameTarget& target) {
+    esp_err_t ret = ESP_OK;
+    esp_err_t err = ESP_OK;
+
+    for(int i = 0; i < FRAME_CH_NUM; i++) {
+        if(!(dirty_mask & (1ULL << i))) {
+            continue;
+        }
+        err = target.write_pixels(i, dirty_lo[i], data + offsets[i] + dirty_lo[i] * 3, dirty_hi[i] - dirty_lo[i]);
+        if(err != ESP_OK) {
+            ret = err;
+        }
+    }
+    dirty_mask = 0;
+
+    return ret;
+}
+
+// ================= FrameRing =================
+
+FrameRing::FrameRing(): slots(NULL), depth(0), head(0), tail(0), drops(0) {}
+
+FrameRing::~FrameRing() {
+    deinit();
+}
+
+esp_err_t FrameRing::init(int _depth, const ch_info_t& ch_info) {
+    esp_err_t ret = ESP_OK;
+
+    ESP_RETURN_ON_FALSE(_depth > 0, ESP_ERR_INVALID_ARG, TAG, "Ring depth must be positive");
+
+    deinit();
+
+    slots = new(std::nothrow) FrameBuffer[_depth];
+    ESP_RETURN_ON_FALSE(slots, ESP_ERR_NO_MEM, TAG, "Slot allocation failed");
+    depth = _depth;
+
+    for(int i = 0; i < depth; i++) {
+        ESP_GOTO_ON_ERROR(slots[i].init(ch_info), err, TAG, "Failed to allocate slot %d", i);
+    }
+
+    head.store(0);
+    tail.store(0);
+    drops.store(0);
+    return ESP_OK;
+
+err:
+    deinit();
+    return ret;
+}
+
+void FrameRing::deinit() {
+    if(slots) {
+        delete[] slots;
+        slots = NULL;
+    }
+    depth = 0;
+    head.store(0);
+    tail.store(0);
+}
+
+FrameBuffer* FrameRing::acquire_write() {
+    uint32_t h = head.load(std::memory_order_relaxed);
+    if(!slots || h - tail.load(std::memory_order_acquire) >= (uint32_t)depth) {
+        return NULL;  // Full
+    }
+    return &slots[h % depth];
+}
+
+void FrameRing::publish() {
+    head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+FrameBuffer* FrameRing::acquire_read() {
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    if(!slots || t == head.load(std::memory_order_acquire)) {
+        return NULL;  // Empty
+    }
+    return &slots[t % depth];
+}
+
+void FrameRing::release() {
+    tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+bool FrameRing::empty() const {
+    return tail.load(std::memory_order_acquire) == head.load(std::memory_order_acquire);
+}
+
+uint32_t FrameRing::get_drop_count() const {
+    return drops.load(std::memory_order_relaxed);
+}
+
+void FrameRing::count_drop() {
+    drops.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,346 @@
+#include "frame_reader.h"
+
+#include <string.h>
+
+#include "esp_check.h"
+#include "esp_log.h"
+
+static const char* TAG = "FrameReader";
+
+/**
+ * @brief Decodes one unsigned LEB128 varint.
+ *
+ * @return Pointer past the varint, or NULL if it runs past `end`.
+ */
+static const uint8_t* read_varint(const uint8_t* ptr, const uint8_t* end, uint32_t* value) {
+    uint32_t result = 0;
+    int shift = 0;
+
+    while(ptr < end && shift < 32) {
+        uint8_t byte = *ptr++;
+        result |= (uint32_t)(byte & 0x7F) << shift;
+        if(!(byte & 0x80)) {
+            *value = result;
+            return ptr;
+        }
+        shift += 7;
+    }
+    return NULL;
+}
+
+FrameReader::FrameReader(): file(NULL), pixel_total(0), record_buffer(NULL), index(NULL), frame_idx(0), data_offset(0) {
+    memset(&header, 0, sizeof(header));
+}
+
+FrameReader::~FrameReader() {
+    close();
+}
+
+esp_err_t FrameReader::open(const char* path) {
+    esp_err_t ret = ESP_OK;
+    uint32_t stride = 0;
+
+    ESP_RETURN_ON_FALSE(path, ESP_ERR_INVALID_ARG, TAG, "Path is NULL");
+
+    close();
+
+    // 1. Open File
+    file = fopen(path, "rb");
+    ESP_RETURN_ON_FALSE(file, ESP_ERR_NOT_FOUND, TAG, "Failed to open %s", path);
+
+    // 2. Read & Validate Header
+    ESP_GOTO_ON_FALSE(fread(&header, sizeof(header), 1, file) == 1, ESP_ERR_INVALID_SIZE, err, TAG, "Header truncated");
+    ESP_GOTO_ON_FALSE(memcmp(header.magic, FRAME_FILE_MAGIC, sizeof(header.magic)) == 0, ESP_ERR_INVALID_RESPONSE, err, TAG, "Bad magic");
+    ESP_GOTO_ON_FALSE(header.version == FRAME_FILE_VERSION, ESP_ERR_INVALID_VERSION, err, TAG, "Unsupported version %d", header.version);
+    ESP_GOTO_ON_FALSE(header.ch_num == FRAME_FILE_CH_NUM, ESP_ERR_INVALID_SIZE, err, TAG, "Channel count mismatch (%d)", header.ch_num);
+    ESP_GOTO_ON_FALSE(header.fps > 0, ESP_ERR_INVALID_ARG, err, TAG, "Invalid fps");
+
+    // 3. Validate Channel Map against the hardware limits
+    pixel_total = 0;
+    for(int i = 0; i < FRAME_FILE_CH_NUM; i++) {
+        if(i >= WS2812B_NUM) {
+            ESP_GOTO_ON_FALSE(header.pixel_counts[i] <= 1, ESP_ERR_INVALID_SIZE, err, TAG, "PCA channel %d has %d pixels", i, header.pixel_counts[i]);
+        }
+        pixel_total += header.pixel_counts[i];
+    }
+    stride = pixel_total * 3;
+    ESP_GOTO_ON_FALSE(stride == header.frame_stride, ESP_ERR_INVALID_SIZE, err, TAG, "Frame stride mismatch (%lu)", (unsigned long)stride);
+    ESP_GOTO_ON_FALSE(header.max_record_size >= stride && header.max_record_size <= UINT16_MAX,
+                      ESP_ERR_INVALID_SIZE,
+                      err,
+                      TAG,
+                      "Invalid max record size (%lu)",
+                      (unsigned long)header.max_record_size);
+
+    // 4. Allocate the decode buffer once; read_frame() never allocates
+    record_buffer = (uint8_t*)malloc(header.max_record_size);
+    ESP_GOTO_ON_FALSE(record_buffer, ESP_ERR_NO_MEM, err, TAG, "Record buffer allocation failed");
+
+    // 5. Keyframe index, then back to the first record
+    data_offset = ftell(file);
+    ESP_GOTO_ON_ERROR(load_index(), err, TAG, "Invalid keyframe index");
+    ESP_GOTO_ON_FALSE(fseek(file, data_offset, SEEK_SET) == 0, ESP_FAIL, err, TAG, "Seek failed");
+    frame_idx = 0;
+
+    ESP_LOGI(TAG,
+             "Opened %s (%lu frames @ %d fps, %lu bytes/frame, %lu keyframes)",
+             path,
+             (unsigned long)header.frame_num,
+             header.fps,
+             (unsigned long)stride,
+             (unsigned long)header.keyframe_num);
+    return ESP_OK;
+
+err:
+    close();
+    return ret;
+}
+
+void FrameReader::close() {
+    if(file) {
+        fclose(file);
+        file = NULL;
+    }
+    if(record_buffer) {
+        free(record_buffer);
+        record_buffer = NULL;
+    }
+    if(index) {
+        free(index);
+        index = NULL;
+    }
+    frame_idx = 0;
+}
+
+esp_err_t FrameReader::load_index() {
+    long file_size = 0;
+
+    // 1. Validate Location
+    ESP_RETURN_ON_FALSE(header.frame_num == 0 || header.keyframe_num > 0, ESP_ERR_INVALID_SIZE, TAG, "No keyframes");
+    ESP_RETURN_ON_FALSE(header.keyframe_num <= header.frame_num, ESP_ERR_INVALID_SIZE, TAG, "Too many keyframes (%lu)", (unsigned long)header.keyframe_num);
+    ESP_RETURN_ON_FALSE(fseek(file, 0, SEEK_END) == 0, ESP_FAIL, TAG, "Seek failed");
+    file_size = ftell(file);
+    ESP_RETURN_ON_FALSE((long)header.index_offset >= data_offset &&
+                            (uint64_t)header.index_offset + header.keyframe_num * sizeof(frame_index_entry_t) <= (uint64_t)file_size,
+                        ESP_ERR_INVALID_SIZE,
+                        TAG,
+                        "Index out of file (%lu)",
+                        (unsigned long)header.index_offset);
+    if(header.keyframe_num == 0) {
+        return ESP_OK;
+    }
+
+    // 2. Read
+    index = (frame_index_entry_t*)malloc(header.keyframe_num * sizeof(frame_index_entry_t));
+    ESP_RETURN_ON_FALSE(index, ESP_ERR_NO_MEM, TAG, "Index allocation failed");
+    ESP_RETURN_ON_FALSE(fseek(file, header.index_offset, SEEK_SET) == 0, ESP_FAIL, TAG, "Seek failed");
+    ESP_RETURN_ON_FALSE(fread(index, sizeof(frame_index_entry_t), header.keyframe_num, file) == header.keyframe_num, ESP_ERR_INVALID_SIZE, TAG, "Index truncated");
+
+    // 3. Frame 0 must be a keyframe and entries must be ordered and inside the record area
+    ESP_RETURN_ON_FALSE(index[0].frame_idx == 0, ESP_ERR_INVALID_RESPONSE, TAG, "Frame 0 is not a keyframe");
+    for(uint32_t i = 0; i < header.keyframe_num; i++) {
+        ESP_RETURN_ON_FALSE(index[i].frame_idx < header.frame_num && (long)index[i].offset >= data_offset && index[i].offset < header.index_offset,
+                            ESP_ERR_INVALID_RESPONSE,
+                            TAG,
+                            "Index entry %lu out of range",
+                            (unsigned long)i);
+        ESP_RETURN_ON_FALSE(i == 0 || (index[i].frame_idx > index[i - 1].frame_idx && index[i].offset > index[i - 1].offset),
+                            ESP_ERR_INVALID_RESPONSE,
+                            TAG,
+                            "Index entry %lu out of order",
+                            (unsigned long)i);
+    }
+
+    return ESP_OK;
+}
+
+bool FrameReader::is_open() const {
+    return file != NULL;
+}
+
+esp_err_t FrameReader::read_frame(FrameTarget& target) {
+    frame_record_header_t record;
+
+    // 1. State Validation
+    ESP_RETURN_ON_FALSE(file && record_buffer, ESP_ERR_INVALID_STATE, TAG, "Reader not opened");
+
+    // 2. End of Show
+    if(frame_idx >= header.frame_num) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    // 3. Read one Record
+    ESP_RETURN_ON_FALSE(fread(&record, sizeof(record), 1, file) == 1, ESP_ERR_INVALID_SIZE, TAG, "Record %lu truncated", (unsigned long)frame_idx);
+    ESP_RETURN_ON_FALSE(record.length <= header.max_record_size, ESP_ERR_INVALID_SIZE, TAG, "Record %lu too large", (unsigned long)frame_idx);
+    ESP_RETURN_ON_FALSE(fread(record_buffer, 1, record.length, file) == record.length,
+                        ESP_ERR_INVALID_SIZE,
+                        TAG,
+                        "Record %lu truncated",
+                        (unsigned long)frame_idx);
+    frame_idx++;
+
+    // 4. Apply to the target
+    switch(record.type) {
+        case FRAME_RECORD_KEY:
+            return apply_keyframe(target, record_buffer, record.length);
+        case FRAME_RECORD_DELTA:
+            return apply_delta(target, record_buffer, record.length);
+        default:
+            ESP_LOGE(TAG, "Unknown record type %d", record.type);
+            return ESP_ERR_INVALID_RESPONSE;
+    }
+}
+
+esp_err_t FrameReader::apply_keyframe(FrameTarget& target, const uint8_t* payload, uint16_t length) {
+    esp_err_t ret = ESP_OK;
+    esp_err_t err = ESP_OK;
+
+    ESP_RETURN_ON_FALSE(length == header.frame_stride, ESP_ERR_INVALID_SIZE, TAG, "Keyframe size mismatch (%d)", length);
+
+    // Hand every channel to the target
+    for(int ch_idx = 0; ch_idx < FRAME_FILE_CH_NUM; ch_idx++) {
+        if(header.pixel_counts[ch_idx] == 0) {
+            continue;
+        }
+        err = target.write_pixels(ch_idx, 0, payload, header.pixel_counts[ch_idx]);
+        if(err != ESP_OK) {
+            ret = err;
+        }
+        payload += header.pixel_counts[ch_idx] * 3;
+    }
+
+    return ret;
+}
+
+esp_err_t FrameReader::apply_delta(FrameTarget& target, const uint8_t* payload, uint16_t length) {
+    esp_err_t ret = ESP_OK;
+    esp_err_t err = ESP_OK;
+
+    const uint8_t* ptr = payload;
+    const uint8_t* end = payload + length;
+
+    uint32_t pos = 0;       // Flat pixel index over all channels
+    int ch_idx = 0;         // Channel containing `pos`
+    uint32_t ch_start = 0;  // Flat index of the first pixel of `ch_idx`
+
+    while(ptr < end) {
+        uint32_t skip = 0;
+        uint32_t count = 0;
+
+        // 1. Decode run header
+        ptr = read_varint(ptr, end, &skip);
+        ESP_RETURN_ON_FALSE(ptr, ESP_ERR_INVALID_SIZE, TAG, "Delta run truncated");
+        ptr = read_varint(ptr, end, &count);
+        ESP_RETURN_ON_FALSE(ptr, ESP_ERR_INVALID_SIZE, TAG, "Delta run truncated");
+
+        // Compare against the remaining space so huge varints cannot wrap pos or count * 3
+        ESP_RETURN_ON_FALSE(skip <= pixel_total - pos, ESP_ERR_INVALID_SIZE, TAG, "Delta skip out of range");
+        pos += skip;
+        ESP_RETURN_ON_FALSE(count <= pixel_total - pos, ESP_ERR_INVALID_SIZE, TAG, "Delta run out of range");
+        ESP_RETURN_ON_FALSE(count <= (uint32_t)(end - ptr) / 3, ESP_ERR_INVALID_SIZE, TAG, "Delta literals truncated");
+
+        // 2. Write literal pixels, splitting the run at channel boundaries
+        while(count > 0) {
+            while(pos >= ch_start + header.pixel_counts[ch_idx]) {
+                ch_start += header.pixel_counts[ch_idx];
+                ch_idx++;
+            }
+
+            uint32_t n = ch_start + header.pixel_counts[ch_idx] - pos;
+            if(n > count) {
+                n = count;
+            }
+
+            err = target.write_pixels(ch_idx, pos - ch_start, ptr, n);
+            if(err != ESP_OK) {
+                ret = err;
+            }
+
+            ptr += n * 3;
+            pos += n;
+            count -= n;
+        }
+    }
+
+    return ret;
+}
+
+esp_err_t FrameReader::rewind() {
+    ESP_RETURN_ON_FALSE(file, ESP_ERR_INVALID_STATE, TAG, "Reader not opened");
+    ESP_RETURN_ON_FALSE(fseek(file, data_offset, SEEK_SET) == 0, ESP_FAIL, TAG, "Seek failed");
+    frame_idx = 0;
+    return ESP_OK;
+}
+
+/**
+ * @brief Index entry of the last keyframe at or before `frame_idx`.
+ */
+int FrameReader::find_keyframe(uint32_t frame_idx) const {
+    int lo = 0;
+    int hi = (int)header.keyframe_num - 1;
+
+    while(lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+        if(index[mid].frame_idx <= frame_idx) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return lo;
+}
+
+/**
+ * @brief Index of the keyframe seek(frame_idx) would land on.
+ */
+uint32_t FrameReader::keyframe_before(uint32_t frame_idx) const {
+    if(!index) {
+        return 0;
+    }
+    return index[find_keyframe(frame_idx)].frame_idx;
+}
+
+/**
+ * @brief Positions the reader on the last keyframe at or before `frame_idx`.
+ *
+ * The next read_frame() decodes that keyframe; get_frame_idx() tells which
+ * frame it is, so the caller knows how many records remain up to `frame_idx`.
+ */
+esp_err_t FrameReader::seek(uint32_t frame_idx) {
+    frame_record_header_t record;
+
+    // 1. State Validation
+    ESP_RETURN_ON_FALSE(file, ESP_ERR_INVALID_STATE, TAG, "Reader not opened");
+    ESP_RETURN_ON_FALSE(frame_idx < header.frame_num, ESP_ERR_INVALID_ARG, TAG, "Frame %lu out of range", (unsigned long)frame_idx);
+
+    // 2. Jump to the keyframe and make sure the index did not lie
+    const frame_index_entry_t* entry = &index[find_keyframe(frame_idx)];
+    ESP_RETURN_ON_FALSE(fseek(file, entry->offset, SEEK_SET) == 0, ESP_FAIL, TAG, "Seek failed");
+    ESP_RETURN_ON_FALSE(fread(&record, sizeof(record), 1, file) == 1 && record.type == FRAME_RECORD_KEY,
+                        ESP_ERR_INVALID_RESPONSE,
+                        TAG,
+                        "No keyframe at frame %lu",
+                        (unsigned long)entry->frame_idx);
+    ESP_RETURN_ON_FALSE(fseek(file, entry->offset, SEEK_SET) == 0, ESP_FAIL, TAG, "Seek failed");
+
+    this->frame_idx = entry->frame_idx;
+    return ESP_OK;
+}
+
+ch_info_t FrameReader::get_ch_info() const {
+    ch_info_t ch_info;
+    memcpy(ch_info.pixel_counts, header.pixel_counts, sizeof(ch_info.pixel_counts));
+    return ch_info;
+}
+
+uint8_t FrameReader::get_fps() const {
+    return header.fps;
+}
+
+uint32_t FrameReader::get_frame_num() const {
+    return header.frame_num;
+}
+
+uint32_t FrameReader::get_frame_idx() const {
+    return frame_idx;
+}
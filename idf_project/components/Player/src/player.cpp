@@ -1,5 +1,6 @@
 #include "player.h"
-#include <math.h>
+#include "color_math.h"
+#include "output_lut.h"
 #include "esp_log.h"
 #include "esp_timer.h"
 #include "state.h"
@@ -7,7 +8,7 @@
 #define NOTIFICATION_UPDATE 1
 #define NOTIFICATION_EVENT 2
 
-Player::Player() {}
+Player::Player(): cur_frame_idx(0), test_fps(PLAYER_TEST_FPS) {}
 
 Player& Player::getInstance() {
     static Player player;
@@ -19,8 +20,9 @@ TaskHandle_t& Player::getTaskHandle() {
 }
 
 void Player::sendEvent(Event& event) {
+    event.local_us = esp_timer_get_time();
     xQueueSend(eventQueue, &event, 1000);
-    xTaskNotify(taskHandle, NOTIFICATION_EVENT, eSetValueWithOverwrite);
+    xTaskNotify(taskHandle, NOTIFICATION_EVENT, eSetBits);
 }
 
 void Player::start() {
@@ -32,7 +34,15 @@ void Player::start() {
 }
 
 esp_err_t Player::createTask() {
+#if PLAYER_DUAL_CORE
+    BaseType_t res = xTaskCreatePinnedToCore(Player::outputTaskEntry, "OutputTask", 4096, NULL, 6, &outputTaskHandle, PLAYER_OUTPUT_CORE);
+    if(res != pdPASS) {
+        return ESP_FAIL;
+    }
+    res = xTaskCreatePinnedToCore(Player::taskEntry, "PlayerTask", 8192, NULL, 5, &taskHandle, PLAYER_RENDER_CORE);
+#else
     BaseType_t res = xTaskCreatePinnedToCore(Player::taskEntry, "PlayerTask", 8192, NULL, 5, &taskHandle, 0);
+#endif
     return (res == pdPASS) ? ESP_OK : ESP_FAIL;
 }
 
@@ -48,41 +58,92 @@ void Player::Loop() {
 
     Event event;
     uint32_t ulNotifiedValue;
+    bool quit = false;
 
-    while(1) {
-        if(xTaskNotifyWait(0, 0, &ulNotifiedValue, portMAX_DELAY) == pdTRUE) {
-            // uint64_t start = esp_timer_get_time();
-            if(ulNotifiedValue == NOTIFICATION_UPDATE) {
-                // ESP_LOGI("player.cpp", "Notified!");
-                update();
-                // uint64_t end = esp_timer_get_time();
-                // ESP_LOGI("Player_Loop()", "loop takes: %llu us", end - start);
-                continue;
-            }
-            if(ulNotifiedValue == NOTIFICATION_EVENT) {
-                if(xQueueReceive(eventQueue, &event, 10)) {
-                    // ESP_LOGI("player.cpp", "Received Event!");
+    while(!quit) {
+        // Notifications are bits, so a tick and an event arriving together are both seen
+        if(xTaskNotifyWait(0, UINT32_MAX, &ulNotifiedValue, portMAX_DELAY) == pdTRUE) {
+            if(ulNotifiedValue & NOTIFICATION_EVENT) {
+                while(!quit && xQueueReceive(eventQueue, &event, 0)) {
                     handleEvent(event);
-                    if(event.type == EVENT_RESET && event.data == 1) {
-                        break;
-                    }
-                } else {
-                    // ESP_LOGI("player.cpp", "xQueueReceive Timeout!");
+                    quit = event.type == EVENT_RESET && event.data == 1;
                 }
             }
-            // uint64_t end = esp_timer_get_time();
-            // ESP_LOGI("Player_Loop()", "loop takes: %llu us", end - start);
+            if(!quit && (ulNotifiedValue & NOTIFICATION_UPDATE)) {
+                update();
+            }
         }
     }
 
     // ESP_LOGI("player.cpp", "Exit Loop!");
 }
 
+void Player::outputTaskEntry(void* pvParameters) {
+    Player::getInstance().outputLoop();
+    vTaskDelete(NULL);
+}
+
+void Player::outputLoop() {
+    FrameBuffer* slot;
+
+    while(1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        while((slot = ring.acquire_read()) != NULL) {
+            int64_t start = esp_timer_get_time();
+            slot->flush(controller);
+            controller.show();
+            frame_stats_record(FRAME_STAGE_OUTPUT, start);
+            ring.release();
+        }
+    }
+}
+
+void Player::drainPipeline() {
+    // A slot is released only after its show(), so an empty ring means the output task is idle
+    while(!ring.empty()) {
+        vTaskDelay(1);
+    }
+}
+
+void Player::printStats() {
+    const show_clock_stats_t& cs = clock.get_stats();
+
+    frame_stats_print();
+    controller.print_pca_health();
+    ESP_LOGI("player.cpp",
+             "clock: %lu syncs (%lu steps), offset last %ld max %lu us, rate %ld ppm",
+             (unsigned long)cs.syncs,
+             (unsigned long)cs.steps,
+             (long)cs.last_offset_us,
+             (unsigned long)cs.max_offset_us,
+             (long)cs.rate_ppm);
+    ESP_LOGI("player.cpp",
+             "clock: %lu ticks, %lu frames skipped, %lu ticks repeated",
+             (unsigned long)cs.ticks,
+             (unsigned long)cs.skipped,
+             (unsigned long)cs.repeated);
+#if PLAYER_DUAL_CORE
+    ESP_LOGI("player.cpp", "ring depth %d, dropped %lu frames", PLAYER_RING_DEPTH, ring.get_drop_count());
+#endif
+}
+
+void Player::resetStats() {
+    frame_stats_reset();
+    controller.reset_pca_health();
+    clock.reset_stats();
+}
+
 void Player::update() {
     currentState->update(*this);
 }
 
 void Player::handleEvent(Event& event) {
+    // Valid in every state
+    if(event.type == EVENT_BRIGHTNESS) {
+        setBrightness((uint8_t)event.data);
+        return;
+    }
     currentState->handleEvent(*this, event);
 }
 
@@ -94,8 +155,9 @@ void Player::changeState(State& newState) {
 
 static bool timer_on_alarm_cb(gptimer_handle_t timer, const gptimer_alarm_event_data_t* edata, void* user_ctx) {
     Player& player = Player::getInstance();
-    xTaskNotify(player.getTaskHandle(), NOTIFICATION_UPDATE, eSetValueWithOverwrite);
-    return false;
+    BaseType_t woken = pdFALSE;
+    xTaskNotifyFromISR(player.getTaskHandle(), NOTIFICATION_UPDATE, eSetBits, &woken);
+    return woken == pdTRUE;
 }
 
 void Player::initTimer() {
@@ -118,6 +180,7 @@ void Player::initTimer() {
 
 void Player::startTimer(int fps) {
     uint32_t period = 1 * 1000 * 1000 / fps;
+    frame_stats_set_budget_us(period);
 
     gptimer_alarm_config_t alarm_config;
     alarm_config.reload_count = 0;
@@ -129,6 +192,19 @@ void Player::startTimer(int fps) {
     gptimer_start(gptimer);
 }
 
+/**
+ * @brief Moves the next alarm to PLAYER_TICK_GUARD_US after the next frame boundary.
+ *
+ * The auto-reload period is 1e6/fps truncated and the anchor moves on every
+ * sync, so the tick phase is corrected on every frame instead of drifting.
+ */
+void Player::alignTimer(int64_t show_us, int fps) {
+    uint32_t period = 1 * 1000 * 1000 / fps;
+    int64_t next_due = ShowClock::frame_time(ShowClock::frame_at(show_us, fps) + 1, fps) + PLAYER_TICK_GUARD_US;
+    int64_t until = next_due - show_us;
+    gptimer_set_raw_count(gptimer, until < period ? period - until : 0);
+}
+
 void Player::stopTimer() {
     gptimer_stop(gptimer);
 }
@@ -138,77 +214,252 @@ void Player::deinitTimer() {
     gptimer_del_timer(gptimer);
 }
 
-void Player::initDrivers() {
-    for(int i = 0; i < WS2812B_NUM; i++) {
-        ch_info.rmt_strips[i] = 100;
+/**
+ * @brief Starts the show clock for EVENT_PLAY, as of the time the event was sent.
+ */
+void Player::startClock(Event& event) {
+    if(event.data == PLAYER_PLAY_FROM) {
+        seekShow(event);
+    }
+    clock.start(event.local_us);
+}
+
+void Player::stopClock() {
+    stopTimer();
+    clock.stop(esp_timer_get_time());
+}
+
+void Player::syncClock(Event& event) {
+    if(clock.sync(event.local_us, event.time_us)) {
+        ESP_LOGI("player.cpp", "Show clock stepped to %lld ms", (long long)(event.time_us / 1000));
     }
-    for(int i = 0; i < PCA9955B_CH_NUM; i++) {
-        ch_info.i2c_leds[i] = 1;
+}
+
+/**
+ * @brief Moves playback to Event::time_us and shows that frame right away.
+ *
+ * Works with the clock running or stopped, so paused scrubbing shows every
+ * target frame.
+ */
+void Player::seekShow(Event& event) {
+    clock.seek(event.local_us, event.time_us);
+    seekFrame(ShowClock::frame_at(event.time_us, getFps()));
+    if(computeFrame() == ESP_OK) {
+        showFrame();
+    }
+}
+
+/**
+ * @brief Changes the master brightness and sends the frame on the LEDs again through the new tables.
+ *
+ * The shadow buffers hold the colours as written and the tables are applied
+ * on the way out, so the next show() resends whatever is on the LEDs (frame,
+ * test pattern) at the new level without rendering it again.
+ */
+void Player::setBrightness(uint8_t brightness) {
+    output_lut_set_brightness(brightness);
+    ESP_LOGI("player.cpp", "Brightness %d", brightness);
+    showFrame();
+}
+
+void Player::initDrivers() {
+    if(reader.open(FRAME_FILE_PATH) == ESP_OK) {
+        ch_info = reader.get_ch_info();
+    } else if(effects.open(EFFECT_FILE_PATH) == ESP_OK) {
+        ch_info = effects.get_ch_info();
+    } else {
+        ESP_LOGW("player.cpp", "No show or effect file, falling back to test frames");
+        for(int i = 0; i < WS2812B_NUM; i++) {
+            ch_info.rmt_strips[i] = 100;
+        }
+        for(int i = 0; i < PCA9955B_CH_NUM; i++) {
+            ch_info.i2c_leds[i] = 1;
+        }
     }
 
     controller.init(ch_info);
 }
 
 void Player::deinitDrivers() {
+    drainPipeline();
+    reader.close();
+    effects.close();
     controller.deinit();
     vTaskDelay(pdMS_TO_TICKS(100));
 }
 
 void Player::resetFrameIndex() {
     cur_frame_idx = 0;
+    if(reader.is_open()) {
+        reader.rewind();
+    }
+    effects.rewind();
+    clock.seek(0, 0);
+}
+
+/**
+ * @brief Positions the reader so the next decoded frames lead up to `frame_idx`.
+ *
+ * Lands on the closest keyframe before it; computeFrame() decodes the rest.
+ */
+void Player::seekFrame(uint32_t frame_idx) {
+    if(!reader.is_open()) {
+        cur_frame_idx = frame_idx;
+        return;
+    }
+    if(reader.get_frame_num() == 0) {
+        return;
+    }
+    if(frame_idx >= reader.get_frame_num()) {
+        frame_idx = reader.get_frame_num() - 1;
+    }
+
+    if(reader.seek(frame_idx) == ESP_OK) {
+        cur_frame_idx = reader.get_frame_idx();
+    } else {
+        reader.rewind();
+        cur_frame_idx = 0;
+    }
+}
+
+int Player::getFps() {
+    if(reader.is_open()) {
+        return reader.get_fps();
+    }
+    return effects.is_open() ? effects.get_fps() : PLAYER_DEFAULT_FPS;
+}
+
+esp_err_t Player::allocateBuffers() {
+#if PLAYER_DUAL_CORE
+    esp_err_t ret = frame.init(ch_info);
+    if(ret == ESP_OK) {
+        ret = ring.init(PLAYER_RING_DEPTH, ch_info);
+    }
+    if(ret != ESP_OK) {
+        ESP_LOGE("player.cpp", "Failed to allocate frame ring: %s", esp_err_to_name(ret));
+    }
+    return ret;
+#else
+    return ESP_OK;
+#endif
+}
+
+void Player::freeBuffers() {
+    ring.deinit();
+    frame.deinit();
+}
+
+FrameTarget& Player::renderTarget() {
+#if PLAYER_DUAL_CORE
+    return frame;
+#else
+    return controller;
+#endif
 }
 
+/**
+ * @brief Renders the frame the show clock says is due now.
+ *
+ * @return
+ * - ESP_OK: A new frame is ready to be shown.
+ * - ESP_ERR_NOT_FINISHED: The clock is still on an already shown frame.
+ * - Other: End of show or read error, nothing new to show.
+ */
+esp_err_t Player::computeFrame() {
+    int64_t start = esp_timer_get_time();
+    int fps = getFps();
+    int64_t show_us = clock.now(start);
+    uint32_t target = ShowClock::frame_at(show_us, fps);
+
+    alignTimer(show_us, fps);
+
+    // 1. Clock behind the frames already rendered: hold, or seek back after a master step
+    uint32_t skipped = 0;
+    if(target < (uint32_t)cur_frame_idx) {
+        if((uint32_t)cur_frame_idx - target <= PLAYER_MAX_HOLD_FRAMES) {
+            clock.count_repeat();
+            return ESP_ERR_NOT_FINISHED;
+        }
+        seekFrame(target);
+    } else {
+        skipped = target - cur_frame_idx;
+    }
+    frame_stats_record_us(FRAME_STAGE_JITTER, (uint32_t)(show_us - ShowClock::frame_time(target, fps)));
+
+    // 2. Late tick: deltas are cumulative, so missed frames are decoded but not shown,
+    //    starting from the closest keyframe when that saves records
+    if(!reader.is_open() || reader.keyframe_before(target) > (uint32_t)cur_frame_idx) {
+        seekFrame(target);
+    }
+    esp_err_t ret = ESP_OK;
+    bool rendered = false;
+    while(ret == ESP_OK && (uint32_t)cur_frame_idx <= target) {
+        ret = decodeNextFrame();
+        rendered |= ret == ESP_OK;
+    }
+    frame_stats_record(FRAME_STAGE_COMPUTE, start);
+    if(!rendered) {
+        return ret;
+    }
+
+    clock.count_tick(skipped);
+    return ESP_OK;
+}
+
+esp_err_t Player::decodeNextFrame() {
+    if(effects.is_open()) {
+        esp_err_t ret = effects.render(renderTarget(), (uint32_t)(ShowClock::frame_time(cur_frame_idx, getFps()) / 1000));
+        if(ret == ESP_OK) {
+            frame.frame_idx = cur_frame_idx++;
+        }
+        return ret;
+    }
+    if(!reader.is_open()) {
+        computeTestFrame(cur_frame_idx++);
+        return ESP_OK;
+    }
+
+    esp_err_t ret = reader.read_frame(renderTarget());
+    if(ret == ESP_OK) {
+        cur_frame_idx++;
+    }
+    return ret;
+}
+
+/**
+ * @brief Hue cycling once per 360 frames, value breathing between 0.6 and 1.0, at quarter brightness.
+ *
+ * Integer only (color_math.h), like every other render path.
+ */
 void Player::computeTestFrame(int frame_idx) {
     uint8_t max_brightness = 63;
-    float r = 0.0f, g = 0.0f, b = 0.0f;
-
-    float H = (frame_idx * 360 / 360) % 360;
-    float S = 1.0f;
-    float V = 0.8f + 0.2f * sinf(frame_idx * 0.05f);
-
-    float h = H / 360.0f;
-    float s = S;
-    float v = V;
-
-    int i = floor(h * 6);
-    float f = h * 6 - i;
-    float p = v * (1 - s);
-    float q = v * (1 - f * s);
-    float t = v * (1 - (1 - f) * s);
-
-    switch(i % 6) {
-        case 0:
-            r = v, g = t, b = p;
-            break;
-        case 1:
-            r = q, g = v, b = p;
-            break;
-        case 2:
-            r = p, g = v, b = t;
-            break;
-        case 3:
-            r = p, g = q, b = v;
-            break;
-        case 4:
-            r = t, g = p, b = v;
-            break;
-        case 5:
-            r = v, g = p, b = q;
-            break;
-        default:
-            break;
-    }
-
-    uint8_t R = (uint8_t)(r * max_brightness);
-    uint8_t G = (uint8_t)(g * max_brightness);
-    uint8_t B = (uint8_t)(b * max_brightness);
-
-    // ESP_LOGI("test", "R: %d, G: %d, B: %d", R, G, B);
-
-    controller.fill(R, G, B);
+    uint8_t grb[3];
+
+    uint8_t hue = (uint8_t)((frame_idx % 360) * 256 / 360);
+    uint8_t theta = (uint8_t)(((uint32_t)frame_idx * 522) >> 8);  // 0.05 rad per frame
+    uint8_t val = (uint8_t)(204 + color_sin8(theta) * 51 / 127);
+
+    color_hsv_to_grb(hue, 255, color_scale8(val, max_brightness), grb);
+
+    frame.frame_idx = frame_idx;
+    renderTarget().fill(grb[1], grb[0], grb[2]);
 }
 
 void Player::showFrame() {
+#if PLAYER_DUAL_CORE
+    FrameBuffer* slot = ring.acquire_write();
+    if(slot == NULL) {
+        // Output core is behind: the changes stay in the working frame and go out with the next slot
+        ring.count_drop();
+        return;
+    }
+    frame.copy_dirty_to(*slot);
+    ring.publish();
+    xTaskNotifyGive(outputTaskHandle);
+#else
     // controller.print_buffer();
+    int64_t start = esp_timer_get_time();
     controller.show();
+    frame_stats_record(FRAME_STAGE_OUTPUT, start);
+#endif
 }
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include "show_clock.h"
+
+#include <string.h>
+
+ShowClock::ShowClock(): anchor_local_us(0), anchor_show_us(0), ref_local_us(0), ref_master_us(0), has_ref(false), running(false) {
+    memset(&stats, 0, sizeof(stats));
+}
+
+/**
+ * @brief Moves the clock to `show_us` at `local_us`; a stopped clock stays stopped there.
+ */
+void ShowClock::seek(int64_t local_us, int64_t show_us) {
+    anchor_local_us = local_us;
+    anchor_show_us = show_us;
+    has_ref = false;
+}
+
+/**
+ * @brief Runs the clock from its current position, as of `local_us`.
+ */
+void ShowClock::start(int64_t local_us) {
+    if(running) {
+        return;
+    }
+    anchor_local_us = local_us;
+    has_ref = false;  // The master may have paused too, restart the rate measurement
+    running = true;
+}
+
+void ShowClock::stop(int64_t local_us) {
+    if(!running) {
+        return;
+    }
+    anchor_show_us = now(local_us);
+    anchor_local_us = local_us;
+    running = false;
+}
+
+bool ShowClock::is_running() const {
+    return running;
+}
+
+int64_t ShowClock::now(int64_t local_us) const {
+    if(!running) {
+        return anchor_show_us;
+    }
+
+    int64_t elapsed = local_us - anchor_local_us;
+    return anchor_show_us + elapsed + elapsed * stats.rate_ppm / 1000000;
+}
+
+/**
+ * @brief Re-anchors the clock to a master timestamp.
+ *
+ * @param[in] local_us  Local time at which master_us was valid.
+ * @param[in] master_us Master show time.
+ *
+ * @return true if the offset was a step (master seek) rather than drift.
+ */
+bool ShowClock::sync(int64_t local_us, int64_t master_us) {
+    int64_t offset = master_us - now(local_us);
+    bool step = offset > SHOW_CLOCK_STEP_US || offset < -SHOW_CLOCK_STEP_US;
+
+    // 1. Rate of the master against the local clock since the reference sync
+    if(step || !running || !has_ref) {
+        ref_local_us = local_us;
+        ref_master_us = master_us;
+        has_ref = running;
+    } else if(local_us - ref_local_us >= SHOW_CLOCK_MIN_BASELINE_US) {
+        int64_t local_elapsed = local_us - ref_local_us;
+        int64_t rate = ((master_us - ref_master_us) - local_elapsed) * 1000000 / local_elapsed;
+        if(rate > SHOW_CLOCK_MAX_PPM) {
+            rate = SHOW_CLOCK_MAX_PPM;
+        }
+        if(rate < -SHOW_CLOCK_MAX_PPM) {
+            rate = -SHOW_CLOCK_MAX_PPM;
+        }
+        stats.rate_ppm = (int32_t)rate;
+    }
+
+    // 2. Move the anchor
+    anchor_local_us = local_us;
+    anchor_show_us = master_us;
+
+    // 3. Statistics
+    stats.syncs++;
+    stats.last_offset_us = (int32_t)offset;
+    if(step) {
+        stats.steps++;
+    } else {
+        uint32_t abs_offset = (uint32_t)(offset < 0 ? -offset : offset);
+        if(abs_offset > stats.max_offset_us) {
+            stats.max_offset_us = abs_offset;
+        }
+    }
+
+    return step;
+}
+
+uint32_t ShowClock::frame_at(int64_t show_us, int fps) {
+    if(show_us <= 0) {
+        return 0;
+    }
+    return (uint32_t)(show_us * fps / 1000000);
+}
+
+int64_t ShowClock::frame_time(uint32_t frame_idx, int fps) {
+    // Round up so frame_at(frame_time(i)) == i
+    return ((int64_t)frame_idx * 1000000 + fps - 1) / fps;
+}
+
+void ShowClock::count_tick(uint32_t skipped) {
+    stats.ticks++;
+    stats.skipped += skipped;
+}
+
+void ShowClock::count_repeat() {
+    stats.repeated++;
+}
+
+const show_clock_stats_t& ShowClock::get_stats() const {
+    return stats;
+}
+
+void ShowClock::reset_stats() {
+    int32_t rate_ppm = stats.rate_ppm;
+    memset(&stats, 0, sizeof(stats));
+    stats.rate_ppm = rate_ppm;  // Not a statistic, the clock keeps using it
+}
@@ -1,5 +1,6 @@
 #include "state.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 
 // ================= ResetState =================
 
@@ -14,7 +15,7 @@ void ResetState::enter(Player& player) {
 #endif
     player.deinitTimer();
     player.deinitDrivers();
-    // player.freeBuffers()
+    player.freeBuffers();
 
     player.changeState(ReadyState::getInstance());
 }
@@ -48,7 +49,7 @@ void ReadyState::enter(Player& player) {
 
     player.initTimer();
     player.initDrivers();
-    // player.allocateBuffers();
+    player.allocateBuffers();
     player.resetFrameIndex();
     vTaskDelay(pdMS_TO_TICKS(1));
 }
@@ -63,9 +64,14 @@ void ReadyState::exit(Player& player) {
 
 void ReadyState::handleEvent(Player& player, Event& event) {
     if(event.type == EVENT_PLAY) {
+        player.startClock(event);
         player.changeState(PlayingState::getInstance());
     }
+    if(event.type == EVENT_SEEK) {
+        player.seekShow(event);
+    }
     if(event.type == EVENT_TEST) {
+        player.test_fps = event.data ? event.data : PLAYER_TEST_FPS;
         player.changeState(TestState::getInstance());
     }
     if(event.type == EVENT_RESET && event.data == 0) {
@@ -74,6 +80,7 @@ void ReadyState::handleEvent(Player& player, Event& event) {
     if(event.type == EVENT_RESET && event.data == 1) {
         player.deinitTimer();
         player.deinitDrivers();
+        player.freeBuffers();
     }
 }
 void ReadyState::update(Player& player) {
@@ -93,12 +100,12 @@ void PlayingState::enter(Player& player) {
     ESP_LOGI("state.cpp", "Enter Playing!");
 #endif
 
-    player.startTimer(30);
+    player.startTimer(player.getFps());
     player.update();
 }
 
 void PlayingState::exit(Player& player) {
-    player.stopTimer();
+    player.stopClock();
 
 #if SHOW_TRANSITION
     ESP_LOGI("state.cpp", "Exit Playing!");
@@ -112,13 +119,19 @@ void PlayingState::handleEvent(Player& player, Event& event) {
     if(event.type == EVENT_RESET) {
         player.changeState(ResetState::getInstance());
     }
+    if(event.type == EVENT_SYNC) {
+        player.syncClock(event);
+    }
+    if(event.type == EVENT_SEEK || (event.type == EVENT_PLAY && event.data == PLAYER_PLAY_FROM)) {
+        player.seekShow(event);
+    }
 }
 void PlayingState::update(Player& player) {
-    // player.computeFrame();
-    // player.showFrame();
-
-    player.computeTestFrame(player.cur_frame_idx++);
-    player.controller.show();
+    // Hold the current frame if the clock has not reached the next one or the show has ended
+    if(player.computeFrame() != ESP_OK) {
+        return;
+    }
+    player.showFrame();
 #if SHOW_TRANSITION
     ESP_LOGI("state.cpp", "Update!");
 #endif
@@ -147,8 +160,12 @@ void PauseState::exit(Player& player) {
 
 void PauseState::handleEvent(Player& player, Event& event) {
     if(event.type == EVENT_PLAY) {
+        player.startClock(event);
         player.changeState(PlayingState::getInstance());
     }
+    if(event.type == EVENT_SEEK) {
+        player.seekShow(event);
+    }
     if(event.type == EVENT_RESET) {
         player.changeState(ResetState::getInstance());
     }
@@ -169,7 +186,7 @@ void TestState::enter(Player& player) {
     ESP_LOGI("state.cpp", "Enter Test!");
 #endif
 
-    player.startTimer(1);
+    player.startTimer(player.test_fps);
     player.update();
 }
 
@@ -188,10 +205,10 @@ void TestState::handleEvent(Player& player, Event& event) {
 }
 
 void TestState::update(Player& player) {
+    int64_t start = esp_timer_get_time();
     player.computeTestFrame(player.cur_frame_idx++);
-
-    // player.controller.print_buffer();
-    player.controller.show();
+    frame_stats_record(FRAME_STAGE_COMPUTE, start);
+    player.showFrame();
 
 #if SHOW_TRANSITION
     ESP_LOGI("state.cpp", "Update!");
@@ -0,0 +1,136 @@
+"""Encode an effect cue list into the binary format read by EffectEngine.
+
+Layout mirrors components/Player/include/effect_format.h.
+
+Input is a JSON file:
+    {
+        "fps": 30,
+        "duration_ms": 60000,                          # 0 = run until stopped
+        "pixel_counts": [100, 100, ..., 1, 1, ...],   # WS2812B_NUM + PCA9955B_CH_NUM entries
+        "cues": [
+            {"start_ms": 0, "channels": [0, 1], "effect": "rainbow", "speed": 16, "amount": 128},
+            {"start_ms": 4000, "channels": "all", "effect": "chase", "speed": 30, "size": 5,
+             "color_a": [255, 0, 0], "color_b": [0, 0, 32]}
+        ]
+    }
+
+Cues are sorted by start time; a channel keeps its effect until a later cue
+names it. See effect_type_t for what speed, size and amount mean per effect.
+
+Usage:
+    python effect_encoder.py show.json show.fx
+    python effect_encoder.py --demo show.fx
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+WS2812B_NUM = 8
+PCA9955B_CH_NUM = 5 * 6
+CH_NUM = WS2812B_NUM + PCA9955B_CH_NUM
+
+MAGIC = b"LDFX"
+VERSION = 1
+MAX_CUES = 1024
+
+EFFECTS = ["off", "solid", "gradient", "chase", "rainbow", "strobe", "sparkle", "wipe"]
+
+
+def encode_header(fps, cue_num, duration_ms, pixel_counts):
+    if len(pixel_counts) != CH_NUM:
+        raise ValueError(f"expected {CH_NUM} channels, got {len(pixel_counts)}")
+    header = MAGIC + struct.pack("<BBHII", VERSION, fps, CH_NUM, cue_num, duration_ms)
+    header += struct.pack(f"<{CH_NUM}H", *pixel_counts)
+    return header
+
+
+def channel_mask(channels):
+    if channels == "all":
+        return (1 << CH_NUM) - 1
+    mask = 0
+    for ch_idx in channels:
+        if not 0 <= ch_idx < CH_NUM:
+            raise ValueError(f"channel {ch_idx} out of range")
+        mask |= 1 << ch_idx
+    return mask
+
+
+def encode_cue(cue):
+    r_a, g_a, b_a = cue.get("color_a", (0, 0, 0))
+    r_b, g_b, b_b = cue.get("color_b", (0, 0, 0))
+    return struct.pack(
+        "<IQBBBB3B3B",
+        cue["start_ms"],
+        channel_mask(cue.get("channels", "all")),
+        EFFECTS.index(cue["effect"]),
+        cue.get("speed", 0),
+        cue.get("size", 0),
+        cue.get("amount", 0),
+        g_a, r_a, b_a,  # GRB like the frame buffers
+        g_b, r_b, b_b,
+    )
+
+
+def write_effects(path, fps, duration_ms, pixel_counts, cues):
+    cues = sorted(cues, key=lambda cue: cue["start_ms"])
+    if len(cues) > MAX_CUES:
+        raise ValueError(f"{len(cues)} cues exceed the {MAX_CUES} cue limit")
+
+    data = encode_header(fps, len(cues), duration_ms, pixel_counts)
+    data += b"".join(encode_cue(cue) for cue in cues)
+    with open(path, "wb") as f:
+        f.write(data)
+    return len(cues), len(data)
+
+
+def demo_cues():
+    """A minute cycling every effect over the strips, slow rainbow on the PCA9955B LEDs."""
+    strips = list(range(WS2812B_NUM))
+    cues = [{"start_ms": 0, "channels": list(range(WS2812B_NUM, CH_NUM)), "effect": "rainbow", "speed": 4, "size": 6, "amount": 96}]
+    for idx, effect in enumerate(EFFECTS[1:]):
+        cues.append(
+            {
+                "start_ms": idx * 8000,
+                "channels": strips,
+                "effect": effect,
+                "speed": 30,
+                "size": 5,
+                "amount": 64,
+                "color_a": (96, 0, 48),
+                "color_b": (0, 0, 16),
+            }
+        )
+    return cues
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Encode a LightDance effect cue file")
+    parser.add_argument("input", nargs="?", help="JSON cue list")
+    parser.add_argument("output", help="binary effect file")
+    parser.add_argument("--demo", action="store_true", help="write a demo cycling through every effect instead of reading input")
+    parser.add_argument("--fps", type=int, default=30)
+    args = parser.parse_args()
+
+    if args.demo:
+        pixel_counts = [100] * WS2812B_NUM + [1] * PCA9955B_CH_NUM
+        cues = demo_cues()
+        fps = args.fps
+        duration_ms = len(EFFECTS[1:]) * 8000
+    elif args.input:
+        with open(args.input) as f:
+            show = json.load(f)
+        pixel_counts = show["pixel_counts"]
+        cues = show["cues"]
+        fps = show.get("fps", args.fps)
+        duration_ms = show.get("duration_ms", 0)
+    else:
+        parser.error("either an input file or --demo is required")
+
+    count, size = write_effects(args.output, fps, duration_ms, pixel_counts, cues)
+    print(f"wrote {count} cues ({size} bytes) to {args.output}")
+
+
+if __name__ == "__main__":
+    sys.exit(main())
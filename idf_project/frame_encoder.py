@@ -0,0 +1,186 @@
+"""Encode a show into the binary frame-stream format read by FrameReader.
+
+Layout mirrors components/Player/include/frame_format.h.
+
+Input is a JSON file:
+    {
+        "fps": 30,
+        "pixel_counts": [100, 100, ..., 1, 1, ...],   # WS2812B_NUM + PCA9955B_CH_NUM entries
+        "frames": [ [ [[r, g, b], ...], ... ], ... ]    # frame -> channel -> pixel
+    }
+
+Frames are stored as a keyframe every --keyframe-interval frames (or whenever a
+delta would not be smaller) and sparse deltas in between. A keyframe index at
+the end of the file lets the player seek without replaying from frame 0.
+
+Usage:
+    python frame_encoder.py show.json show.bin
+    python frame_encoder.py --synthetic 1000 show.bin
+    python frame_encoder.py --keyframe-interval 1 show.json raw.bin   # keyframes only
+"""
+
+import argparse
+import colorsys
+import json
+import struct
+import sys
+
+WS2812B_NUM = 8
+PCA9955B_CH_NUM = 5 * 6
+CH_NUM = WS2812B_NUM + PCA9955B_CH_NUM
+
+MAGIC = b"LDFS"
+VERSION = 3
+
+RECORD_KEY = 0
+RECORD_DELTA = 1
+MAX_RECORD_SIZE = 0xFFFF
+HEADER_SIZE = 4 + struct.calcsize("<BBHIIIHHII") + CH_NUM * 2
+
+
+def encode_header(fps, frame_num, pixel_counts, max_record_size, keyframe_interval, index_offset, keyframe_num):
+    if len(pixel_counts) != CH_NUM:
+        raise ValueError(f"expected {CH_NUM} channels, got {len(pixel_counts)}")
+    stride = sum(pixel_counts) * 3
+    header = MAGIC + struct.pack(
+        "<BBHIIIHHII", VERSION, fps, CH_NUM, frame_num, stride, max_record_size, keyframe_interval, 0, index_offset, keyframe_num
+    )
+    header += struct.pack(f"<{CH_NUM}H", *pixel_counts)
+    return header
+
+
+def encode_index(records):
+    """(frame index, file offset) of every keyframe record."""
+    out = bytearray()
+    offset = HEADER_SIZE
+    for frame_idx, record in enumerate(records):
+        if record[0] == RECORD_KEY:
+            out += struct.pack("<II", frame_idx, offset)
+        offset += len(record)
+    return bytes(out)
+
+
+def encode_varint(value):
+    out = bytearray()
+    while True:
+        byte = value & 0x7F
+        value >>= 7
+        if value:
+            out.append(byte | 0x80)
+        else:
+            out.append(byte)
+            return bytes(out)
+
+
+def encode_delta(prev, cur):
+    """Runs of (skip unchanged pixels, literal changed pixels) over flat GRB frames."""
+    out = bytearray()
+    pixel_num = len(cur) // 3
+    pos = 0
+    last = 0
+    while pos < pixel_num:
+        if cur[pos * 3:pos * 3 + 3] == prev[pos * 3:pos * 3 + 3]:
+            pos += 1
+            continue
+        start = pos
+        while pos < pixel_num and cur[pos * 3:pos * 3 + 3] != prev[pos * 3:pos * 3 + 3]:
+            pos += 1
+        out += encode_varint(start - last) + encode_varint(pos - start)
+        out += cur[start * 3:pos * 3]
+        last = pos
+    return bytes(out)
+
+
+def encode_record(record_type, payload):
+    return struct.pack("<BH", record_type, len(payload)) + payload
+
+
+def encode_frame(frame, pixel_counts):
+    out = bytearray()
+    for ch_idx, count in enumerate(pixel_counts):
+        pixels = frame[ch_idx] if ch_idx < len(frame) else []
+        for p in range(count):
+            r, g, b = pixels[p] if p < len(pixels) else (0, 0, 0)
+            out += bytes((g, r, b))  # GRB on the wire
+    return bytes(out)
+
+
+def write_show(path, fps, pixel_counts, frames, keyframe_interval=30):
+    stride = sum(pixel_counts) * 3
+    if stride > MAX_RECORD_SIZE:
+        raise ValueError(f"frame of {stride} bytes exceeds the {MAX_RECORD_SIZE} byte record limit")
+
+    records = []
+    prev = None
+    since_key = 0
+    for frame in frames:
+        cur = encode_frame(frame, pixel_counts)
+        delta = encode_delta(prev, cur) if prev is not None and since_key + 1 < keyframe_interval else None
+        if delta is None or len(delta) >= stride:
+            records.append(encode_record(RECORD_KEY, cur))
+            since_key = 0
+        else:
+            records.append(encode_record(RECORD_DELTA, delta))
+            since_key += 1
+        prev = cur
+
+    max_record_size = max([stride] + [len(r) - 3 for r in records])
+    keyframes = sum(1 for r in records if r[0] == RECORD_KEY)
+    index_offset = HEADER_SIZE + sum(len(r) for r in records)
+    with open(path, "wb") as f:
+        f.write(encode_header(fps, len(records), pixel_counts, max_record_size, keyframe_interval, index_offset, keyframes))
+        for record in records:
+            f.write(record)
+        f.write(encode_index(records))
+
+    encoded = sum(len(r) for r in records)
+    return len(records), keyframes, encoded
+
+
+def synthetic_show(frame_num, pixel_counts):
+    """Static rainbow background with a short comet running along every strip."""
+    for idx in range(frame_num):
+        frame = []
+        for ch_idx, count in enumerate(pixel_counts):
+            pixels = []
+            head = (idx + ch_idx * 7) % max(count, 1)
+            for p in range(count):
+                h = ((ch_idx * 40 + p * 3 + (idx // 30) * 20) % 360) / 360.0
+                v = 0.25 if 0 <= head - p < 5 else 0.05
+                r, g, b = colorsys.hsv_to_rgb(h, 1.0, v)
+                pixels.append((int(r * 255), int(g * 255), int(b * 255)))
+            frame.append(pixels)
+        yield frame
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Encode a LightDance show file")
+    parser.add_argument("input", nargs="?", help="JSON show description")
+    parser.add_argument("output", help="binary show file")
+    parser.add_argument("--synthetic", type=int, metavar="FRAMES", help="generate a comet test show instead of reading input")
+    parser.add_argument("--fps", type=int, default=30)
+    parser.add_argument("--keyframe-interval", type=int, default=30, help="maximum frames between keyframes, bounds the seek cost (1 = raw frames)")
+    args = parser.parse_args()
+
+    if args.synthetic:
+        pixel_counts = [100] * WS2812B_NUM + [1] * PCA9955B_CH_NUM
+        frames = synthetic_show(args.synthetic, pixel_counts)
+        fps = args.fps
+    elif args.input:
+        with open(args.input) as f:
+            show = json.load(f)
+        pixel_counts = show["pixel_counts"]
+        frames = show["frames"]
+        fps = show.get("fps", args.fps)
+    else:
+        parser.error("either an input file or --synthetic is required")
+
+    count, keyframes, encoded = write_show(args.output, fps, pixel_counts, frames, max(1, args.keyframe_interval))
+    stride = sum(pixel_counts) * 3
+    print(f"wrote {count} frames ({keyframes} keyframes) to {args.output}")
+    if count:
+        print(f"raw {stride} bytes/frame, encoded {encoded / count:.1f} bytes/frame ({stride * count / max(encoded, 1):.1f}x)")
+
+
+if __name__ == "__main__":
+    sys.exit(main())
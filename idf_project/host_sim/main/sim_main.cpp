@@ -0,0 +1,1542 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "LedController.hpp"
+#include "color_math.h"
+#include "effect_engine.h"
+#include "frame_buffer.h"
+#include "frame_reader.h"
+#include "led_sim.h"
+#include "output_lut.h"
+#include "show_clock.h"
+
+#define SIM_PIXEL_NUM 100
+#define SIM_FRAME_NUM 300
+#define SIM_REALTIME_FRAME_NUM 60
+#define PCA9955B_PWM0_REG 0x08
+#define PCA9955B_IREFALL_REG 0x45
+#define SIM_I2C_MAX_HZ 800000     // Wiring limit: the probe must settle on the 700 kHz step
+#define SIM_I2C_SETTLED_HZ 700000
+
+#define ENCODER_BENCH_ROUNDS 2000
+#define ENCODER_BENCH_SYMBOLS (SIM_PIXEL_NUM * 3 * 8 + 1)
+
+#define COLOR_BENCH_PIXELS (1000 * 1000)
+#define LUT_BENCH_ROUNDS 20000
+#define DITHER_BRIGHTNESS 64  // 25%, where the show runs most of the time
+
+#define EFFECT_BENCH_FRAMES 300
+#define EFFECT_BENCH_FRAME_MS 33
+
+#define SHOW_SIM_PATH "sim_show.bin"
+#define SHOW_SIM_FRAMES 90
+#define SHOW_SIM_KEYFRAME_INTERVAL 30
+#define SHOW_SIM_PIXEL_NUM (WS2812B_NUM * SIM_PIXEL_NUM + PCA9955B_CH_NUM)
+#define SHOW_SIM_STRIDE (SHOW_SIM_PIXEL_NUM * 3)
+#define SHOW_BENCH_ROUNDS 20
+
+#define CLOCK_SIM_FPS 30
+#define CLOCK_SIM_SHOW_US (5LL * 60 * 1000 * 1000)
+#define CLOCK_SIM_DRIFT_PPM 200
+#define CLOCK_SIM_SYNC_US (1000 * 1000)
+
+static const char* TAG = "led_sim";
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    ESP_LOGI(TAG, "%-40s %s", what, ok ? "ok" : "FAILED");
+    if(!ok) {
+        failures++;
+    }
+}
+
+static void render_frame(FrameTarget& target, int frame_idx, int strip_num = WS2812B_NUM) {
+    uint8_t strip[SIM_PIXEL_NUM * 3];
+
+    for(int ch = 0; ch < strip_num; ch++) {
+        for(int p = 0; p < SIM_PIXEL_NUM * 3; p++) {
+            strip[p] = (uint8_t)(frame_idx * 7 + ch * 31 + p);
+        }
+        target.write_pixels(ch, 0, strip, SIM_PIXEL_NUM);
+    }
+    for(int ch = 0; ch < PCA9955B_CH_NUM; ch++) {
+        uint8_t grb[3] = {(uint8_t)frame_idx, (uint8_t)(frame_idx + ch), (uint8_t)ch};
+        target.write_pixels(WS2812B_NUM + ch, 0, grb, 1);
+    }
+}
+
+/**
+ * @brief Every strip must receive exactly the rendered bytes with valid WS2812B timing.
+ */
+static void check_encoder(LedController& controller) {
+    uint8_t expected[SIM_PIXEL_NUM * 3];
+    uint8_t received[SIM_PIXEL_NUM * 3];
+    bool frames_ok = true;
+    bool timing_ok = true;
+    int64_t first_start = INT64_MAX;
+    int64_t last_start = 0;
+
+    render_frame(controller, 1);
+    controller.show();
+    controller.wait_done();
+
+    for(int ch = 0; ch < WS2812B_NUM; ch++) {
+        led_sim_rmt_stats_t stats;
+        led_sim_rmt_get_stats(BOARD_HW_CONFIG.rmt_pins[ch], &stats);
+
+        for(int p = 0; p < SIM_PIXEL_NUM * 3; p++) {
+            expected[p] = (uint8_t)(1 * 7 + ch * 31 + p);
+        }
+        size_t len = led_sim_rmt_get_frame(BOARD_HW_CONFIG.rmt_pins[ch], received, sizeof(received));
+        frames_ok &= len == sizeof(expected) && memcmp(expected, received, sizeof(expected)) == 0;
+        timing_ok &= stats.timing_errors == 0;
+        first_start = stats.start_us < first_start ? stats.start_us : first_start;
+        last_start = stats.start_us > last_start ? stats.start_us : last_start;
+    }
+
+    check(frames_ok, "WS2812B frames decode to the buffer");
+    check(timing_ok, "WS2812B bit timing within datasheet");
+
+    // Wire start skew between the first and the last strip
+    ESP_LOGI(TAG, "WS2812B start skew %lld us (%s)", (long long)(last_start - first_start), WS2812B_USE_SYNC ? "sync manager" : "back to back");
+#if WS2812B_USE_SYNC
+    check(last_start == first_start, "WS2812B strips start together");
+#endif
+}
+
+static uint32_t total_transactions() {
+    uint32_t transactions = 0;
+
+    for(int i = 0; i < WS2812B_NUM; i++) {
+        led_sim_rmt_stats_t stats;
+        led_sim_rmt_get_stats(BOARD_HW_CONFIG.rmt_pins[i], &stats);
+        transactions += stats.transactions;
+    }
+    return transactions;
+}
+
+/**
+ * @brief Rewriting the same frame must not reach the wire; changing one strip must
+ *        replay the front buffers of the others (sync group) unchanged, from the
+ *        symbol cache when WS2812B_SYMBOL_CACHE is on.
+ */
+static void check_frame_hold(LedController& controller) {
+    uint8_t received[SIM_PIXEL_NUM * 3];
+    uint8_t strip[SIM_PIXEL_NUM * 3];
+
+    render_frame(controller, 5);
+    controller.show();
+    controller.wait_done();
+
+    // 1. Hold
+    uint32_t before = total_transactions();
+    int64_t start = esp_timer_get_time();
+    for(int i = 0; i < 10; i++) {
+        render_frame(controller, 5);
+        controller.show();
+    }
+    int64_t hold_us = (esp_timer_get_time() - start) / 10;
+    check(total_transactions() == before, "Held frames not retransmitted");
+
+    // 2. One strip changes
+    memset(strip, 0x42, sizeof(strip));
+    controller.write_pixels(0, 0, strip, SIM_PIXEL_NUM);
+    start = esp_timer_get_time();
+    controller.show();
+    int64_t change_us = esp_timer_get_time() - start;
+    controller.wait_done();
+
+    bool frames_ok = led_sim_rmt_get_frame(BOARD_HW_CONFIG.rmt_pins[0], received, sizeof(received)) == sizeof(strip) &&
+                     memcmp(received, strip, sizeof(strip)) == 0;
+    for(int ch = 1; ch < WS2812B_NUM; ch++) {
+        for(int p = 0; p < SIM_PIXEL_NUM * 3; p++) {
+            strip[p] = (uint8_t)(5 * 7 + ch * 31 + p);
+        }
+        frames_ok &= led_sim_rmt_get_frame(BOARD_HW_CONFIG.rmt_pins[ch], received, sizeof(received)) == sizeof(strip) &&
+                     memcmp(received, strip, sizeof(strip)) == 0;
+    }
+    ESP_LOGI(TAG,
+             "show(): %lld us/frame held, %lld us with one strip changed (%lu transactions)",
+             (long long)hold_us,
+             (long long)change_us,
+             (unsigned long)(total_transactions() - before));
+    check(total_transactions() - before == (WS2812B_USE_SYNC ? WS2812B_NUM : 1), "Only changed strips resent (all when synchronised)");
+    check(frames_ok, WS2812B_SYMBOL_CACHE ? "Cached frames replayed unchanged" : "Unchanged strips keep their frames");
+}
+
+/**
+ * @brief Changing a few pixels must only send the strip up to the last changed one.
+ */
+static void check_dirty_prefix(LedController& controller) {
+    uint8_t expected[SIM_PIXEL_NUM * 3];
+    uint8_t received[SIM_PIXEL_NUM * 3];
+    const uint8_t pixel[3] = {1, 2, 3};
+    led_sim_rmt_stats_t before, after;
+
+    // 1. Sync group repeats would resend every strip, compare a single strip
+    led_sim_rmt_get_frame(BOARD_HW_CONFIG.rmt_pins[1], expected, sizeof(expected));
+    led_sim_rmt_get_stats(BOARD_HW_CONFIG.rmt_pins[1], &before);
+    controller.write_pixels(1, 4, pixel, 1);
+    controller.write_pixels(1, 9, expected + 9 * 3, 20);  // Same colours, not dirty on the wire
+    controller.show();
+    controller.wait_done();
+    led_sim_rmt_get_stats(BOARD_HW_CONFIG.rmt_pins[1], &after);
+
+    memcpy(expected + 4 * 3, pixel, sizeof(pixel));
+    bool frame_ok = led_sim_rmt_get_frame(BOARD_HW_CONFIG.rmt_pins[1], received, sizeof(received)) == sizeof(expected) &&
+                    memcmp(received, expected, sizeof(expected)) == 0;
+    ESP_LOGI(TAG, "one pixel changed: %llu of %d bytes sent", (unsigned long long)(after.bytes - before.bytes), SIM_PIXEL_NUM * 3);
+    check(after.bytes - before.bytes == 5 * 3, "Only the dirty prefix sent");
+    check(frame_ok, "Pixels after the prefix keep their colour");
+}
+
+/**
+ * @brief Encodes one strip with an encoder type; returns symbols per us of host CPU.
+ */
+static double bench_encoder(ws2812b_encoder_type_t type, const uint8_t* payload, rmt_symbol_word_t* symbols, size_t* symbol_num) {
+    rmt_encoder_handle_t encoder = NULL;
+
+    if(rmt_new_encoder_with_type(type, &encoder) != ESP_OK) {
+        return 0.0;
+    }
+    *symbol_num = led_sim_rmt_encode(encoder, payload, SIM_PIXEL_NUM * 3, 64, symbols, ENCODER_BENCH_SYMBOLS);
+
+    int64_t start = esp_timer_get_time();
+    for(int i = 0; i < ENCODER_BENCH_ROUNDS; i++) {
+        led_sim_rmt_encode(encoder, payload, SIM_PIXEL_NUM * 3, 64, NULL, 0);
+    }
+    int64_t elapsed = esp_timer_get_time() - start;
+
+    rmt_del_encoder(encoder);
+    return elapsed > 0 ? (double)*symbol_num * ENCODER_BENCH_ROUNDS / elapsed : 0.0;
+}
+
+/**
+ * @brief The lookup-table encoder must produce exactly the two-stage encoder's symbols.
+ */
+static void check_lut_encoder() {
+    static rmt_symbol_word_t bytes_symbols[ENCODER_BENCH_SYMBOLS];
+    static rmt_symbol_word_t lut_symbols[ENCODER_BENCH_SYMBOLS];
+    uint8_t payload[SIM_PIXEL_NUM * 3];
+    size_t bytes_num = 0;
+    size_t lut_num = 0;
+
+    for(int i = 0; i < (int)sizeof(payload); i++) {
+        payload[i] = (uint8_t)(i * 73 + 11);
+    }
+
+    double bytes_rate = bench_encoder(WS2812B_ENCODER_BYTES, payload, bytes_symbols, &bytes_num);
+    double lut_rate = bench_encoder(WS2812B_ENCODER_LUT, payload, lut_symbols, &lut_num);
+
+    ESP_LOGI(TAG, "encoder (64-symbol block): bytes %.1f symbols/us, LUT %.1f symbols/us", bytes_rate, lut_rate);
+    check(lut_num == ENCODER_BENCH_SYMBOLS && bytes_num == lut_num && memcmp(bytes_symbols, lut_symbols, sizeof(lut_symbols)) == 0,
+          "LUT encoder matches bytes encoder");
+}
+
+/**
+ * @brief Measures show() CPU cost and the wire-bound frame rate, then the frame period with the wire in real time.
+ */
+static void benchmark(LedController& controller) {
+    led_sim_rmt_stats_t rmt_before[WS2812B_NUM];
+    led_sim_i2c_stats_t i2c_before[PCA9955B_NUM];
+    uint64_t rmt_wire_max = 0;
+    uint64_t i2c_bus_wire[I2C_BUS_NUM] = {};
+    uint64_t i2c_wire = 0;
+    uint64_t refills = 0;
+
+    for(int i = 0; i < WS2812B_NUM; i++) {
+        led_sim_rmt_get_stats(BOARD_HW_CONFIG.rmt_pins[i], &rmt_before[i]);
+    }
+    for(int i = 0; i < PCA9955B_NUM; i++) {
+        led_sim_i2c_get_stats(BOARD_HW_CONFIG.i2c_addrs[i], &i2c_before[i]);
+    }
+    frame_stats_reset();
+
+    int64_t start = esp_timer_get_time();
+    for(int frame = 0; frame < SIM_FRAME_NUM; frame++) {
+        render_frame(controller, frame);
+        controller.show();
+    }
+    controller.wait_done();
+    int64_t elapsed = esp_timer_get_time() - start;
+
+    // Strips and I2C buses transmit in parallel, chips share their bus
+    for(int i = 0; i < WS2812B_NUM; i++) {
+        led_sim_rmt_stats_t stats;
+        led_sim_rmt_get_stats(BOARD_HW_CONFIG.rmt_pins[i], &stats);
+        uint64_t wire = stats.wire_us - rmt_before[i].wire_us;
+        rmt_wire_max = wire > rmt_wire_max ? wire : rmt_wire_max;
+        refills += stats.refills - rmt_before[i].refills;
+    }
+    for(int i = 0; i < PCA9955B_NUM; i++) {
+        led_sim_i2c_stats_t stats;
+        led_sim_i2c_get_stats(BOARD_HW_CONFIG.i2c_addrs[i], &stats);
+        i2c_bus_wire[BOARD_HW_CONFIG.i2c_bus_idx[i]] += stats.wire_us - i2c_before[i].wire_us;
+    }
+    for(int b = 0; b < I2C_BUS_NUM; b++) {
+        i2c_wire = i2c_bus_wire[b] > i2c_wire ? i2c_bus_wire[b] : i2c_wire;
+    }
+
+    uint64_t wire_per_frame = (rmt_wire_max > i2c_wire ? rmt_wire_max : i2c_wire) / SIM_FRAME_NUM;
+    ESP_LOGI(TAG, "%d frames, %d strips x %d px", SIM_FRAME_NUM, WS2812B_NUM, SIM_PIXEL_NUM);
+    ESP_LOGI(TAG, "host CPU: %.1f us/frame", (double)elapsed / SIM_FRAME_NUM);
+    ESP_LOGI(TAG,
+             "wire: RMT %llu us/frame, I2C %llu us/frame, %.1f refills/strip/frame -> %.0f fps max",
+             (unsigned long long)(rmt_wire_max / SIM_FRAME_NUM),
+             (unsigned long long)(i2c_wire / SIM_FRAME_NUM),
+             (double)refills / WS2812B_NUM / SIM_FRAME_NUM,
+             wire_per_frame ? 1e6 / wire_per_frame : 0.0);
+    frame_stats_print();
+
+    // Same loop with the wire modelled in real time, so waits on the previous frame are paid
+    led_sim_set_realtime(true);
+    start = esp_timer_get_time();
+    for(int frame = 0; frame < SIM_REALTIME_FRAME_NUM; frame++) {
+        render_frame(controller, frame);
+        controller.show();
+    }
+    controller.wait_done();
+    elapsed = esp_timer_get_time() - start;
+    led_sim_set_realtime(false);
+
+    double period = (double)elapsed / SIM_REALTIME_FRAME_NUM;
+    ESP_LOGI(TAG, "realtime: %.0f us/frame measured -> %.0f fps", period, 1e6 / period);
+    check(period >= wire_per_frame * 0.9 && period < wire_per_frame * 1.5 + 1000, "Realtime period follows the wire time");
+}
+
+/**
+ * @brief Runs SIM_FRAME_NUM frames and returns the refills per strip and frame on the first `strip_num` strips.
+ */
+static double measure_refills(LedController& controller, int strip_num) {
+    led_sim_rmt_stats_t before[WS2812B_NUM];
+    uint64_t refills = 0;
+
+    for(int i = 0; i < strip_num; i++) {
+        led_sim_rmt_get_stats(BOARD_HW_CONFIG.rmt_pins[i], &before[i]);
+    }
+    for(int frame = 0; frame < SIM_FRAME_NUM; frame++) {
+        render_frame(controller, frame, strip_num);
+        controller.show();
+    }
+    controller.wait_done();
+    for(int i = 0; i < strip_num; i++) {
+        led_sim_rmt_stats_t stats;
+        led_sim_rmt_get_stats(BOARD_HW_CONFIG.rmt_pins[i], &stats);
+        refills += stats.refills - before[i].refills;
+    }
+    return (double)refills / strip_num / SIM_FRAME_NUM;
+}
+
+/**
+ * @brief Half the strips unused: the others must take over their RMT memory and refill half as often.
+ *
+ * The RMT interrupt counter must match the encoder calls seen on the wires.
+ */
+static void check_rmt_mem() {
+    const int strip_num = WS2812B_NUM / 2;
+    LedController controller;
+    ch_info_t ch_info = {0};
+    led_sim_rmt_stats_t before[WS2812B_NUM];
+    frame_counter_summary_t irq;
+
+    for(int i = 0; i < strip_num; i++) {
+        ch_info.rmt_strips[i] = SIM_PIXEL_NUM;
+    }
+    for(int i = 0; i < PCA9955B_CH_NUM; i++) {
+        ch_info.i2c_leds[i] = 1;
+    }
+    if(controller.init(ch_info) != ESP_OK) {
+        check(false, "LedController init with unused strips");
+        return;
+    }
+    controller.set_power_budget(0);  // Whole frames every time, the limiter would trim them
+
+    for(int i = 0; i < strip_num; i++) {
+        led_sim_rmt_get_stats(BOARD_HW_CONFIG.rmt_pins[i], &before[i]);
+    }
+    frame_stats_reset();
+    double refills = measure_refills(controller, strip_num);
+
+    uint64_t encode_calls = 0;
+    for(int i = 0; i < strip_num; i++) {
+        led_sim_rmt_stats_t stats;
+        led_sim_rmt_get_stats(BOARD_HW_CONFIG.rmt_pins[i], &stats);
+        encode_calls += stats.encode_calls - before[i].encode_calls;
+    }
+    controller.show();  // Collects the interrupts of the last frame
+    frame_stats_get_counter(FRAME_COUNTER_RMT_IRQ, &irq);
+
+    // 2400 data symbols + reset: 1 + ceil((2401 - 128) / 64) encoder calls with two blocks
+    ESP_LOGI(TAG, "%d strips x 2 blocks: %.1f refills/strip/frame, %lu RMT IRQs/frame", strip_num, refills, (unsigned long)irq.max);
+    check(refills == 36.0, "RMT blocks of unused strips reassigned");
+    check(irq.count == SIM_FRAME_NUM + 1 && irq.max == encode_calls / SIM_FRAME_NUM, "RMT IRQ counter matches encoder calls");
+
+    controller.deinit();
+}
+
+/**
+ * @brief A NACKed chip must be re-initialised (IREF) and resent on the following frames.
+ */
+static void check_nack_recovery(LedController& controller) {
+    uint8_t addr = BOARD_HW_CONFIG.i2c_addrs[0];
+    led_sim_i2c_stats_t stats;
+
+    // NACK one transfer: the HAL must restore IREF and resend the colours
+    // (pixel by pixel, fill() would reach the chips through one ALLCALL broadcast)
+    const uint8_t pixel[3] = {20, 10, 30};  // GRB
+    for(int ch = 0; ch < PCA9955B_CH_NUM; ch++) {
+        controller.write_pixels(WS2812B_NUM + ch, 0, pixel, 1);
+    }
+    led_sim_i2c_inject_nack(addr, 1);
+    for(int i = 0; i < 4; i++) {
+        controller.show();
+        controller.wait_done();
+    }
+
+    led_sim_i2c_get_stats(addr, &stats);
+    check(stats.nacks == 1, "PCA9955B NACK injected");
+    check(led_sim_i2c_get_reg(addr, PCA9955B_IREFALL_REG) == 0xFF, "PCA9955B IREF restored");
+    check(led_sim_i2c_get_reg(addr, PCA9955B_PWM0_REG) == 10 && led_sim_i2c_get_reg(addr, PCA9955B_PWM0_REG + 1) == 20 &&
+              led_sim_i2c_get_reg(addr, PCA9955B_PWM0_REG + 2) == 30,
+          "PCA9955B colours resent after NACK");
+}
+
+/**
+ * @brief Changing one pixel of a chip must only write its three PWM registers.
+ */
+static void check_pca_span(LedController& controller) {
+    uint8_t addr = BOARD_HW_CONFIG.i2c_addrs[1];
+    const uint8_t pixel[3] = {50, 40, 60};  // GRB
+    led_sim_i2c_stats_t before, after;
+
+    controller.fill(10, 20, 30);
+    controller.show();
+    controller.wait_done();
+
+    led_sim_i2c_get_stats(addr, &before);
+    controller.write_pixels(WS2812B_NUM + 5 + 2, 0, pixel, 1);  // Chip 1, pixel 2
+    controller.show();
+    controller.wait_done();
+    led_sim_i2c_get_stats(addr, &after);
+
+    ESP_LOGI(TAG, "one PCA9955B pixel changed: %llu bytes, %llu us on the bus", (unsigned long long)(after.bytes - before.bytes), (unsigned long long)(after.wire_us - before.wire_us));
+    check(after.transfers - before.transfers == 1 && after.bytes - before.bytes == 1 + 3, "PCA9955B writes the dirty PWM span only");
+    check(after.wire_us - before.wire_us == (5 * 9 + 2) * 1000000ULL / SIM_I2C_SETTLED_HZ, "I2C clock probed up to the wiring limit");
+    check(led_sim_i2c_get_reg(addr, PCA9955B_PWM0_REG + 5) == 30 && led_sim_i2c_get_reg(addr, PCA9955B_PWM0_REG + 6) == 40 &&
+              led_sim_i2c_get_reg(addr, PCA9955B_PWM0_REG + 8) == 60 && led_sim_i2c_get_reg(addr, PCA9955B_PWM0_REG + 9) == 10,
+          "PCA9955B span lands on its registers");
+}
+
+/**
+ * @brief An unplugged chip must back off and stay out of the frames while the
+ *        others keep updating, then come back once it answers again.
+ */
+static void check_pca_health(LedController& controller) {
+    uint8_t addr = BOARD_HW_CONFIG.i2c_addrs[2];
+    uint8_t other = BOARD_HW_CONFIG.i2c_addrs[3];
+    led_sim_i2c_stats_t before, after;
+    int frames = 0;
+
+    // 1. Unplug the chip and keep changing every PCA channel for 300 ms
+    led_sim_i2c_get_stats(addr, &before);
+    led_sim_i2c_inject_nack(addr, LED_SIM_NACK_FOREVER);
+    for(int64_t end = esp_timer_get_time() + 300 * 1000; esp_timer_get_time() < end; frames++) {
+        const uint8_t pixel[3] = {(uint8_t)frames, 7, 9};  // GRB
+        for(int ch = 0; ch < PCA9955B_CH_NUM; ch++) {
+            controller.write_pixels(WS2812B_NUM + ch, 0, pixel, 1);
+        }
+        controller.show();
+        vTaskDelay(pdMS_TO_TICKS(2));
+    }
+    controller.wait_done();
+    led_sim_i2c_get_stats(addr, &after);
+    controller.print_pca_health();
+
+    // Next frame, then 50 + 100 ms of backoff: at most 5 attempts in 300 ms
+    ESP_LOGI(TAG, "unplugged PCA9955B: %lu attempts in %d frames", (unsigned long)(after.nacks - before.nacks), frames);
+    check(after.nacks - before.nacks >= PCA9955B_DEAD_FAILS && after.nacks - before.nacks <= 5, "Unplugged PCA9955B backs off");
+    check(led_sim_i2c_get_reg(other, PCA9955B_PWM0_REG + 1) == (uint8_t)(frames - 1), "Other PCA9955B keep updating");
+
+    // 2. Plug it back: the next probe restores IREF, the colours follow
+    led_sim_i2c_inject_nack(addr, 0);
+    vTaskDelay(pdMS_TO_TICKS(PCA9955B_RETRY_MAX_MS));
+    for(int i = 0; i < 3; i++) {
+        controller.show();
+        controller.wait_done();
+    }
+    check(led_sim_i2c_get_reg(addr, PCA9955B_IREFALL_REG) == 0xFF && led_sim_i2c_get_reg(addr, PCA9955B_PWM0_REG + 1) == (uint8_t)(frames - 1),
+          "PCA9955B recovers after backoff");
+}
+
+/**
+ * @brief A target holding SDA low must be clocked free and the bus rebuilt
+ *        while the WS2812B strips keep playing.
+ */
+static void check_i2c_recovery(LedController& controller) {
+    const i2c_pins_t* pins = &BOARD_HW_CONFIG.i2c_buses[0];
+    uint8_t addr = BOARD_HW_CONFIG.i2c_addrs[0];
+    led_sim_rmt_stats_t rmt_before, rmt_after;
+    uint32_t longest_show_us = 0;
+    const int frame_num = 20;
+
+    // 1. Wedge the bus mid-byte and keep playing
+    led_sim_rmt_get_stats(BOARD_HW_CONFIG.rmt_pins[0], &rmt_before);
+    led_sim_gpio_hold_low(pins->sda, pins->scl, 5);
+    for(int frame = 0; frame < frame_num; frame++) {
+        render_frame(controller, 1000 + frame);
+        int64_t start = esp_timer_get_time();
+        controller.show();
+        uint32_t show_us = (uint32_t)(esp_timer_get_time() - start);
+        longest_show_us = show_us > longest_show_us ? show_us : longest_show_us;
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+    controller.wait_done();
+    led_sim_rmt_get_stats(BOARD_HW_CONFIG.rmt_pins[0], &rmt_after);
+    controller.print_pca_health();
+
+    // 2. The last frame reached the chips on the rebuilt bus
+    ESP_LOGI(TAG, "wedged I2C bus: longest show() %lu us", (unsigned long)longest_show_us);
+    check(rmt_after.frames - rmt_before.frames == (uint32_t)frame_num, "WS2812B strips keep playing during I2C recovery");
+    check(gpio_get_level(pins->sda) == 1, "Stuck SDA clocked free");
+    check(led_sim_i2c_get_reg(addr, PCA9955B_PWM0_REG + 1) == (uint8_t)(1000 + frame_num - 1) &&
+              led_sim_i2c_get_reg(addr, PCA9955B_IREFALL_REG) == 0xFF,
+          "PCA9955B back on the recovered bus");
+    check(longest_show_us < 100 * 1000, "I2C recovery faster than a controller reset");
+}
+
+/**
+ * @brief Output tables: curve shape, word-at-a-time copy against a byte loop, the
+ *        corrected colours on the wire, runtime brightness, and the copy cost.
+ */
+static void check_output_lut(LedController& controller) {
+    static uint8_t src[SIM_PIXEL_NUM * 3 + 8];
+    static uint8_t dst[SIM_PIXEL_NUM * 3 + 8];
+    static uint8_t ref[SIM_PIXEL_NUM * 3 + 8];
+    uint8_t received[SIM_PIXEL_NUM * 3];
+
+    output_lut_set_gamma(true);
+    output_lut_set_brightness(255);
+    const uint8_t* ws = output_lut_get(OUTPUT_LUT_WS2812B);
+    const uint8_t* pca = output_lut_get(OUTPUT_LUT_PCA9955B);
+
+    // 1. Curves: monotonic, full range, the WS2812B one steeper
+    bool curve_ok = ws[0] == 0 && ws[255] == 255 && pca[0] == 0 && pca[255] == 255 && ws[128] < pca[128] && ws[128] < 64;
+    for(int i = 1; i < 256; i++) {
+        curve_ok &= ws[i] >= ws[i - 1] && pca[i] >= pca[i - 1];
+    }
+    check(curve_ok, "Gamma curves per device type");
+
+    // 2. Every source / destination alignment and tail length
+    for(int i = 0; i < (int)sizeof(src); i++) {
+        src[i] = (uint8_t)(i * 37 + 5);
+    }
+    bool copy_ok = true;
+    for(int s_off = 0; s_off < 4; s_off++) {
+        for(int d_off = 0; d_off < 4; d_off++) {
+            for(int len = 0; len < 40; len++) {
+                memset(dst, 0xAA, sizeof(dst));
+                memset(ref, 0xAA, sizeof(ref));
+                output_lut_copy(OUTPUT_LUT_WS2812B, dst + d_off, src + s_off, len);
+                for(int i = 0; i < len; i++) {
+                    ref[d_off + i] = ws[src[s_off + i]];
+                }
+                copy_ok &= memcmp(dst, ref, sizeof(ref)) == 0;
+            }
+        }
+    }
+    check(copy_ok, "Word-at-a-time LUT copy matches bytes");
+
+    // 3. Both device types leave corrected, and a brightness change needs no new source colours
+    uint8_t grb[3] = {200, 100, 50};
+    uint8_t addr = BOARD_HW_CONFIG.i2c_addrs[0];
+    controller.write_pixels(0, 0, src, SIM_PIXEL_NUM);
+    controller.write_pixels(WS2812B_NUM, 0, grb, 1);
+    controller.show();
+    controller.wait_done();
+    bool wire_ok = led_sim_rmt_get_frame(BOARD_HW_CONFIG.rmt_pins[0], received, sizeof(received)) == sizeof(received);
+    for(int i = 0; i < (int)sizeof(received); i++) {
+        wire_ok &= (unsigned)(received[i] - ws[src[i]]) <= WS2812B_DITHER;  // A dithered byte may round up
+    }
+    wire_ok &= led_sim_i2c_get_reg(addr, PCA9955B_PWM0_REG) == pca[100] && led_sim_i2c_get_reg(addr, PCA9955B_PWM0_REG + 1) == pca[200];
+    check(wire_ok, "Corrected colours on the wire");
+
+    uint8_t full[256];
+    memcpy(full, ws, sizeof(full));
+    output_lut_set_brightness(128);
+    controller.show();
+    controller.wait_done();
+    led_sim_rmt_get_frame(BOARD_HW_CONFIG.rmt_pins[0], received, sizeof(received));
+    bool dim_ok = ws[255] == 128;
+    for(int i = 0; i < (int)sizeof(received); i++) {
+        dim_ok &= abs(received[i] * 2 - full[src[i]]) <= 2 + 2 * WS2812B_DITHER;
+    }
+    dim_ok &= led_sim_i2c_get_reg(addr, PCA9955B_PWM0_REG) == pca[100] && led_sim_i2c_get_reg(addr, PCA9955B_PWM0_REG + 1) == pca[200];
+    check(dim_ok, "Runtime brightness halves the output");
+
+    // 4. Cost of one strip copy
+    volatile uint8_t sink = 0;
+    int64_t start = esp_timer_get_time();
+    for(int r = 0; r < LUT_BENCH_ROUNDS; r++) {
+        memcpy(dst, src + (r & 1), SIM_PIXEL_NUM * 3);
+        sink = sink + dst[r % (SIM_PIXEL_NUM * 3)];
+    }
+    int64_t memcpy_us = esp_timer_get_time() - start;
+    start = esp_timer_get_time();
+    for(int r = 0; r < LUT_BENCH_ROUNDS; r++) {
+        const uint8_t* in = src + (r & 1);
+        for(int i = 0; i < SIM_PIXEL_NUM * 3; i++) {
+            dst[i] = ws[in[i]];
+        }
+        sink = sink + dst[r % (SIM_PIXEL_NUM * 3)];
+    }
+    int64_t bytes_us = esp_timer_get_time() - start;
+    start = esp_timer_get_time();
+    for(int r = 0; r < LUT_BENCH_ROUNDS; r++) {
+        output_lut_copy(OUTPUT_LUT_WS2812B, dst, src + (r & 1), SIM_PIXEL_NUM * 3);
+        sink = sink + dst[r % (SIM_PIXEL_NUM * 3)];
+    }
+    int64_t words_us = esp_timer_get_time() - start;
+    ESP_LOGI(TAG,
+             "strip copy (%d px): memcpy %.0f ns, LUT bytes %.0f ns, LUT words %.0f ns",
+             SIM_PIXEL_NUM,
+             memcpy_us * 1000.0 / LUT_BENCH_ROUNDS,
+             bytes_us * 1000.0 / LUT_BENCH_ROUNDS,
+             words_us * 1000.0 / LUT_BENCH_ROUNDS);
+
+    // The transport checks compare raw bytes
+    output_lut_set_brightness(255);
+    output_lut_set_gamma(false);
+}
+
+/**
+ * @brief Dithered strips must add up to their 16-bit levels over time and stop
+ *        being resent once the levels are whole again.
+ */
+static void check_dither(LedController& controller) {
+#if WS2812B_DITHER
+    static uint8_t src[SIM_PIXEL_NUM * 3];
+    static uint8_t dst[SIM_PIXEL_NUM * 3];
+    static uint8_t error[SIM_PIXEL_NUM * 3];
+    static uint32_t sums[SIM_PIXEL_NUM * 3];
+    uint8_t received[SIM_PIXEL_NUM * 3];
+
+    output_lut_set_gamma(true);
+    output_lut_set_brightness(DITHER_BRIGHTNESS);
+    const uint8_t* lut = output_lut_get(OUTPUT_LUT_WS2812B);
+    const uint16_t* lut16 = output_lut_get16(OUTPUT_LUT_WS2812B);
+
+    // 1. A full ramp at 25%: 256 frames carry every fraction over exactly once
+    for(int i = 0; i < (int)sizeof(src); i++) {
+        src[i] = (uint8_t)(i * 255 / (sizeof(src) - 1));
+    }
+    memset(sums, 0, sizeof(sums));
+    controller.write_pixels(0, 0, src, SIM_PIXEL_NUM);
+    for(int f = 0; f < 256; f++) {
+        controller.show();
+        controller.wait_done();
+        led_sim_rmt_get_frame(BOARD_HW_CONFIG.rmt_pins[0], received, sizeof(received));
+        for(int i = 0; i < (int)sizeof(received); i++) {
+            sums[i] += received[i];
+        }
+    }
+    bool sum_ok = true;
+    int steps_8bit = 1, steps_dither = 1;
+    for(int i = 0; i < (int)sizeof(src); i++) {
+        sum_ok &= sums[i] == lut16[src[i]];
+        if(i > 0 && src[i] != src[i - 1]) {
+            steps_8bit += lut[src[i]] != lut[src[i - 1]];
+            steps_dither += lut16[src[i]] != lut16[src[i - 1]];
+        }
+    }
+    ESP_LOGI(TAG, "ramp at brightness %d: %d output steps at 8 bits, %d dithered", DITHER_BRIGHTNESS, steps_8bit, steps_dither);
+    check(sum_ok, "Dithered frames average to the 16-bit levels");
+    check(steps_dither > 2 * steps_8bit, "Dithering keeps the dim steps");
+
+    // 2. Whole levels stop the per-frame resends
+    output_lut_set_brightness(255);
+    output_lut_set_gamma(false);
+    controller.write_pixels(0, 0, src, SIM_PIXEL_NUM);
+    controller.show();
+    controller.wait_done();
+    uint32_t before = total_transactions();
+    controller.show();
+    controller.wait_done();
+    bool whole_ok = total_transactions() == before && led_sim_rmt_get_frame(BOARD_HW_CONFIG.rmt_pins[0], received, sizeof(received)) == sizeof(src) &&
+                    memcmp(received, src, sizeof(src)) == 0;
+    check(whole_ok, "Whole levels sent as is and held");
+
+    // 3. Per-frame cost against the plain 8-bit table copy
+    output_lut_set_gamma(true);
+    output_lut_set_brightness(DITHER_BRIGHTNESS);
+    memset(error, 0, sizeof(error));
+    volatile uint8_t sink = 0;
+    int64_t start = esp_timer_get_time();
+    for(int r = 0; r < LUT_BENCH_ROUNDS; r++) {
+        output_lut_copy(OUTPUT_LUT_WS2812B, dst, src, sizeof(src));
+        sink = sink + dst[r % sizeof(dst)];
+    }
+    int64_t copy_us = esp_timer_get_time() - start;
+    start = esp_timer_get_time();
+    for(int r = 0; r < LUT_BENCH_ROUNDS; r++) {
+        output_lut_dither(OUTPUT_LUT_WS2812B, src, OUTPUT_LUT_SCALE_NONE, error, dst, sizeof(dst));
+        sink = sink + dst[r % sizeof(dst)];
+    }
+    int64_t dither_us = esp_timer_get_time() - start;
+    ESP_LOGI(TAG,
+             "strip output (%d px): 8-bit copy %.0f ns, 16-bit dither %.0f ns; %.1f us more per frame of %d strips",
+             SIM_PIXEL_NUM,
+             copy_us * 1000.0 / LUT_BENCH_ROUNDS,
+             dither_us * 1000.0 / LUT_BENCH_ROUNDS,
+             (dither_us - copy_us) * (double)WS2812B_NUM / LUT_BENCH_ROUNDS,
+             WS2812B_NUM);
+
+    // The transport checks compare raw bytes
+    output_lut_set_brightness(255);
+    output_lut_set_gamma(false);
+#else
+    (void)controller;
+#endif
+}
+
+/**
+ * @brief Supply current the simulated LEDs draw with the colours on the wire and in the PCA9955B registers.
+ */
+static uint64_t wire_current_ua() {
+    uint8_t received[SIM_PIXEL_NUM * 3];
+    uint64_t ua = (uint64_t)WS2812B_NUM * SIM_PIXEL_NUM * POWER_WS2812B_IDLE_UA;
+
+    for(int ch = 0; ch < WS2812B_NUM; ch++) {
+        size_t len = led_sim_rmt_get_frame(BOARD_HW_CONFIG.rmt_pins[ch], received, sizeof(received));
+        for(size_t i = 0; i < len && i < sizeof(received); i++) {
+            ua += received[i] * POWER_WS2812B_UA_PER_STEP;
+        }
+    }
+    for(int i = 0; i < PCA9955B_NUM; i++) {
+        for(int ch = 0; ch < 15; ch++) {
+            ua += led_sim_i2c_get_reg(BOARD_HW_CONFIG.i2c_addrs[i], PCA9955B_PWM0_REG + ch) * POWER_PCA9955B_UA_PER_STEP;
+        }
+    }
+    return ua;
+}
+
+/**
+ * @brief The current estimate must follow partial writes without rescans, and frames
+ *        over budget must leave scaled into it with their colour balance intact.
+ */
+static void check_power(LedController& controller) {
+    uint8_t strip[SIM_PIXEL_NUM * 3];
+    uint8_t received[SIM_PIXEL_NUM * 3];
+    const uint8_t grb[3] = {10, 20, 30};
+    const uint64_t idle_ua = (uint64_t)WS2812B_NUM * SIM_PIXEL_NUM * POWER_WS2812B_IDLE_UA;
+    frame_counter_summary_t current, limited;
+
+    // 1. Dark frame: only the quiescent current
+    controller.black_out();
+    controller.wait_done();
+    bool estimate_ok = controller.get_current_ma() == idle_ua / 1000;
+
+    // 2. Runs written over each other, compared with a full count of what was written
+    for(int i = 0; i < (int)sizeof(strip); i++) {
+        strip[i] = (uint8_t)(i * 7);
+    }
+    controller.write_pixels(0, 0, strip, SIM_PIXEL_NUM);
+    memset(strip, 0xFF, 20 * 3);
+    controller.write_pixels(3, 10, strip, 20);
+    controller.write_pixels(WS2812B_NUM, 0, grb, 1);
+    memset(strip, 0, 10 * 3);
+    controller.write_pixels(0, 0, strip, 10);
+    controller.show();
+    controller.wait_done();
+
+    uint64_t led_ua = 20 * 3 * 0xFF * POWER_WS2812B_UA_PER_STEP + (grb[0] + grb[1] + grb[2]) * POWER_PCA9955B_UA_PER_STEP;
+    for(int i = 10 * 3; i < SIM_PIXEL_NUM * 3; i++) {
+        led_ua += (uint8_t)(i * 7) * POWER_WS2812B_UA_PER_STEP;
+    }
+    estimate_ok &= controller.get_current_ma() == (led_ua + idle_ua) / 1000;
+    estimate_ok &= controller.get_current_ma() == wire_current_ua() / 1000;
+    check(estimate_ok, "Current estimate follows the written runs");
+
+    // 3. Full white is far over budget: every LED scaled by the same factor, within the budget
+    frame_stats_reset();
+    controller.set_power_budget(POWER_BUDGET_MA);
+    controller.fill(0xFF, 0xFF, 0xFF);
+    controller.show();
+    controller.wait_done();
+    uint32_t white_ma = controller.get_current_ma();
+    uint64_t sent_ua = wire_current_ua();
+    bool scaled_ok = led_sim_rmt_get_frame(BOARD_HW_CONFIG.rmt_pins[0], received, sizeof(received)) == sizeof(received) && received[0] < 0xFF;
+    for(int ch = 0; ch < WS2812B_NUM; ch++) {
+        led_sim_rmt_get_frame(BOARD_HW_CONFIG.rmt_pins[ch], strip, sizeof(strip));
+        scaled_ok &= memcmp(strip, received, sizeof(strip)) == 0;
+    }
+    for(int i = 0; i < PCA9955B_NUM; i++) {
+        for(int ch = 0; ch < 15; ch++) {
+            scaled_ok &= led_sim_i2c_get_reg(BOARD_HW_CONFIG.i2c_addrs[i], PCA9955B_PWM0_REG + ch) == received[0];
+        }
+    }
+    frame_stats_get_counter(FRAME_COUNTER_CURRENT, &current);
+    frame_stats_get_counter(FRAME_COUNTER_LIMITED, &limited);
+    ESP_LOGI(TAG,
+             "full white: %lu mA estimated, %lu mA sent (level %d), budget %d mA",
+             (unsigned long)white_ma,
+             (unsigned long)(sent_ua / 1000),
+             received[0],
+             POWER_BUDGET_MA);
+    check(scaled_ok && sent_ua <= POWER_BUDGET_MA * 1000ULL && sent_ua * 10 >= POWER_BUDGET_MA * 9000ULL, "Frame over budget scaled into it");
+    check(current.overruns == 1 && current.max == white_ma && limited.max <= POWER_BUDGET_MA, "Estimated current in the stats");
+
+    // 4. Less than a step of headroom keeps the factor: the other LEDs are not resent at a new level
+    uint8_t level = received[0];
+    memset(strip, 0, sizeof(strip));
+    controller.write_pixels(0, 0, strip, SIM_PIXEL_NUM);
+    controller.show();
+    controller.wait_done();
+    bool held_ok = controller.get_current_ma() < white_ma && led_sim_rmt_get_frame(BOARD_HW_CONFIG.rmt_pins[1], received, sizeof(received)) == sizeof(received);
+    for(int i = 0; i < (int)sizeof(received); i++) {
+        held_ok &= received[i] == level;
+    }
+    held_ok &= led_sim_i2c_get_reg(BOARD_HW_CONFIG.i2c_addrs[0], PCA9955B_PWM0_REG) == level;
+    check(held_ok, "Limiter factor held within a step of the budget");
+
+    // 5. Back within budget: the same frame as written
+    controller.fill(8, 8, 8);
+    controller.show();
+    controller.wait_done();
+    bool restored_ok = true;
+    for(int ch = 0; ch < WS2812B_NUM; ch++) {
+        restored_ok &= led_sim_rmt_get_frame(BOARD_HW_CONFIG.rmt_pins[ch], received, sizeof(received)) == sizeof(received);
+        for(int i = 0; i < (int)sizeof(received); i++) {
+            restored_ok &= received[i] == 8;
+        }
+    }
+    for(int i = 0; i < PCA9955B_NUM; i++) {
+        restored_ok &= led_sim_i2c_get_reg(BOARD_HW_CONFIG.i2c_addrs[i], PCA9955B_PWM0_REG) == 8;
+    }
+    check(restored_ok, "Frames within budget sent unscaled");
+
+    // The transport checks compare raw bytes
+    controller.set_power_budget(0);
+    controller.black_out();
+}
+
+/**
+ * @brief fill() and the global dimmer must reach every chip in a single ALLCALL transaction per bus.
+ */
+static void check_pca_allcall(LedController& controller) {
+    led_sim_i2c_stats_t allcall_before, allcall_after;
+    uint32_t chip_transfers = 0;
+
+    led_sim_i2c_get_stats(PCA9955B_ALLCALL_ADDR, &allcall_before);
+    for(int i = 0; i < PCA9955B_NUM; i++) {
+        led_sim_i2c_stats_t stats;
+        led_sim_i2c_get_stats(BOARD_HW_CONFIG.i2c_addrs[i], &stats);
+        chip_transfers -= stats.transfers;
+    }
+
+    controller.black_out();
+    controller.set_pca_brightness(64);
+
+    bool regs_ok = true;
+    for(int i = 0; i < PCA9955B_NUM; i++) {
+        led_sim_i2c_stats_t stats;
+        led_sim_i2c_get_stats(BOARD_HW_CONFIG.i2c_addrs[i], &stats);
+        chip_transfers += stats.transfers;
+        for(int ch = 0; ch < 15; ch++) {
+            regs_ok &= led_sim_i2c_get_reg(BOARD_HW_CONFIG.i2c_addrs[i], PCA9955B_PWM0_REG + ch) == 0;
+        }
+        regs_ok &= led_sim_i2c_get_reg(BOARD_HW_CONFIG.i2c_addrs[i], PCA9955B_IREFALL_REG) == 64;
+    }
+    led_sim_i2c_get_stats(PCA9955B_ALLCALL_ADDR, &allcall_after);
+
+    check(allcall_after.transfers - allcall_before.transfers == 2 * I2C_BUS_NUM && chip_transfers == 0, "PCA9955B black-out and dimmer broadcast");
+    check(regs_ok, "PCA9955B broadcast reaches every chip");
+    controller.set_pca_brightness(0xFF);
+}
+
+static uint32_t lcg_state = 1;
+
+static uint32_t lcg_next(uint32_t range) {
+    lcg_state = lcg_state * 1664525 + 1013904223;
+    return (lcg_state >> 8) % range;
+}
+
+/**
+ * @brief Five simulated minutes of a local crystal running CLOCK_SIM_DRIFT_PPM fast,
+ *        with late ticks and jittery master syncs once a second.
+ */
+static void check_show_clock() {
+    ShowClock clock;
+    int64_t local_offset = 123456;
+    int64_t next_sync = CLOCK_SIM_SYNC_US;
+    int64_t worst_error = 0;
+    int64_t last_tick = 0;
+    uint32_t last_frame = 0;
+    bool smooth = true;
+
+    clock.seek(local_offset, 0);
+    clock.start(local_offset);
+    for(int64_t master = 0; master < CLOCK_SIM_SHOW_US; master += 1000000 / CLOCK_SIM_FPS) {
+        // 1. Tick, up to 2 ms late and occasionally a stalled task
+        int64_t late = lcg_next(2000) + (lcg_next(500) == 0 ? 70000 : 0);
+        int64_t tick_master = master + late > last_tick ? master + late : last_tick;  // A stall delays the next ticks too
+        int64_t local = local_offset + tick_master + tick_master * CLOCK_SIM_DRIFT_PPM / 1000000;
+        int64_t show = clock.now(local);
+        uint32_t frame = ShowClock::frame_at(show, CLOCK_SIM_FPS);
+
+        // Jittery syncs may move the clock back across a frame boundary, never further
+        smooth &= frame + 1 >= last_frame;
+        last_frame = frame;
+        last_tick = tick_master;
+        if(master > 10 * CLOCK_SIM_SYNC_US) {
+            int64_t error = show > tick_master ? show - tick_master : tick_master - show;
+            worst_error = error > worst_error ? error : worst_error;
+        }
+
+        // 2. Master timestamp with up to 500 us of transport jitter
+        if(tick_master >= next_sync) {
+            clock.sync(local, tick_master - lcg_next(500));
+            next_sync += CLOCK_SIM_SYNC_US;
+        }
+    }
+
+    const show_clock_stats_t& stats = clock.get_stats();
+    ESP_LOGI(TAG,
+             "show clock: %lu syncs, worst error %lld us, rate %ld ppm",
+             (unsigned long)stats.syncs,
+             (long long)worst_error,
+             (long)stats.rate_ppm);
+    check(smooth, "Show clock corrections below one frame");
+    check(worst_error < 2000, "Show clock follows the master");
+    check(stats.rate_ppm < -CLOCK_SIM_DRIFT_PPM + 50 && stats.rate_ppm > -CLOCK_SIM_DRIFT_PPM - 50, "Show clock rate trained");
+
+    // A master seek is a step, not drift
+    int64_t local = local_offset + CLOCK_SIM_SHOW_US;
+    int32_t rate = stats.rate_ppm;
+    check(clock.sync(local, CLOCK_SIM_SHOW_US + 10 * 1000 * 1000) && clock.get_stats().rate_ppm == rate &&
+              ShowClock::frame_at(clock.now(local), CLOCK_SIM_FPS) == (CLOCK_SIM_SHOW_US / 1000000 + 10) * CLOCK_SIM_FPS,
+          "Show clock steps on master seek");
+    check(ShowClock::frame_at(ShowClock::frame_time(1234, CLOCK_SIM_FPS), CLOCK_SIM_FPS) == 1234, "Show clock frame_time round trip");
+}
+
+/**
+ * @brief Float HSV to GRB, the conversion computeTestFrame() used to run.
+ */
+static void hsv_to_grb_float(float h, float s, float v, uint8_t* grb) {
+    float r = 0.0f, g = 0.0f, b = 0.0f;
+    int i = (int)floorf(h * 6);
+    float f = h * 6 - i;
+    float p = v * (1 - s);
+    float q = v * (1 - f * s);
+    float t = v * (1 - (1 - f) * s);
+
+    switch(i % 6) {
+        case 0:
+            r = v, g = t, b = p;
+            break;
+        case 1:
+            r = q, g = v, b = p;
+            break;
+        case 2:
+            r = p, g = v, b = t;
+            break;
+        case 3:
+            r = p, g = q, b = v;
+            break;
+        case 4:
+            r = t, g = p, b = v;
+            break;
+        default:
+            r = v, g = p, b = q;
+            break;
+    }
+    grb[0] = (uint8_t)lroundf(g * 255);
+    grb[1] = (uint8_t)lroundf(r * 255);
+    grb[2] = (uint8_t)lroundf(b * 255);
+}
+
+/**
+ * @brief Integer colour helpers against their float definitions, then both HSV paths timed per pixel.
+ */
+static void check_color_math() {
+    int hsv_error = 0;
+    int sin_error = 0;
+    bool blend_ok = true;
+
+    // 1. Equivalence
+    for(int h = 0; h < 256; h++) {
+        for(int s = 0; s < 256; s += 15) {
+            for(int v = 0; v < 256; v += 15) {
+                uint8_t fixed[3], ref[3];
+                color_hsv_to_grb(h, s, v, fixed);
+                hsv_to_grb_float(h / 256.0f, s / 255.0f, v / 255.0f, ref);
+                for(int c = 0; c < 3; c++) {
+                    int error = abs(fixed[c] - ref[c]);
+                    hsv_error = error > hsv_error ? error : hsv_error;
+                }
+            }
+        }
+        int error = abs(color_sin8(h) - (int)lroundf(127 * sinf(h * 2 * (float)M_PI / 256)));
+        sin_error = error > sin_error ? error : sin_error;
+    }
+    for(int a = 0; a < 256; a += 5) {
+        for(int b = 0; b < 256; b += 5) {
+            blend_ok &= color_blend8(a, b, 0) == a && color_blend8(a, b, 256) == b;
+            blend_ok &= color_lerp8(a, b, 0) == a && color_lerp8(a, b, 255) == b;
+            blend_ok &= abs(color_blend8(a, b, 128) - (a + b) / 2) <= 1;
+        }
+        blend_ok &= color_scale8(a, 255) == a && color_scale8(a, 0) == 0;
+    }
+    check(hsv_error <= 1, "Fixed-point HSV within 1 LSB of float");
+    check(sin_error == 0, "Sine LUT matches sinf");
+    check(blend_ok, "Blend / lerp / scale8 end points");
+
+    // 2. Cost per pixel; the host FPU is far faster than the ESP32's, so this is a lower bound for float
+    volatile uint8_t sink = 0;
+    uint8_t grb[3];
+    int64_t start = esp_timer_get_time();
+    for(uint32_t i = 0; i < COLOR_BENCH_PIXELS; i++) {
+        color_hsv_to_grb((uint8_t)i, 255, (uint8_t)(i >> 8), grb);
+        sink = sink + grb[0];
+    }
+    int64_t fixed_us = esp_timer_get_time() - start;
+
+    start = esp_timer_get_time();
+    for(uint32_t i = 0; i < COLOR_BENCH_PIXELS; i++) {
+        hsv_to_grb_float((uint8_t)i / 256.0f, 1.0f, (uint8_t)(i >> 8) / 255.0f, grb);
+        sink = sink + grb[0];
+    }
+    int64_t float_us = esp_timer_get_time() - start;
+
+    ESP_LOGI(TAG,
+             "HSV -> GRB: fixed %.1f ns/px, float %.1f ns/px (max error %d LSB)",
+             fixed_us * 1000.0 / COLOR_BENCH_PIXELS,
+             float_us * 1000.0 / COLOR_BENCH_PIXELS,
+             hsv_error);
+}
+
+/**
+ * @brief FrameTarget keeping a copy of every channel, counts the writes.
+ */
+class CaptureTarget: public FrameTarget {
+  public:
+    esp_err_t write_pixels(int ch_idx, int pixel_idx, const uint8_t* data, int pixel_count) override {
+        memcpy(pixels[ch_idx] + pixel_idx * 3, data, pixel_count * 3);
+        writes++;
+        pixels_written += pixel_count;
+        return ESP_OK;
+    }
+    esp_err_t fill(uint8_t red, uint8_t green, uint8_t blue) override {
+        return ESP_OK;
+    }
+
+    uint8_t pixels[FRAME_FILE_CH_NUM][SIM_PIXEL_NUM * 3] = {};
+    int writes = 0;
+    int pixels_written = 0;
+};
+
+/**
+ * @brief A ring slot must only take and flush the pixels written since the last hand-off.
+ */
+static void check_frame_buffer(const ch_info_t& ch_info) {
+    FrameBuffer work;
+    FrameBuffer slot;
+    CaptureTarget capture;
+    uint8_t expected[SIM_PIXEL_NUM * 3];
+    const uint8_t run[5 * 3] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+    const uint8_t grb[3] = {0x21, 0x22, 0x23};
+
+    if(work.init(ch_info) != ESP_OK || slot.init(ch_info) != ESP_OK) {
+        check(false, "FrameBuffer init");
+        return;
+    }
+
+    // 1. Whole frame handed on
+    render_frame(work, 9);
+    work.copy_dirty_to(slot);
+    slot.flush(capture);
+    bool full_ok = capture.pixels_written == WS2812B_NUM * SIM_PIXEL_NUM + PCA9955B_CH_NUM;
+
+    // 2. Two runs on one strip and one PCA LED; the slot's stale pixels must stay behind
+    memcpy(expected, capture.pixels[2], sizeof(expected));
+    slot.fill(0xEE, 0xEE, 0xEE);
+    capture.writes = 0;
+    capture.pixels_written = 0;
+    work.write_pixels(2, 30, run, 2);
+    work.write_pixels(2, 10, run, 5);
+    work.write_pixels(WS2812B_NUM + 1, 0, grb, 1);
+    work.copy_dirty_to(slot);
+    slot.flush(capture);
+
+    memcpy(expected + 10 * 3, run, 5 * 3);
+    memcpy(expected + 30 * 3, run, 2 * 3);
+    bool range_ok = capture.writes == 2 && capture.pixels_written == 22 + 1;
+    range_ok &= memcmp(capture.pixels[2], expected, sizeof(expected)) == 0 && memcmp(capture.pixels[WS2812B_NUM + 1], grb, 3) == 0;
+
+    // 3. A full refresh covers every pixel again
+    capture.pixels_written = 0;
+    work.mark_dirty();
+    work.copy_dirty_to(slot);
+    slot.flush(capture);
+    full_ok &= capture.pixels_written == WS2812B_NUM * SIM_PIXEL_NUM + PCA9955B_CH_NUM;
+
+    ESP_LOGI(TAG, "frame buffer: 2 runs on one strip hand on %d of %d pixels", 22, SIM_PIXEL_NUM);
+    check(range_ok, "Only the dirty pixel range handed on");
+    check(full_ok, "Whole frames handed on in full");
+}
+
+static effect_cue_t effect_cue(uint32_t start_ms, uint64_t ch_mask, effect_type_t type, uint8_t speed, uint8_t size, uint8_t amount) {
+    effect_cue_t cue = {};
+    cue.start_ms = start_ms;
+    cue.ch_mask = ch_mask;
+    cue.params.type = type;
+    cue.params.speed = speed;
+    cue.params.size = size;
+    cue.params.amount = amount;
+    cue.params.color_a[1] = 0xFF;  // Red
+    cue.params.color_b[2] = 0x40;  // Dim blue
+    return cue;
+}
+
+static bool pixel_is(const uint8_t* grb, const uint8_t* color) {
+    return grb[0] == color[0] && grb[1] == color[1] && grb[2] == color[2];
+}
+
+/**
+ * @brief Renders every primitive into the shadow buffers, then checks cue switching and the static-channel shortcut.
+ */
+static void check_effects(LedController& controller, const ch_info_t& ch_info) {
+    static const char* names[EFFECT_TYPE_NUM] = {"off", "solid", "gradient", "chase", "rainbow", "strobe", "sparkle", "wipe"};
+    const uint64_t strips = (1ULL << WS2812B_NUM) - 1;
+    EffectEngine engine;
+
+    // 1. Cost per primitive: every strip evaluated and written each frame, the work render() does
+    //    for a moving channel. render() itself would skip off and solid after their first frame.
+    static uint8_t line[SIM_PIXEL_NUM * 3];
+    ESP_LOGI(TAG, "effects: %d strips x %d px, %d frames", WS2812B_NUM, SIM_PIXEL_NUM, EFFECT_BENCH_FRAMES);
+    for(int type = EFFECT_OFF; type < EFFECT_TYPE_NUM; type++) {
+        effect_cue_t cue = effect_cue(0, strips, (effect_type_t)type, 40, 5, 128);
+
+        int64_t start = esp_timer_get_time();
+        for(int frame = 0; frame < EFFECT_BENCH_FRAMES; frame++) {
+            for(int ch = 0; ch < WS2812B_NUM; ch++) {
+                EffectEngine::render_pixels(cue.params, frame * EFFECT_BENCH_FRAME_MS, ch, line, SIM_PIXEL_NUM);
+                controller.write_pixels(ch, 0, line, SIM_PIXEL_NUM);
+            }
+        }
+        int64_t elapsed = esp_timer_get_time() - start;
+        ESP_LOGI(TAG, "  %-8s %6.1f us/frame", names[type], (double)elapsed / EFFECT_BENCH_FRAMES);
+    }
+    controller.black_out();
+
+    // 2. Primitives land where their parameters say
+    CaptureTarget capture;
+    effect_cue_t cues[] = {
+        effect_cue(0, 1ULL << 0, EFFECT_WIPE, 100, 0, 0),
+        effect_cue(0, 1ULL << 1, EFFECT_CHASE, 0, 4, 0),
+        effect_cue(0, 1ULL << 2, EFFECT_SPARKLE, 10, 0, 64),
+        effect_cue(0, 1ULL << 3, EFFECT_SOLID, 0, 0, 0),
+        effect_cue(1000, 1ULL << 3, EFFECT_OFF, 0, 0, 0),
+    };
+    engine.load(ch_info, CLOCK_SIM_FPS, cues, sizeof(cues) / sizeof(cues[0]));
+    engine.render(capture, 500);
+
+    const uint8_t* a = cues[0].params.color_a;
+    const uint8_t* b = cues[0].params.color_b;
+    bool wipe_ok = true;
+    bool chase_ok = true;
+    int sparkles = 0;
+    for(int i = 0; i < SIM_PIXEL_NUM; i++) {
+        wipe_ok &= pixel_is(&capture.pixels[0][i * 3], i < 50 ? a : b);
+        chase_ok &= pixel_is(&capture.pixels[1][i * 3], i % 8 < 4 ? a : b);
+        sparkles += pixel_is(&capture.pixels[2][i * 3], a);
+    }
+    check(wipe_ok && chase_ok, "Effect wipe and chase geometry");
+    check(sparkles > SIM_PIXEL_NUM / 8 && sparkles < SIM_PIXEL_NUM * 3 / 8, "Effect sparkle density");
+
+    // 3. Static channels are written once per cue, a jump back replays the cues
+    int writes = capture.writes;
+    engine.render(capture, 600);
+    int static_writes = capture.writes - writes;
+    engine.render(capture, 1500);
+    bool off_ok = capture.pixels[3][0] == 0 && capture.pixels[3][1] == 0;
+    engine.render(capture, 200);
+    check(static_writes == 2 && off_ok && pixel_is(capture.pixels[3], a), "Effect cue switching and static skip");
+    ESP_LOGI(TAG, "effects: %d-cue list is %d bytes", (int)(sizeof(cues) / sizeof(cues[0])), (int)(sizeof(effect_file_header_t) + sizeof(cues)));
+
+    engine.close();
+}
+
+/**
+ * @brief Flat GRB show frame: static background with a 5 pixel comet on every strip, PCA LEDs step every 4th frame.
+ */
+static void show_frame(int frame_idx, uint8_t* grb) {
+    for(int ch = 0; ch < WS2812B_NUM; ch++) {
+        int head = (frame_idx + ch * 7) % SIM_PIXEL_NUM;
+        for(int p = 0; p < SIM_PIXEL_NUM; p++) {
+            uint8_t* px = grb + (ch * SIM_PIXEL_NUM + p) * 3;
+            bool lit = head - p >= 0 && head - p < 5;
+            px[0] = lit ? 0xC0 : (uint8_t)(ch * 31 + p);
+            px[1] = lit ? 0x40 : (uint8_t)(p * 3);
+            px[2] = lit ? (uint8_t)frame_idx : 0x10;
+        }
+    }
+    for(int ch = 0; ch < PCA9955B_CH_NUM; ch++) {
+        uint8_t* px = grb + (WS2812B_NUM * SIM_PIXEL_NUM + ch) * 3;
+        px[0] = (uint8_t)(frame_idx / 4 * 9 + ch);
+        px[1] = (uint8_t)ch;
+        px[2] = (uint8_t)(frame_idx / 4);
+    }
+}
+
+static size_t put_varint(uint8_t* out, uint32_t value) {
+    size_t len = 0;
+    while(value >= 0x80) {
+        out[len++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[len++] = (uint8_t)value;
+    return len;
+}
+
+/**
+ * @brief Same run encoding as frame_encoder.py: (skip unchanged, literal changed) over flat frames.
+ */
+static size_t encode_delta(const uint8_t* prev, const uint8_t* cur, uint8_t* out) {
+    size_t len = 0;
+    uint32_t pos = 0;
+    uint32_t last = 0;
+
+    while(pos < SHOW_SIM_PIXEL_NUM) {
+        if(memcmp(cur + pos * 3, prev + pos * 3, 3) == 0) {
+            pos++;
+            continue;
+        }
+        uint32_t start = pos;
+        while(pos < SHOW_SIM_PIXEL_NUM && memcmp(cur + pos * 3, prev + pos * 3, 3) != 0) {
+            pos++;
+        }
+        len += put_varint(out + len, start - last);
+        len += put_varint(out + len, pos - start);
+        memcpy(out + len, cur + start * 3, (pos - start) * 3);
+        len += (pos - start) * 3;
+        last = pos;
+    }
+    return len;
+}
+
+/**
+ * @brief Writes show_frame() 0 .. frame_num - 1 as a v3 show file, keyframe_interval 1 gives raw frames.
+ */
+static bool write_show_file(const char* path, int frame_num, int keyframe_interval) {
+    frame_file_header_t header = {};
+    frame_record_header_t record;
+    uint8_t* prev = (uint8_t*)malloc(SHOW_SIM_STRIDE);
+    uint8_t* cur = (uint8_t*)malloc(SHOW_SIM_STRIDE);
+    uint8_t* payload = (uint8_t*)malloc(SHOW_SIM_STRIDE * 2);
+    frame_index_entry_t* index = (frame_index_entry_t*)malloc(frame_num * sizeof(frame_index_entry_t));
+    FILE* file = fopen(path, "wb");
+    uint32_t keyframe_num = 0;
+    uint32_t max_record_size = SHOW_SIM_STRIDE;
+    int since_key = 0;
+    bool ok = file && prev && cur && payload && index;
+
+    // 1. Records, the header is rewritten once the sizes are known
+    ok = ok && fwrite(&header, sizeof(header), 1, file) == 1;
+    for(int i = 0; ok && i < frame_num; i++) {
+        show_frame(i, cur);
+        record.type = FRAME_RECORD_KEY;
+        record.length = SHOW_SIM_STRIDE;
+        if(i > 0 && since_key + 1 < keyframe_interval) {
+            size_t len = encode_delta(prev, cur, payload);
+            if(len < SHOW_SIM_STRIDE) {
+                record.type = FRAME_RECORD_DELTA;
+                record.length = (uint16_t)len;
+            }
+        }
+        if(record.type == FRAME_RECORD_KEY) {
+            index[keyframe_num].frame_idx = i;
+            index[keyframe_num].offset = (uint32_t)ftell(file);
+            keyframe_num++;
+            memcpy(payload, cur, SHOW_SIM_STRIDE);
+            since_key = 0;
+        } else {
+            since_key++;
+        }
+        ok = fwrite(&record, sizeof(record), 1, file) == 1 && fwrite(payload, 1, record.length, file) == record.length;
+
+        uint8_t* swap = prev;
+        prev = cur;
+        cur = swap;
+    }
+
+    // 2. Index and header
+    if(ok) {
+        memcpy(header.magic, FRAME_FILE_MAGIC, sizeof(header.magic));
+        header.version = FRAME_FILE_VERSION;
+        header.fps = CLOCK_SIM_FPS;
+        header.ch_num = FRAME_FILE_CH_NUM;
+        header.frame_num = frame_num;
+        header.frame_stride = SHOW_SIM_STRIDE;
+        header.max_record_size = max_record_size;
+        header.keyframe_interval = keyframe_interval;
+        header.index_offset = (uint32_t)ftell(file);
+        header.keyframe_num = keyframe_num;
+        for(int ch = 0; ch < FRAME_FILE_CH_NUM; ch++) {
+            header.pixel_counts[ch] = ch < WS2812B_NUM ? SIM_PIXEL_NUM : 1;
+        }
+        ok = fwrite(index, sizeof(frame_index_entry_t), keyframe_num, file) == keyframe_num;
+        ok = ok && fseek(file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file) == 1;
+    }
+
+    if(file) {
+        fclose(file);
+    }
+    free(prev);
+    free(cur);
+    free(payload);
+    free(index);
+    return ok;
+}
+
+/**
+ * @brief Compares the captured channels with show_frame(frame_idx).
+ */
+static bool capture_is_frame(const CaptureTarget& capture, int frame_idx) {
+    static uint8_t expected[SHOW_SIM_STRIDE];
+
+    show_frame(frame_idx, expected);
+    for(int ch = 0; ch < FRAME_FILE_CH_NUM; ch++) {
+        int offset = ch < WS2812B_NUM ? ch * SIM_PIXEL_NUM : WS2812B_NUM * SIM_PIXEL_NUM + ch - WS2812B_NUM;
+        int pixels = ch < WS2812B_NUM ? SIM_PIXEL_NUM : 1;
+        if(memcmp(capture.pixels[ch], expected + offset * 3, pixels * 3) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Decodes a key + delta show file through FrameReader and compares every frame with its source.
+ */
+static void check_frame_reader() {
+    FrameReader reader;
+    CaptureTarget capture;
+    int frames = 0;
+    bool frames_ok = true;
+    esp_err_t err = ESP_OK;
+
+    bool written = write_show_file(SHOW_SIM_PATH, SHOW_SIM_FRAMES, SHOW_SIM_KEYFRAME_INTERVAL);
+    bool opened = written && reader.open(SHOW_SIM_PATH) == ESP_OK;
+    check(opened && reader.get_frame_num() == SHOW_SIM_FRAMES && reader.get_fps() == CLOCK_SIM_FPS, "Frame reader opens show file");
+
+    while(opened && (err = reader.read_frame(capture)) == ESP_OK) {
+        frames_ok &= capture_is_frame(capture, frames);
+        frames++;
+    }
+    check(frames_ok && frames == SHOW_SIM_FRAMES && err == ESP_ERR_NOT_FOUND, "Frame reader decodes every frame");
+
+    reader.close();
+    remove(SHOW_SIM_PATH);
+}
+
+/**
+ * @brief Seeks before, on and after keyframes the way Player::computeFrame() does and compares with a sequential decode.
+ *
+ * A target behind the cursor, or past a keyframe ahead of it, seeks to that
+ * keyframe; otherwise the deltas up to the target are decoded in place.
+ */
+static void check_frame_reader_seek() {
+    const uint32_t targets[] = {1, 29, 30, 31, 59, 60, 61, 89, 45, 0, 5, 65, 64};
+    const int target_num = sizeof(targets) / sizeof(targets[0]);
+    static uint8_t reference[sizeof(targets) / sizeof(targets[0])][FRAME_FILE_CH_NUM][SIM_PIXEL_NUM * 3];
+    FrameReader reader;
+    CaptureTarget capture;
+    bool frames_ok = true;
+    bool keyframes_ok = true;
+    int seeks = 0;
+
+    if(!write_show_file(SHOW_SIM_PATH, SHOW_SIM_FRAMES, SHOW_SIM_KEYFRAME_INTERVAL) || reader.open(SHOW_SIM_PATH) != ESP_OK) {
+        check(false, "Frame reader seek file");
+        return;
+    }
+
+    // 1. Reference frames from one pass over the file
+    for(uint32_t frame = 0; reader.read_frame(capture) == ESP_OK; frame++) {
+        for(int i = 0; i < target_num; i++) {
+            if(targets[i] == frame) {
+                memcpy(reference[i], capture.pixels, sizeof(reference[i]));
+            }
+        }
+    }
+
+    // 2. Walk the targets with one cursor, as the player does
+    reader.rewind();
+    for(int i = 0; i < target_num; i++) {
+        uint32_t target = targets[i];
+        if(target < reader.get_frame_idx() || reader.keyframe_before(target) > reader.get_frame_idx()) {
+            keyframes_ok &= reader.seek(target) == ESP_OK && reader.get_frame_idx() == target / SHOW_SIM_KEYFRAME_INTERVAL * SHOW_SIM_KEYFRAME_INTERVAL;
+            seeks++;
+        }
+        while(reader.get_frame_idx() <= target && reader.read_frame(capture) == ESP_OK) {
+        }
+        frames_ok &= reader.get_frame_idx() == target + 1 && memcmp(capture.pixels, reference[i], sizeof(reference[i])) == 0;
+    }
+    check(frames_ok && keyframes_ok && seeks > 0 && seeks < target_num, "Frame reader seek matches sequential");
+
+    // 3. Past the end is refused and leaves the cursor alone
+    uint32_t cursor = reader.get_frame_idx();
+    bool refused = reader.seek(SHOW_SIM_FRAMES) == ESP_ERR_INVALID_ARG && reader.seek(UINT32_MAX) == ESP_ERR_INVALID_ARG;
+    check(refused && reader.get_frame_idx() == cursor && reader.keyframe_before(UINT32_MAX) == SHOW_SIM_FRAMES - SHOW_SIM_KEYFRAME_INTERVAL,
+          "Frame reader refuses seek past end");
+
+    reader.close();
+    remove(SHOW_SIM_PATH);
+}
+
+/**
+ * @brief Replaces the payload of record 1 (the first delta) with `payload`.
+ */
+static bool patch_delta(const char* path, const uint8_t* payload, uint16_t length) {
+    frame_record_header_t record = {FRAME_RECORD_DELTA, length};
+    FILE* file = fopen(path, "r+b");
+    bool ok = file && fseek(file, sizeof(frame_file_header_t) + sizeof(frame_record_header_t) + SHOW_SIM_STRIDE, SEEK_SET) == 0;
+
+    ok = ok && fwrite(&record, sizeof(record), 1, file) == 1 && fwrite(payload, 1, length, file) == length;
+    if(file) {
+        fclose(file);
+    }
+    return ok;
+}
+
+/**
+ * @brief Delta runs whose skip or count would wrap the 32-bit bounds checks must be rejected without a write.
+ */
+static void check_frame_reader_bounds() {
+    struct {
+        uint32_t skip;
+        uint32_t count;
+    } runs[] = {
+        {0xFFFFFFFF, 2},           // pos wraps to 1 after the skip
+        {0x55555555, 0xAAAAAAAB},  // pos + count wraps to 0, count * 3 wraps to 1
+        {SHOW_SIM_PIXEL_NUM, 1},   // Plain past-the-end run
+    };
+    bool rejected = true;
+
+    for(size_t i = 0; i < sizeof(runs) / sizeof(runs[0]); i++) {
+        FrameReader reader;
+        CaptureTarget capture;
+        uint8_t payload[16] = {};
+        uint16_t length = 0;
+
+        length += put_varint(payload + length, runs[i].skip);
+        length += put_varint(payload + length, runs[i].count);
+        length += 3;  // One literal pixel
+
+        bool ready = write_show_file(SHOW_SIM_PATH, 2, SHOW_SIM_KEYFRAME_INTERVAL) && patch_delta(SHOW_SIM_PATH, payload, length) &&
+                     reader.open(SHOW_SIM_PATH) == ESP_OK && reader.read_frame(capture) == ESP_OK;
+        int writes = capture.writes;
+        rejected &= ready && reader.read_frame(capture) == ESP_ERR_INVALID_SIZE && capture.writes == writes;
+    }
+    check(rejected, "Frame reader rejects wrapping delta runs");
+    remove(SHOW_SIM_PATH);
+}
+
+/**
+ * @brief Decode cost per frame into the shadow buffers, delta file against the same show stored as raw keyframes.
+ */
+static void benchmark_frame_reader(LedController& controller) {
+    const int intervals[] = {SHOW_SIM_KEYFRAME_INTERVAL, 1};
+    const char* names[] = {"delta", "raw"};
+
+    for(int i = 0; i < 2; i++) {
+        FrameReader reader;
+        long size = 0;
+
+        if(!write_show_file(SHOW_SIM_PATH, SHOW_SIM_FRAMES, intervals[i]) || reader.open(SHOW_SIM_PATH) != ESP_OK) {
+            check(false, "Frame reader benchmark file");
+            continue;
+        }
+        FILE* file = fopen(SHOW_SIM_PATH, "rb");
+        if(file) {
+            fseek(file, 0, SEEK_END);
+            size = ftell(file);
+            fclose(file);
+        }
+
+        int64_t start = esp_timer_get_time();
+        for(int r = 0; r < SHOW_BENCH_ROUNDS; r++) {
+            reader.rewind();
+            while(reader.read_frame(controller) == ESP_OK) {
+            }
+        }
+        int64_t elapsed = esp_timer_get_time() - start;
+        ESP_LOGI(TAG,
+                 "decode %-5s: %6.1f us/frame, %ld bytes/frame",
+                 names[i],
+                 (double)elapsed / (SHOW_BENCH_ROUNDS * SHOW_SIM_FRAMES),
+                 size / SHOW_SIM_FRAMES);
+    }
+    controller.black_out();
+    remove(SHOW_SIM_PATH);
+}
+
+extern "C" void app_main() {
+    LedController controller;
+    ch_info_t ch_info = {0};
+
+    for(int i = 0; i < WS2812B_NUM; i++) {
+        ch_info.rmt_strips[i] = SIM_PIXEL_NUM;
+    }
+    for(int i = 0; i < PCA9955B_CH_NUM; i++) {
+        ch_info.i2c_leds[i] = 1;
+    }
+
+    // The transport checks compare raw bytes, check_output_lut() turns the curves on and check_power() the limiter
+    output_lut_set_gamma(false);
+    controller.set_power_budget(0);
+    led_sim_reset();
+    led_sim_i2c_set_max_speed(SIM_I2C_MAX_HZ);
+    for(int i = 0; i < PCA9955B_NUM; i++) {
+        led_sim_i2c_join_group(PCA9955B_ALLCALL_ADDR, BOARD_HW_CONFIG.i2c_addrs[i]);
+    }
+    if(controller.init(ch_info) != ESP_OK) {
+        ESP_LOGE(TAG, "LedController init failed");
+        exit(1);
+    }
+
+    check_encoder(controller);
+    check_lut_encoder();
+    check_frame_hold(controller);
+    check_dirty_prefix(controller);
+    benchmark(controller);
+    check_nack_recovery(controller);
+    check_pca_span(controller);
+    check_pca_health(controller);
+    check_i2c_recovery(controller);
+    check_pca_allcall(controller);
+    check_output_lut(controller);
+    check_dither(controller);
+    check_power(controller);
+    check_show_clock();
+    check_color_math();
+    check_effects(controller, ch_info);
+    check_frame_buffer(ch_info);
+    check_frame_reader();
+    check_frame_reader_seek();
+    check_frame_reader_bounds();
+    benchmark_frame_reader(controller);
+
+    controller.deinit();
+    check_rmt_mem();
+
+    ESP_LOGI(TAG, "%s", failures ? "FAILED" : "all checks passed");
+    exit(failures ? 1 : 0);
+}
@@ -1,12 +1,14 @@
 #pragma once
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "esp_console.h"
 #include "esp_log.h"
 #include "esp_system.h"
 #include "esp_vfs_fat.h"
 
+#include "output_lut.h"
 #include "player.h"
 
 #define PROMPT_STR "cmd"
@@ -17,15 +19,19 @@ static esp_console_repl_config_t repl_config = ESP_CONSOLE_REPL_CONFIG_DEFAULT()
 
 static int sendPlay(int argc, char** argv) {
     e.type = EVENT_PLAY;
-    e.data = 0;
+    e.data = PLAYER_PLAY_RESUME;
+    if(argc > 1) {
+        e.data = PLAYER_PLAY_FROM;
+        e.time_us = strtoll(argv[1], NULL, 10) * 1000;
+    }
     Player::getInstance().sendEvent(e);
     return 0;
 }
 
 static void register_sendPlay(void) {
     const esp_console_cmd_t cmd = {.command = "play",
-                                   .help = "send play",
-                                   .hint = NULL,
+                                   .help = "send play, optionally starting at a show time",
+                                   .hint = "[ms]",
                                    .func = &sendPlay,
 
                                    .argtable = NULL,
@@ -54,15 +60,24 @@ static void register_sendPause(void) {
 }
 
 static int sendTest(int argc, char** argv) {
+    int fps = 0;
+    if(argc > 1) {
+        fps = atoi(argv[1]);
+        if(fps <= 0 || fps > PLAYER_TEST_MAX_FPS) {
+            printf("usage: test [1-%d]\n", PLAYER_TEST_MAX_FPS);
+            return 1;
+        }
+    }
     e.type = EVENT_TEST;
+    e.data = fps;
     Player::getInstance().sendEvent(e);
     return 0;
 }
 
 static void register_sendTest(void) {
     const esp_console_cmd_t cmd = {.command = "test",
-                                   .help = "send test",
-                                   .hint = NULL,
+                                   .help = "send test, optionally at a frame rate",
+                                   .hint = "[fps]",
                                    .func = &sendTest,
 
                                    .argtable = NULL,
@@ -109,6 +124,103 @@ static void register_sendExit(void) {
     ESP_ERROR_CHECK(esp_console_cmd_register(&cmd));
 }
 
+static int sendSync(int argc, char** argv) {
+    if(argc < 2) {
+        printf("usage: sync <show time ms>\n");
+        return 1;
+    }
+    e.type = EVENT_SYNC;
+    e.data = 0;
+    e.time_us = strtoll(argv[1], NULL, 10) * 1000;
+    Player::getInstance().sendEvent(e);
+    return 0;
+}
+
+static void register_sendSync(void) {
+    const esp_console_cmd_t cmd = {.command = "sync",
+                                   .help = "re-anchor the show clock to a master show time",
+                                   .hint = "<ms>",
+                                   .func = &sendSync,
+
+                                   .argtable = NULL,
+                                   .func_w_context = NULL,
+                                   .context = NULL};
+    ESP_ERROR_CHECK(esp_console_cmd_register(&cmd));
+}
+
+static int sendSeek(int argc, char** argv) {
+    if(argc < 2) {
+        printf("usage: seek <show time ms>\n");
+        return 1;
+    }
+    e.type = EVENT_SEEK;
+    e.data = 0;
+    e.time_us = strtoll(argv[1], NULL, 10) * 1000;
+    Player::getInstance().sendEvent(e);
+    return 0;
+}
+
+static void register_sendSeek(void) {
+    const esp_console_cmd_t cmd = {.command = "seek",
+                                   .help = "jump to a show time, playing or paused",
+                                   .hint = "<ms>",
+                                   .func = &sendSeek,
+
+                                   .argtable = NULL,
+                                   .func_w_context = NULL,
+                                   .context = NULL};
+    ESP_ERROR_CHECK(esp_console_cmd_register(&cmd));
+}
+
+static int sendBrightness(int argc, char** argv) {
+    if(argc < 2) {
+        printf("brightness %d, gamma %s\n", output_lut_get_brightness(), output_lut_get_gamma() ? "on" : "off");
+        return 0;
+    }
+    int brightness = atoi(argv[1]);
+    if(brightness < 0 || brightness > 255) {
+        printf("usage: brightness [0-255]\n");
+        return 1;
+    }
+    e.type = EVENT_BRIGHTNESS;
+    e.data = brightness;
+    Player::getInstance().sendEvent(e);
+    return 0;
+}
+
+static void register_sendBrightness(void) {
+    const esp_console_cmd_t cmd = {.command = "brightness",
+                                   .help = "set the master brightness applied at output time, or print it",
+                                   .hint = "[0-255]",
+                                   .func = &sendBrightness,
+
+                                   .argtable = NULL,
+                                   .func_w_context = NULL,
+                                   .context = NULL};
+    ESP_ERROR_CHECK(esp_console_cmd_register(&cmd));
+}
+
+static int printStats(int argc, char** argv) {
+    if(argc > 1 && strcmp(argv[1], "reset") == 0) {
+        Player::getInstance().resetStats();
+        return 0;
+    }
+    Player::getInstance().printStats();
+    return 0;
+}
+
+static void register_printStats(void) {
+    const esp_console_cmd_t cmd = {.command = "stats",
+                                   .help = "print per-stage frame timing histograms, estimated LED current and PCA9955B link health ('stats reset' clears them)",
+                                   .hint = "[reset]",
+                                   .func = &printStats,
+
+                                   .argtable = NULL,
+                                   .func_w_context = NULL,
+                                   .context = NULL};
+    ESP_ERROR_CHECK(esp_console_cmd_register(&cmd));
+}
+
 static int stop_console(int argc, char** argv) {
     esp_console_stop_repl(repl);
     return 0;
@@ -132,6 +244,10 @@ static void register_cmd() {
     register_sendReset();
     register_sendExit();
     register_sendTest();
+    register_sendSync();
+    register_sendSeek();
+    register_sendBrightness();
+    register_printStats();
     register_stop_console();
 }
 